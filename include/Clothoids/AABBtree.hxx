@@ -26,6 +26,7 @@
  * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #pragma once
+#include <limits>
 #include <memory>
 #include <vector>
 #include <utility>
@@ -42,6 +43,23 @@ namespace G2lib {
 
   class AABBtree;
 
+  //!
+  //! Splitting rule used to build an `AABBtree`
+  //!
+  //! - `Midpoint`: cut the longest side of the node box at its middle
+  //! - `Median`: cut at the median centroid along the longest centroid extent
+  //! - `SAH`: binned surface area heuristic (perimeter in 2D), the cut
+  //!   minimizing the expected cost of the two children
+  //! - `Default`: use `AABBtree_default_strategy` at build time
+  //!
+  enum class AABBtreeStrategy { Default, Midpoint, Median, SAH };
+
+  //!
+  //! Strategy used by trees built with `AABBtreeStrategy::Default`,
+  //! i.e. the trees of the curves (`Midpoint` if not changed).
+  //!
+  extern AABBtreeStrategy AABBtree_default_strategy;
+
   /*\
    |   ____  ____
    |  | __ )| __ )  _____  __
@@ -171,6 +189,68 @@ namespace G2lib {
     return stream;
   }
 
+  //!
+  //! Contiguous storage of bounding boxes referred by index
+  //!
+  //! The boxes are constructed in place in a few large blocks, allocated by
+  //! `reserve` or when the last block is full, so that no allocation is done
+  //! per box and the boxes never move. The pointers returned by `get` share
+  //! the ownership of the block holding the box: a block is freed in one
+  //! shot when the pool is cleared and the last of these pointers is gone.
+  //!
+  class BBoxPool {
+   public:
+    using PtrBBox = shared_ptr<BBox const>;
+
+   private:
+    class Block;
+
+    vector<shared_ptr<Block>> m_blocks;
+    vector<int_type>          m_first;         //!< index of the first box of each block
+    int_type                  m_size{0};       //!< number of stored boxes
+    int_type                  m_capacity{0};   //!< number of boxes fitting in the blocks
+    size_t                    m_current{0};    //!< block receiving the next box
+
+    void add_block(int_type n);
+    size_t block_of(int_type i) const;
+
+   public:
+    BBoxPool() = default;
+
+    //! Create a pool able to store `n` boxes without further allocations.
+    explicit BBoxPool(int_type n) { reserve(n); }
+
+    //! Make room for `n` boxes overall with a single block allocation.
+    void reserve(int_type n);
+
+    //! Release the blocks (those still referenced by a pointer survive).
+    void clear();
+
+    int_type size() const { return m_size; }      //!< number of stored boxes
+    int_type capacity() const { return m_capacity; }  //!< room before a new block is needed
+
+    //!
+    //! Construct a bounding box in the pool and return its index
+    //!
+    //! \param[in] xmin x-minimimum box coordinate
+    //! \param[in] ymin y-minimimum box coordinate
+    //! \param[in] xmax x-maximum box coordinate
+    //! \param[in] ymax y-maximum box coordinate
+    //! \param[in] id   identifier of the box
+    //! \param[in] ipos ranking position of the box
+    //!
+    int_type add(real_type xmin, real_type ymin, real_type xmax, real_type ymax, int_type id, int_type ipos);
+
+    //! The box of index `i`.
+    BBox const & operator[](int_type i) const;
+
+    //! Pointer to the box of index `i`, sharing the ownership of its block.
+    PtrBBox get(int_type i) const;
+
+    //! Fill `bboxes` with the pointers to all the boxes, in index order.
+    void get_all(vector<PtrBBox> & bboxes) const;
+  };
+
   /*\
    |      _        _    ____  ____  _
    |     / \      / \  | __ )| __ )| |_ _ __ ___  ___
@@ -187,6 +267,22 @@ namespace G2lib {
   //! efficient spatial queries, reducing the complexity of intersection tests
   //! between collections of objects.
   //!
+  //! The tree is stored flat: the nodes live in a single array and refer
+  //! to their children by index, the node bounds are kept in separate
+  //! `xmin`, `ymin`, `xmax`, `ymax` arrays and the leaves store a range of
+  //! the primitive array, permuted at build time so that every subtree
+  //! owns a contiguous slice of it.
+  //!
+  //! After `build` the tree can be updated in place: `insert` and `remove`
+  //! change a single bounding box in \f$ O(\log n) \f$ restructuring the
+  //! path to the root with tree rotations, `update` and `refit` move the
+  //! bounding boxes keeping the topology. The bounding boxes are identified
+  //! by a handle, the position in the vector passed to `build` or the
+  //! value returned by `insert`.
+  //!
+  //! `insert` and `remove` drop the wide nodes: until `optimize` is called
+  //! the queries visit the binary tree one box at a time, which is slower.
+  //! `update` and `refit` keep the wide nodes in sync.
   //!
   class AABBtree {
    public:
@@ -196,43 +292,235 @@ namespace G2lib {
     using VecPtrBBox = vector<PtrBBox>;
     using VecPairPtrBBox = vector<PairPtrBBox>;
 
+    //!
+    //! Maximum number of primitives stored in a leaf
+    //!
+    static constexpr int_type max_leaf_size = 4;
+
+    //!
+    //! Subtrees with more bounding boxes than this are built in parallel
+    //!
+    static constexpr int_type parallel_build_size = 4096;
+
+    //!
+    //! Dual traversals of trees with fewer bounding boxes than this (summed)
+    //! run on a single thread
+    //!
+    static constexpr int_type parallel_intersect_size = 4096;
+
+    //!
+    //! Independent subtraversals a parallel dual traversal is split into
+    //! for each thread, the threads take them from a shared counter
+    //!
+    static constexpr int_type tasks_per_thread = 16;
+
    private:
-    // bbox of the tree
-    PtrBBox         pBBox;
-    vector<PtrAABB> children;
+    //!
+    //! Node of the flat tree. Internal nodes have `child >= 0`, their two
+    //! children are `child` and `child+1`. A leaf covers the primitives
+    //! `[begin, end)` of the permuted primitive array.
+    //!
+    struct Node {
+      int_type child;
+      int_type begin;
+      int_type end;
+    };
+
+    //!
+    //! Bounds stored as structure of arrays
+    //!
+    struct Bounds {
+      vector<real_type> xmin, ymin, xmax, ymax;
+
+      void clear() {
+        xmin.clear();
+        ymin.clear();
+        xmax.clear();
+        ymax.clear();
+      }
+      void resize(size_t n) {
+        xmin.resize(n);
+        ymin.resize(n);
+        xmax.resize(n);
+        ymax.resize(n);
+      }
+      bool collision(int_type i, Bounds const & B, int_type j) const {
+        size_t ii = size_t(i), jj = size_t(j);
+        return !(B.xmin[jj] > xmax[ii] || B.xmax[jj] < xmin[ii] || B.ymin[jj] > ymax[ii] || B.ymax[jj] < ymin[ii]);
+      }
+    };
+
+    vector<Node>    m_nodes;        //!< nodes, the root is `m_nodes[0]`
+    Bounds          m_node_bounds;  //!< bounds of the nodes
+    vector<PtrBBox> m_prims;        //!< primitives in leaf order
+    Bounds          m_prim_bounds;  //!< bounds of the primitives in leaf order
+
+    AABBtreeStrategy m_strategy{AABBtreeStrategy::Default};  //!< splitting rule of `build`
+
+    class Builder;
 
     AABBtree(AABBtree const & tree);
 
     //!
-    //! Compute the minimum of the maximum distance
-    //! between a point and the bbox contained in the `AABBtree`
+    //! Wide nodes obtained collapsing the binary tree, each one holds up to
+    //! `wide_arity` children (8 with AVX-512, 4 otherwise) tested together.
+    //! The bounds of a wide node are a block of `4*wide_arity` values
+    //! (all `xmin`, all `ymin`, all `xmax`, all `ymax`), a child is a wide
+    //! node if `>= 0` or the binary leaf `-1-child`. If there are no wide
+    //! nodes the root is the binary leaf `0`.
+    //!
+    //! The unused lanes have the empty box `[inf,inf]x[-inf,-inf]` and the
+    //! child `numeric_limits<int_type>::min()`, which no reference can take
+    //! (`-1` is the binary root). Unbounded queries accept the empty box,
+    //! so every visit skips these lanes on the child, not on the box test.
+    //!
+    vector<real_type> m_wide_bounds;
+    vector<int_type>  m_wide_child;
+    vector<int_type>  m_node_lane;  //!< lane `wide*wide_arity+i` of each binary node, or `-1`
+
+    void build_wide();
+    void drop_wide();
+
+    //!
+    //! Bookkeeping of the dynamic updates. The root is always the node `0`,
+    //! removed nodes (in pairs) and primitives leave free slots reused by
+    //! `insert`.
+    //!
+    vector<int_type> m_parent;       //!< parent of each node, `-1` for the root
+    vector<int_type> m_prim_leaf;    //!< leaf holding each primitive
+    vector<int_type> m_prim_handle;  //!< handle of each primitive, `-1` for a free slot
+    vector<int_type> m_handle_pos;   //!< primitive of each handle, `-1` if removed
+    vector<int_type> m_free_pairs;   //!< first node of the free pairs of nodes
+    vector<int_type> m_free_prims;   //!< free primitive slots
+    vector<int_type> m_free_handles;  //!< removed handles
+
+    bool is_leaf(int_type ref) const { return ref < 0 && m_nodes[size_t(-1 - ref)].child < 0; }
+
+    //!
+    //! Bounds and children of the lanes of the internal reference `ref`,
+    //! a binary node is expanded in the first two lanes of `Wbuf`, `WCbuf`.
+    //!
+    void node_lanes(
+        int_type ref, real_type const *& W, int_type const *& WC, real_type * Wbuf, int_type * WCbuf) const;
+
+    int_type alloc_pair();
+    void     relink(int_type inode);
+    void     move_node(int_type from, int_type to);
+    void     swap_nodes(int_type i, int_type j);
+    void     set_prim(int_type pos, PtrBBox const & box);
+    void     fit_node(int_type inode);
+    void     rotate_node(int_type inode);
+    void     refit_path(int_type inode, bool rotate);
+
+    using PairFun = bool (*)(void * data, int_type i, int_type j);
+
+    //!
+    //! Visit all the pairs of overlapping primitives of `this` and `tree`
+    //! calling `fun(data,i,j)` with the position of the two primitives,
+    //! the visit stops as soon as `fun` returns `true`.
+    //!
+    bool dual_traverse(AABBtree const & tree, PairFun fun, void * data) const;
+
+    template<typename FUN>
+    bool dual_traverse(AABBtree const & tree, FUN & fun) const {
+      return dual_traverse(
+          tree, [](void * data, int_type i, int_type j) -> bool { return (*static_cast<FUN *>(data))(i, j); }, &fun);
+    }
+
+    //!
+    //! Dual traversal from the pair of references `a`, `b`
+    //!
+    bool dual_traverse(AABBtree const & tree, int_type a, int_type b, PairFun fun, void * data) const;
+
+    template<typename FUN>
+    bool dual_traverse(AABBtree const & tree, int_type a, int_type b, FUN & fun) const {
+      return dual_traverse(
+          tree, a, b, [](void * data, int_type i, int_type j) -> bool { return (*static_cast<FUN *>(data))(i, j); },
+          &fun);
+    }
+
+    //!
+    //! Push the overlapping pairs of children of `a`, `b` on `stack`,
+    //! defined and instantiated in `AABBtree.cc` only.
+    //!
+    template<typename STACK>
+    void dual_expand(AABBtree const & tree, int_type a, int_type b, STACK & stack) const;
+
+    //!
+    //! Split the dual traversal in at least `ntasks` pairs of references,
+    //! when the trees are deep enough, to be traversed independently.
+    //!
+    void dual_tasks(AABBtree const & tree, int_type ntasks, vector<pair<int_type, int_type>> & tasks) const;
+
+    //!
+    //! As `dual_traverse` on `n_threads` threads (`0` = hardware
+    //! concurrency): `fun` is called concurrently and once it returns
+    //! `true` the remaining tasks are skipped.
+    //!
+    bool dual_traverse_parallel(AABBtree const & tree, int_type n_threads, PairFun fun, void * data) const;
+
+    //!
+    //! Append the positions of the overlapping primitives of `this` and
+    //! `tree`, in the order of visit of `dual_traverse` for any `n_threads`.
     //!
-    //! \param[in] x      x-coordinate of the point
-    //! \param[in] y      y-coordinate of the point
-    //! \param[in] tree   `AABBtree` with the bboxes
-    //! \param[in] mmDist initial value of the minimum of the maximum distance
-    //!                   used in the recursive call.
+    void overlapping_prims(AABBtree const & tree, int_type n_threads, vector<pair<int_type, int_type>> & prims) const;
+
+    template<typename FUN>
+    bool dual_traverse_parallel(AABBtree const & tree, int_type n_threads, FUN & fun) const {
+      return dual_traverse_parallel(
+          tree, n_threads,
+          [](void * data, int_type i, int_type j) -> bool { return (*static_cast<FUN *>(data))(i, j); }, &fun);
+    }
+
+    using NearestFun = real_type (*)(void * data, int_type i, real_type dst);
+
     //!
+    //! Visit the primitives in increasing distance from `(x,y)` calling
+    //! `fun(data,i,dst)`, which returns the current bound: the visit ends
+    //! when the remaining primitives are farther than the bound.
     //!
-    static real_type min_maxdist(real_type x, real_type y, AABBtree const & tree, real_type mmDist);
+    void nearest_visit(real_type x, real_type y, NearestFun fun, void * data) const;
+
+    using BoxFun = bool (*)(void * data, int_type i);
 
     //!
-    //! Select the candidate bboxes which have distance less than mmDist
+    //! Visit the primitives accepted by `lanes` (mask of the lanes of a wide
+    //! node to descend) and `prim` (test of the primitive `i`) calling
+    //! `fun(data,i)`, the visit stops as soon as `fun` returns `true`.
+    //! Defined and instantiated in `AABBtree.cc` only.
     //!
-    //! \param[in]  x      x-coordinate of the point
-    //! \param[in]  y      y-coordinate of the point
-    //! \param[in]  mmDist minimum distance used  for the selection of bboxes
-    //! \param[in]  tree   `AABBtree` with the bbox's
-    //! \param[out] candidateList  list of bbox which have minim distance less than `mmDist`
+    template<typename LANES, typename PRIM>
+    bool query_visit(LANES const & lanes, PRIM const & prim, BoxFun fun, void * data) const;
+
+    bool query_box_visit(
+        real_type xmin, real_type ymin, real_type xmax, real_type ymax, BoxFun fun, void * data) const;
+
+    bool query_radius_visit(real_type x, real_type y, real_type r, BoxFun fun, void * data) const;
+    bool min_distance_visit(real_type x, real_type y, BoxFun fun, void * data) const;
+
+    using RayFun = real_type (*)(void * data, int_type i, real_type tin, real_type tout);
+
     //!
+    //! Visit the primitives crossed by the ray `(x,y)+t*(dx,dy)`, nearest
+    //! nodes first, calling `fun(data,i,tin,tout)` with the parameters of
+    //! entry and exit of the ray in the primitive. `fun` returns the
+    //! current bound on `t`, the nodes entered after it are skipped.
     //!
-    static void min_maxdist_select(
-        real_type x, real_type y, real_type mmDist, AABBtree const & tree, VecPtrBBox & candidateList);
+    void raycast_visit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, RayFun fun, void * data) const;
+
+    void print_node(ostream_type & stream, int_type inode, int level) const;
 
    public:
     //! Create an empty AABB tree.
     AABBtree();
 
+    //! Take the nodes and the boxes of `tree`, which is left empty.
+    AABBtree(AABBtree && tree) noexcept = default;
+
+    //! Take the nodes and the boxes of `tree`, which is left empty.
+    AABBtree & operator=(AABBtree && tree) noexcept = default;
+
     //! destroy the stored AABB tree.
     ~AABBtree();
 
@@ -244,8 +532,15 @@ namespace G2lib {
     //! Check if AABB tree is empty.
     bool empty() const;
 
+    //! Number of nodes of the tree.
+    int_type num_nodes() const { return int_type(m_nodes.size() - 2 * m_free_pairs.size()); }
+
+    //! Number of bounding boxes stored in the tree.
+    int_type num_bboxes() const { return int_type(m_prims.size() - m_free_prims.size()); }
+
     //!
-    //! Get the Bounding Box of the whole AABB tree
+    //! Get the Bounding Box of the whole AABB tree, an empty tree gives
+    //! the empty box `xmin = ymin = +inf`, `xmax = ymax = -inf`
     //!
     //! \param[in] xmin x-minimimum box coordinate
     //! \param[in] ymin y-minimimum box coordinate
@@ -253,10 +548,15 @@ namespace G2lib {
     //! \param[in] ymax y-maximum box coordinate
     //!
     void bbox(real_type & xmin, real_type & ymin, real_type & xmax, real_type & ymax) const {
-      xmin = pBBox->x_min();
-      ymin = pBBox->y_min();
-      xmax = pBBox->x_max();
-      ymax = pBBox->y_max();
+      if (m_nodes.empty()) {
+        xmin = ymin = std::numeric_limits<real_type>::infinity();
+        xmax = ymax = -std::numeric_limits<real_type>::infinity();
+        return;
+      }
+      xmin = m_node_bounds.xmin[0];
+      ymin = m_node_bounds.ymin[0];
+      xmax = m_node_bounds.xmax[0];
+      ymax = m_node_bounds.ymax[0];
     }
 
     //!
@@ -264,6 +564,69 @@ namespace G2lib {
     //!
     void build(vector<PtrBBox> const & bboxes);
 
+    //!
+    //! Build AABB tree given the bbox stored in a pool
+    //!
+    void build(BBoxPool const & pool);
+
+    //!
+    //! Insert a bounding box, the tree is restructured along the path to
+    //! the root. The wide nodes are dropped: the queries visit the slower
+    //! binary tree until `optimize` is called, after a batch of updates.
+    //!
+    //! \param[in] box the bounding box
+    //! \return the handle of the bounding box
+    //!
+    int_type insert(PtrBBox const & box);
+
+    //!
+    //! Remove the bounding box `handle`, the handle can be reused by a
+    //! later `insert`. As for `insert` the queries visit the binary tree
+    //! until `optimize` is called.
+    //!
+    void remove(int_type handle);
+
+    //!
+    //! Replace the bounding box `handle` keeping the topology of the tree,
+    //! only the bounds on the path to the root are updated. For large
+    //! displacements `remove` and `insert` keep a better tree.
+    //!
+    void update(int_type handle, PtrBBox const & box);
+
+    //!
+    //! Replace all the bounding boxes keeping the topology of the tree,
+    //! `bboxes[h]` is the new bounding box of the handle `h` (ignored for
+    //! removed handles). Used after a rigid motion of all the boxes.
+    //!
+    void refit(vector<PtrBBox> const & bboxes);
+
+    //!
+    //! As `refit`, the new bounding box of the handle `h` is `pool[h]`.
+    //!
+    void refit(BBoxPool const & pool);
+
+    //!
+    //! Collapse again the tree in wide nodes after `insert` or `remove`,
+    //! the cost is \f$ O(n) \f$ so call it once after a batch of updates.
+    //!
+    void optimize() { build_wide(); }
+
+    //!
+    //! `false` if the wide nodes were dropped by `insert` or `remove`
+    //! and `optimize` was not called yet.
+    //!
+    bool optimized() const { return !m_wide_child.empty() || m_nodes.empty() || m_nodes[0].child < 0; }
+
+    //!
+    //! Set the splitting rule used by the next `build`
+    //!
+    void set_strategy(AABBtreeStrategy strategy) { m_strategy = strategy; }
+
+    //!
+    //! Splitting rule used by `build`
+    //!
+    AABBtreeStrategy strategy() const { return m_strategy; }
+
     //!
     //! Pretty print the AABB tree
     //!
@@ -275,47 +638,18 @@ namespace G2lib {
     //! \param[in] tree      an AABB tree that is used to check collision
     //! \param[in] ifun      function the check if the contents of two bbox (curve) collide
     //! \param[in] swap_tree if true exchange the tree in computation
+    //! \param[in] n_threads number of threads (`0` = hardware concurrency),
+    //!                      if not `1` `ifun` is called concurrently
     //! \return true if the two tree collides
     //!
     template<typename COLLISION_fun>
-    bool collision(AABBtree const & tree, COLLISION_fun ifun, bool swap_tree = false) const {
-      // check bbox with
-      if (!tree.pBBox->collision(*pBBox))
-        return false;
-
-      int icase = (children.empty() ? 0 : 1) + (tree.children.empty() ? 0 : 2);
-
-      switch (icase) {
-        case 0:  // both leaf, use GeomPrimitive intersection algorithm
-          if (swap_tree)
-            return ifun(tree.pBBox, pBBox);
-          else
-            return ifun(pBBox, tree.pBBox);
-        case 1:  // first is a tree, second is a leaf
-        {
-          typename vector<PtrAABB>::const_iterator it;
-          for (it = children.begin(); it != children.end(); ++it)
-            if (tree.collision(**it, ifun, !swap_tree))
-              return true;
-        } break;
-        case 2:  // first leaf, second is a tree
-        {
-          typename vector<PtrAABB>::const_iterator it;
-          for (it = tree.children.begin(); it != tree.children.end(); ++it)
-            if (this->collision(**it, ifun, swap_tree))
-              return true;
-        } break;
-        case 3:  // first is a tree, second is a tree
-        {
-          typename vector<PtrAABB>::const_iterator c1;
-          typename vector<PtrAABB>::const_iterator c2;
-          for (c1 = children.begin(); c1 != children.end(); ++c1)
-            for (c2 = tree.children.begin(); c2 != tree.children.end(); ++c2)
-              if ((*c1)->collision(**c2, ifun, swap_tree))
-                return true;
-        } break;
-      }
-      return false;
+    bool collision(AABBtree const & tree, COLLISION_fun ifun, bool swap_tree = false, int_type n_threads = 1) const {
+      auto fun = [&](int_type i, int_type j) -> bool {
+        PtrBBox const & b1 = m_prims[size_t(i)];
+        PtrBBox const & b2 = tree.m_prims[size_t(j)];
+        return swap_tree ? ifun(b2, b1) : ifun(b1, b2);
+      };
+      return n_threads == 1 ? dual_traverse(tree, fun) : dual_traverse_parallel(tree, n_threads, fun);
     }
 
     //!
@@ -324,8 +658,47 @@ namespace G2lib {
     //! \param[in]  tree             an AABB tree that is used to check collision
     //! \param[out] intersectionList list of pair bbox that overlaps
     //! \param[in]  swap_tree        if true exchange the tree in computation
+    //! \param[in]  n_threads        number of threads (`0` = hardware concurrency),
+    //!                              the list does not depend on it
     //!
-    void intersect(AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree = false) const;
+    void intersect(
+        AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree = false, int_type n_threads = 1) const;
+
+    //!
+    //! Compute all the intersection of AABB trees as pairs of `Ipos` of
+    //! the bboxes, no shared pointer is copied.
+    //!
+    //! \param[in]  tree      an AABB tree that is used to check collision
+    //! \param[out] iposList  list of the `Ipos` of the pairs of bbox that overlaps
+    //! \param[in]  swap_tree if true exchange the tree in computation
+    //! \param[in]  n_threads number of threads (`0` = hardware concurrency),
+    //!                       the list does not depend on it
+    //!
+    void intersect(
+        AABBtree const &                   tree,
+        vector<pair<int_type, int_type>> & iposList,
+        bool                               swap_tree = false,
+        int_type                           n_threads = 1) const;
+
+    //!
+    //! Visit the pairs of overlapping bboxes of the two trees.
+    //!
+    //! `fun(box1, box2)` is called for each pair, `box1` of this tree and
+    //! `box2` of `tree`, the visit stops as soon as `fun` returns `true`.
+    //! The traversal uses an explicit stack and no memory is allocated
+    //! unless the trees are very unbalanced.
+    //!
+    //! \param[in] tree an AABB tree
+    //! \param[in] fun  callback `bool fun(PtrBBox const & box1, PtrBBox const & box2)`
+    //! \return `true` if the visit was stopped by `fun`
+    //!
+    template<typename FUN>
+    bool visit_overlaps(AABBtree const & tree, FUN & fun) const {
+      auto visit = [this, &tree, &fun](int_type i, int_type j) -> bool {
+        return fun(m_prims[size_t(i)], tree.m_prims[size_t(j)]);
+      };
+      return dual_traverse(tree, visit);
+    }
 
     //!
     //! Select all the bboxes candidate to be at minimum distance.
@@ -335,6 +708,156 @@ namespace G2lib {
     //! \param[out] candidateList candidate list
     //!
     void min_distance(real_type x, real_type y, VecPtrBBox & candidateList) const;
+
+    //!
+    //! Visit the bboxes candidate to be at minimum distance from a point,
+    //! the bboxes selected by `min_distance`, without storing them.
+    //!
+    //! \param[in] x   x-coordinate of the point
+    //! \param[in] y   y-coordinate of the point
+    //! \param[in] fun callback `bool fun(PtrBBox const & box)`, the visit
+    //!                stops as soon as it returns `true`
+    //! \return `true` if the visit was stopped by `fun`
+    //!
+    template<typename FUN>
+    bool visit_min_distance(real_type x, real_type y, FUN & fun) const {
+      auto visit = [this, &fun](int_type i) -> bool { return fun(m_prims[size_t(i)]); };
+      using VISIT = decltype(visit);
+      return min_distance_visit(
+          x, y, [](void * data, int_type i) -> bool { return (*static_cast<VISIT *>(data))(i); }, &visit);
+    }
+
+    //!
+    //! Visit the bboxes overlapping the rectangle `[xmin,xmax]x[ymin,ymax]`.
+    //!
+    //! `fun(box)` is called for each overlapping bbox, the visit stops as
+    //! soon as `fun` returns `true`. No memory is allocated by the visit.
+    //!
+    //! \param[in] xmin x-minimum of the rectangle
+    //! \param[in] ymin y-minimum of the rectangle
+    //! \param[in] xmax x-maximum of the rectangle
+    //! \param[in] ymax y-maximum of the rectangle
+    //! \param[in] fun  callback `bool fun(PtrBBox const & box)`
+    //! \return `true` if the visit was stopped by `fun`
+    //!
+    template<typename FUN>
+    bool query_box(real_type xmin, real_type ymin, real_type xmax, real_type ymax, FUN & fun) const {
+      auto visit = [this, &fun](int_type i) -> bool { return fun(m_prims[size_t(i)]); };
+      using VISIT = decltype(visit);
+      return query_box_visit(
+          xmin, ymin, xmax, ymax, [](void * data, int_type i) -> bool { return (*static_cast<VISIT *>(data))(i); },
+          &visit);
+    }
+
+    //!
+    //! Visit the bboxes at distance not greater than `r` from the point `(x,y)`.
+    //!
+    //! `fun(box)` is called for each bbox in the disk, the visit stops as
+    //! soon as `fun` returns `true`. No memory is allocated by the visit.
+    //!
+    //! \param[in] x   x-coordinate of the center
+    //! \param[in] y   y-coordinate of the center
+    //! \param[in] r   radius of the disk
+    //! \param[in] fun callback `bool fun(PtrBBox const & box)`
+    //! \return `true` if the visit was stopped by `fun`
+    //!
+    template<typename FUN>
+    bool query_radius(real_type x, real_type y, real_type r, FUN & fun) const {
+      auto visit = [this, &fun](int_type i) -> bool { return fun(m_prims[size_t(i)]); };
+      using VISIT = decltype(visit);
+      return query_radius_visit(
+          x, y, r, [](void * data, int_type i) -> bool { return (*static_cast<VISIT *>(data))(i); }, &visit);
+    }
+
+    //!
+    //! Best-first visit of the bboxes in increasing distance from a point.
+    //!
+    //! `fun(box, dst)` receives a bbox and its distance from the point and
+    //! returns an upper bound of the searched distance, typically the best
+    //! exact distance found so far refining the candidates. The visit stops
+    //! as soon as all the remaining bboxes are farther than the bound, so
+    //! only a few candidates are refined.
+    //!
+    //! \param[in] x   x-coordinate of the point
+    //! \param[in] y   y-coordinate of the point
+    //! \param[in] fun callback `real_type fun(PtrBBox const & box, real_type dst)`
+    //!
+    template<typename FUN>
+    void nearest(real_type x, real_type y, FUN & fun) const {
+      auto visit = [this, &fun](int_type i, real_type dst) -> real_type { return fun(m_prims[size_t(i)], dst); };
+      using VISIT = decltype(visit);
+      nearest_visit(
+          x, y, [](void * data, int_type i, real_type dst) -> real_type { return (*static_cast<VISIT *>(data))(i, dst); },
+          &visit);
+    }
+
+    //!
+    //! Visit the bboxes crossed by the ray \f$ (x,y)+t(d_x,d_y) \f$ with
+    //! \f$ 0 \le t \le \f$ `max_range`, \f$ t \f$ is measured in units of
+    //! the length of the direction.
+    //!
+    //! The tree is descended with slab tests, nearest nodes first.
+    //! `fun(box, tin, tout)` receives a bbox and the parameters of entry and
+    //! exit of the ray in it and returns the bound on \f$ t \f$, typically
+    //! the first hit found so far refining the candidates: the bboxes
+    //! entered after the bound are not visited.
+    //!
+    //! \param[in] x         x-coordinate of the origin of the ray
+    //! \param[in] y         y-coordinate of the origin of the ray
+    //! \param[in] dx        x-component of the direction
+    //! \param[in] dy        y-component of the direction
+    //! \param[in] max_range maximum parameter along the ray
+    //! \param[in] fun       callback `real_type fun(PtrBBox const & box, real_type tin, real_type tout)`
+    //!
+    template<typename FUN>
+    void raycast(real_type x, real_type y, real_type dx, real_type dy, real_type max_range, FUN & fun) const {
+      auto visit = [this, &fun](int_type i, real_type tin, real_type tout) -> real_type {
+        return fun(m_prims[size_t(i)], tin, tout);
+      };
+      using VISIT = decltype(visit);
+      raycast_visit(
+          x, y, dx, dy, max_range,
+          [](void * data, int_type i, real_type tin, real_type tout) -> real_type {
+            return (*static_cast<VISIT *>(data))(i, tin, tout);
+          },
+          &visit);
+    }
+
+    //!
+    //! First bbox entered by the ray \f$ (x,y)+t(d_x,d_y) \f$ with
+    //! \f$ 0 \le t \le \f$ `max_range`.
+    //!
+    //! \param[in]  x         x-coordinate of the origin of the ray
+    //! \param[in]  y         y-coordinate of the origin of the ray
+    //! \param[in]  dx        x-component of the direction
+    //! \param[in]  dy        y-component of the direction
+    //! \param[in]  max_range maximum parameter along the ray
+    //! \param[out] box       the first bbox entered
+    //! \param[out] t         parameter of entry in `box`
+    //! \return `true` if a bbox is hit
+    //!
+    bool raycast(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, PtrBBox & box, real_type & t) const;
+
+    //!
+    //! Select the `k` bboxes nearest to a point, sorted by increasing distance.
+    //!
+    //! \param[in]  x             x-coordinate of the point
+    //! \param[in]  y             y-coordinate of the point
+    //! \param[in]  k             number of bboxes
+    //! \param[out] candidateList the nearest bboxes
+    //! \param[out] distances     distance of the selected bboxes from the point
+    //!
+    void k_nearest(
+        real_type x, real_type y, int_type k, VecPtrBBox & candidateList, vector<real_type> & distances) const;
+
+    //!
+    //! Select the `k` bboxes nearest to a point, sorted by increasing distance.
+    //!
+    void k_nearest(real_type x, real_type y, int_type k, VecPtrBBox & candidateList) const {
+      vector<real_type> distances;
+      k_nearest(x, y, k, candidateList, distances);
+    }
   };
 
 }  // namespace G2lib
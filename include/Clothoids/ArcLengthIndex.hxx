@@ -0,0 +1,115 @@
+/** * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * @file ArcLengthIndex.hxx
+ * @author Matteo Ragni (info@ragni.me)
+ *
+ * @copyright Copyright (c) 2022 Matteo Ragni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Based on the work of:
+ * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#pragma once
+#include "Types.hxx"
+
+#include <algorithm>
+#include <vector>
+
+namespace G2lib {
+
+  //!
+  //! Uniform arc-length bucket table over the breakpoints
+  //! \f$ s_0 < s_1 < \cdots < s_n \f$ of a list of curves.
+  //!
+  //! The range \f$ [s_0, s_n] \f$ is split in equal bins, each bin stores
+  //! the first and the last segment it intersects, so the segment
+  //! containing `s` is found by one division and a search restricted to
+  //! the (usually one or two) segments of its bin.
+  //! The index is a hint: lists validate its answer, a stale index only
+  //! costs a longer search.
+  //!
+  class ArcLengthIndex {
+    std::vector<int_type> m_first;  //!< first segment intersecting the bin, m_first[nb] = last segment
+    real_type             m_bins_per_segment{ 2 };
+    real_type             m_s_min{ 0 };
+    real_type             m_s_max{ 0 };
+    real_type             m_inv_h{ 0 };
+    int_type              m_nbins{ 0 };
+    int_type              m_nseg{ 0 };
+
+    void fill_bins(int_type b0, real_type const * s0);
+
+   public:
+    //!
+    //! Build the index of the `npts` breakpoints `s0` (`npts-1` segments)
+    //! with about `bins_per_segment` bins for each segment.
+    //!
+    void build(int_type npts, real_type const * s0, real_type bins_per_segment = 2);
+
+    //!
+    //! Update the index after segments are appended to the breakpoints,
+    //! `s0` are the `npts` breakpoints of the longer list. The new range
+    //! gets bins of the same width, the index is rebuilt if the old
+    //! breakpoints changed or the bins got crowded. Nothing is done if
+    //! the index is not built.
+    //!
+    void extend(int_type npts, real_type const * s0);
+
+    //!
+    //! Remove the index
+    //!
+    void clear() {
+      m_first.clear();
+      m_nbins = m_nseg = 0;
+    }
+
+    //!
+    //! Return `true` if the index is not built
+    //!
+    bool empty() const { return m_nbins == 0; }
+
+    //!
+    //! Check if the index can be used for the `npts` breakpoints `s0`
+    //!
+    bool valid_for(int_type npts, real_type const * s0) const {
+      return m_nbins > 0 && m_nseg == npts - 1 && m_s_min == s0[0] && m_s_max == s0[npts - 1];
+    }
+
+    //!
+    //! Return the segment `i` with \f$ s_i \leq s < s_{i+1} \f$,
+    //! `s` is clamped to \f$ [s_0, s_n] \f$.
+    //!
+    int_type guess(real_type s, real_type const * s0) const {
+      real_type t = (s - m_s_min) * m_inv_h;
+      int_type  b = t <= 0 ? 0 : (t >= m_nbins ? m_nbins - 1 : int_type(t));
+      int_type  lo = m_first[size_t(b)];
+      int_type  hi = m_first[size_t(b + 1)];
+      if (hi - lo < 8) {
+        while (lo < hi && s0[lo + 1] <= s) ++lo;
+        return lo;
+      }
+      return int_type(std::upper_bound(s0 + lo + 1, s0 + hi + 1, s) - s0) - 1;
+    }
+  };
+
+}  // namespace G2lib
+
+///
+/// eof: ArcLengthIndex.hxx
+///
@@ -49,6 +49,24 @@ namespace G2lib {
   using Ipair = std::pair<real_type, real_type>;
   using IntersectList = std::vector<Ipair>;
 
+  //!
+  //! Full state of a curve (with offset) at a curvilinear coordinate, as
+  //! returned by `BaseCurve::evaluate_jet`.
+  //!
+  struct CurveJet {
+    real_type x;       //!< x-coordinate
+    real_type y;       //!< y-coordinate
+    real_type theta;   //!< angle
+    real_type kappa;   //!< curvature (scaled by the offset as in `evaluate_ISO`)
+    real_type kappa_D; //!< curvature derivative
+    real_type x_D;     //!< x-coordinate first derivative
+    real_type y_D;     //!< y-coordinate first derivative
+    real_type x_DD;    //!< x-coordinate second derivative
+    real_type y_DD;    //!< y-coordinate second derivative
+    real_type x_DDD;   //!< x-coordinate third derivative
+    real_type y_DDD;   //!< y-coordinate third derivative
+  };
+
   /*\
    |   _       _                          _
    |  (_)_ __ | |_ ___ _ __ ___  ___  ___| |_
@@ -769,6 +787,19 @@ namespace G2lib {
       k /= 1 - offs * k;  // scale curvature
     }
 
+    //!
+    //! Evaluate position, angle, curvature, curvature derivative and the
+    //! first three derivatives of the curve with offset at curvilinear
+    //! coordinate `s` (ISO) in a single call. The default implementation
+    //! collects the single evaluations, curves override it sharing the
+    //! common subexpressions.
+    //!
+    //! \param[in]  s    curvilinear coordinate
+    //! \param[in]  offs offset
+    //! \param[out] J    the state of the curve
+    //!
+    virtual void evaluate_jet(real_type s, real_type offs, CurveJet & J) const;
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     //!
@@ -1128,6 +1159,55 @@ namespace G2lib {
       G2lib::intersect_SAE(*this, offs, C, offs_C, ilist, swap_s_vals);
     }
 
+    //!
+    //! Cast the ray \f$ (x,y)+t\,d/\|d\| \f$ against the curve and find the
+    //! first hit with \f$ 0 \le t \le \f$ `max_range`.
+    //!
+    //! \param[in]  x         x-coordinate of the origin of the ray
+    //! \param[in]  y         y-coordinate of the origin of the ray
+    //! \param[in]  dx        x-component of the direction \f$ d \f$
+    //! \param[in]  dy        y-component of the direction \f$ d \f$
+    //! \param[in]  max_range maximum distance along the ray
+    //! \param[out] s         curvilinear coordinate of the hit on the curve
+    //! \param[out] t         distance of the hit from the origin of the ray
+    //! \return true if the curve is hit
+    //!
+    bool raycast(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+      real_type len = std::hypot(dx, dy);
+      return len > 0 && this->raycast_unit(x, y, dx / len, dy / len, max_range, s, t);
+    }
+
+    //!
+    //! As `raycast` with the unit direction `(dx,dy)`.
+    //!
+    //! The default intersects the curve with the ray clipped to its bounding
+    //! box, the curves of the library override it with a traversal of their
+    //! AABB tree.
+    //!
+    virtual bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const;
+
+    //!
+    //! Cast the `n` rays `(x[i],y[i])` along `(dx[i],dy[i])` against the
+    //! curve, storing in `hit[i]` if the ray hits and in `s[i]`, `t[i]`
+    //! the first hit as in `raycast`. The first ray is cast on the calling
+    //! thread, so the lazily built AABB trees are ready, the others in
+    //! blocks over `n_threads` workers (`0` = hardware concurrency).
+    //!
+    void raycast_batch(
+        int_type          n,
+        real_type const * x,
+        real_type const * y,
+        real_type const * dx,
+        real_type const * dy,
+        real_type         max_range,
+        real_type *       s,
+        real_type *       t,
+        bool *            hit,
+        int_type          n_threads = 0) const;
+
     /*\
      |      _ _     _
      |   __| (_)___| |_ __ _ _ __   ___ ___
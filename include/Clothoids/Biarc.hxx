@@ -57,6 +57,15 @@ namespace G2lib {
 
     void gfun(real_type alpha, real_type g[3]) const;
 
+    // the triangles of the second arc from `n0` start at the end of the first one
+    void shift_C1_triangles(std::vector<Triangle2D> & tvec, size_t n0) const {
+      real_type L0 = m_C0.length();
+      for (size_t i = n0; i < tvec.size(); ++i) {
+        Triangle2D & T = tvec[i];
+        T.build(T.x1(), T.y1(), T.x2(), T.y2(), T.x3(), T.y3(), T.S0() + L0, T.S1() + L0, T.Icurve());
+      }
+    }
+
    public:
 #include "BaseCurve_using.hxx"
 
@@ -177,6 +186,8 @@ namespace G2lib {
 
     void evaluate(real_type s, real_type & th, real_type & k, real_type & x, real_type & y) const override;
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override;
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     real_type X(real_type s) const override;
@@ -345,7 +356,9 @@ namespace G2lib {
         real_type                 max_size  = 1e100,
         int_type                  icurve    = 0) const override {
       m_C0.bbTriangles(tvec, max_angle, max_size, icurve);
+      size_t n0 = tvec.size();
       m_C1.bbTriangles(tvec, max_angle, max_size, icurve);
+      shift_C1_triangles(tvec, n0);
     }
 
     void bbTriangles_ISO(
@@ -355,7 +368,9 @@ namespace G2lib {
         real_type                 max_size  = 1e100,
         int_type                  icurve    = 0) const override {
       m_C0.bbTriangles_ISO(offs, tvec, max_angle, max_size, icurve);
+      size_t n0 = tvec.size();
       m_C1.bbTriangles_ISO(offs, tvec, max_angle, max_size, icurve);
+      shift_C1_triangles(tvec, n0);
     }
 
     void bbTriangles_SAE(
@@ -365,7 +380,9 @@ namespace G2lib {
         real_type                 max_size  = 1e100,
         int_type                  icurve    = 0) const override {
       m_C0.bbTriangles_SAE(offs, tvec, max_angle, max_size, icurve);
+      size_t n0 = tvec.size();
       m_C1.bbTriangles_SAE(offs, tvec, max_angle, max_size, icurve);
+      shift_C1_triangles(tvec, n0);
     }
 
     /*\
@@ -426,6 +443,10 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, Biarc const & B, real_type offs_B, IntersectList & ilist, bool swap_s_vals) const;
 
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
+
     void info(ostream_type & stream) const override { stream << "BiArc\n" << *this << '\n'; }
 
     //!
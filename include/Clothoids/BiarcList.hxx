@@ -31,6 +31,7 @@
 #include "PolyLine.hxx"
 #include "AABBtree.hxx"
 #include "ThreadLocalData.hxx"
+#include "ArcLengthIndex.hxx"
 
 namespace G2lib {
 
@@ -63,6 +64,7 @@ namespace G2lib {
     vector<Biarc>     m_biarcList;
 
     mutable Utils::ThreadLocalData<int_type> m_lastInterval;
+    ArcLengthIndex                           m_s_index;
 
     mutable bool               m_aabb_done;
     mutable AABBtree           m_aabb_tree;
@@ -71,6 +73,18 @@ namespace G2lib {
     mutable real_type          m_aabb_max_size;
     mutable vector<Triangle2D> m_aabb_tri;
 
+    // collapse the triangle positions stored in `segments` to segment ranges
+    void triangle_ranges(vector<int_type> & segments, vector<real_type> & s_begin, vector<real_type> & s_end) const;
+
+    // insert in the AABB tree, if built, the triangles of the segments from `first`
+    void aabb_push_back(size_t first);
+
+    // refit the AABB tree after a rigid motion of the triangles
+    void aabb_refit();
+
+    // take the biarcs and the cached AABB tree of `L`, which is left empty
+    void move_from(BiarcList & L) noexcept;
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     class T2D_collision_list_ISO {
       BiarcList const * m_pList1;
@@ -94,7 +108,7 @@ namespace G2lib {
 
 #endif
 
-    void resetLastInterval() { *(m_lastInterval.search(std::this_thread::get_id())) = 0; }
+    void resetLastInterval() { m_lastInterval.get() = 0; }
 
     int_type closest_point_internal(
         real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & dst) const;
@@ -121,6 +135,12 @@ namespace G2lib {
       copy(s);
     }
 
+    //!
+    //! Build a biarc spline taking the biarcs, the arc-length index and
+    //! the cached AABB tree of `s`, which is left empty.
+    //!
+    BiarcList(BiarcList && s) noexcept : BaseCurve(G2LIB_BIARC_LIST), m_aabb_done(false) { move_from(s); }
+
     //!
     //! Empty the the biarc list.
     //!
@@ -144,6 +164,14 @@ namespace G2lib {
       return *this;
     }
 
+    //!
+    //! Move another biarc spline, see the move constructor.
+    //!
+    BiarcList const & operator=(BiarcList && s) noexcept {
+      move_from(s);
+      return *this;
+    }
+
     //!
     //! Build a biarc list from a line segment.
     //!
@@ -245,6 +273,11 @@ namespace G2lib {
     //!
     Biarc const & get(int_type idx) const;
 
+    //!
+    //! Get the `idx`-th biarc without range check, see `CurveCursor`.
+    //!
+    Biarc const & segment(int_type idx) const { return m_biarcList[size_t(idx)]; }
+
     //!
     //! Get the biarc that contain the curvilinear coordinate `s`.
     //!
@@ -261,6 +294,31 @@ namespace G2lib {
     //!
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` but the search starts from the caller-owned
+    //! interval `hint`, updated with the result. No locking is involved,
+    //! see `CurveCursor`.
+    //!
+    int_type findAtS(real_type & s, int_type & hint) const;
+
+    //!
+    //! Curvilinear coordinate of the beginning of the `idx`-th segment
+    //!
+    real_type segment_s0(int_type idx) const { return m_s0[size_t(idx)]; }
+
+    //!
+    //! Build the arc-length index used by `findAtS` for random access,
+    //! it is built by the `build*` methods and refreshed by `scale`,
+    //! `reverse` and `trim` and extended by `push_back` (amortized
+    //! \f$ O(1) \f$ per segment).
+    //!
+    void build_s_index() { m_s_index.build(int_type(m_s0.size()), m_s0.data()); }
+
+    //!
+    //! Drop the arc-length index
+    //!
+    void clear_s_index() { m_s_index.clear(); }
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     real_type length() const override;
@@ -443,6 +501,10 @@ namespace G2lib {
 
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override;
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
     real_type X(real_type) const override;
     real_type Y(real_type) const override;
     real_type X_D(real_type) const override;
@@ -527,6 +589,48 @@ namespace G2lib {
         real_type & t,
         real_type & dst) const override;
 
+    //!
+    //! Select the segments near the rectangle `[xmin,xmax]x[ymin,ymax]`,
+    //! i.e. the segments with a covering triangle whose bbox overlaps it.
+    //! The output vectors are reused, so repeated queries do not allocate.
+    //!
+    //! \param[in]  xmin     x-minimum of the rectangle
+    //! \param[in]  ymin     y-minimum of the rectangle
+    //! \param[in]  xmax     x-maximum of the rectangle
+    //! \param[in]  ymax     y-maximum of the rectangle
+    //! \param[out] segments index of the selected segments, increasing
+    //! \param[out] s_begin  curvilinear abscissa where the selected part of each segment begins
+    //! \param[out] s_end    curvilinear abscissa where the selected part of each segment ends
+    //!
+    void segments_in_box(
+        real_type           xmin,
+        real_type           ymin,
+        real_type           xmax,
+        real_type           ymax,
+        vector<int_type> &  segments,
+        vector<real_type> & s_begin,
+        vector<real_type> & s_end) const;
+
+    //!
+    //! Select the segments with a covering triangle at distance not greater
+    //! than `r` from the point `(x,y)`.
+    //! The output vectors are reused, so repeated queries do not allocate.
+    //!
+    //! \param[in]  x        x-coordinate of the center
+    //! \param[in]  y        y-coordinate of the center
+    //! \param[in]  r        radius
+    //! \param[out] segments index of the selected segments, increasing
+    //! \param[out] s_begin  curvilinear abscissa where the selected part of each segment begins
+    //! \param[out] s_end    curvilinear abscissa where the selected part of each segment ends
+    //!
+    void segments_in_radius(
+        real_type           x,
+        real_type           y,
+        real_type           r,
+        vector<int_type> &  segments,
+        vector<real_type> & s_begin,
+        vector<real_type> & s_end) const;
+
     void info(ostream_type & stream) const override { stream << "BiarcList\n" << *this << '\n'; }
 
     //! pretty print the biarc list
@@ -629,6 +733,14 @@ namespace G2lib {
     //!
     void intersect_ISO(
         real_type offs, BiarcList const & CL, real_type offs_obj, IntersectList & ilist, bool swap_s_vals) const;
+
+    //!
+    //! Ray casting, the biarcs of the candidate triangles of the AABB tree
+    //! are intersected in closed form.
+    //!
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
   };
 
 }  // namespace G2lib
@@ -412,6 +412,8 @@ namespace G2lib {
 
     void eval_DDD(real_type, real_type & x_DDD, real_type & y_DDD) const override;
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override;
+
     /*\
      |  _____                   _   _   _
      | |_   _|   __ _ _ __   __| | | \ | |
@@ -549,6 +551,10 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, CircleArc const & C, real_type offs_obj, IntersectList & ilist, bool swap_s_vals) const;
 
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
+
     //!
     //! Return \f$ \sin \theta_0 \f$ where
     //! \f$ \theta_0 \f$ is the initial tangent angle.
@@ -106,6 +106,22 @@ namespace G2lib {
     mutable real_type          m_aabb_max_size;
     mutable vector<Triangle2D> m_aabb_tri;
 
+    // take the data and the cached AABB tree of `c`, which is left without tree
+    void move_from(ClothoidCurve & c) noexcept {
+      if (this == &c) return;
+      m_CD        = c.m_CD;
+      m_L         = c.m_L;
+      m_aabb_done = c.m_aabb_done;
+      if (m_aabb_done) {
+        m_aabb_offs      = c.m_aabb_offs;
+        m_aabb_max_angle = c.m_aabb_max_angle;
+        m_aabb_max_size  = c.m_aabb_max_size;
+      }
+      m_aabb_tree   = std::move(c.m_aabb_tree);
+      m_aabb_tri    = std::move(c.m_aabb_tri);
+      c.m_aabb_done = false;
+    }
+
     bool aabb_intersect_ISO(
         Triangle2D const &    T1,
         real_type             offs,
@@ -170,6 +186,11 @@ namespace G2lib {
     //!
     ClothoidCurve(ClothoidCurve const & s) : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) { copy(s); }
 
+    //!
+    //! Build a clothoid curve taking the data and the cached AABB tree of `s`
+    //!
+    ClothoidCurve(ClothoidCurve && s) noexcept : BaseCurve(G2LIB_CLOTHOID), m_aabb_done(false) { move_from(s); }
+
     //!
     //! Construct a clothoid with the standard parameters.
     //!
@@ -259,6 +280,14 @@ namespace G2lib {
       return *this;
     }
 
+    //!
+    //! Move an existing clothoid, the cached AABB tree is transferred.
+    //!
+    ClothoidCurve const & operator=(ClothoidCurve && s) noexcept {
+      move_from(s);
+      return *this;
+    }
+
     /*\
      |  _         _ _    _
      | | |__ _  _(_) |__| |
@@ -333,6 +362,54 @@ namespace G2lib {
       return m_CD.build_G1(x0, y0, theta0, x1, y1, theta1, tol, m_L, true, L_D, k_D, dk_D);
     }
 
+    //!
+    //! Build a clothoid by solving the hermite G1 problem, the Newton
+    //! iterations start from the current clothoid. Useful when the
+    //! problem is a small perturbation of the one solved before.
+    //!
+    //! \param[in] x0     initial x position \f$ x_0      \f$
+    //! \param[in] y0     initial y position \f$ y_0      \f$
+    //! \param[in] theta0 initial angle      \f$ \theta_0 \f$
+    //! \param[in] x1     final x position   \f$ x_1      \f$
+    //! \param[in] y1     final y position   \f$ y_1      \f$
+    //! \param[in] theta1 final angle        \f$ \theta_1 \f$
+    //! \param[in] tol    tolerance
+    //! \return number of iteration performed
+    //!
+    int build_G1_warm(
+        real_type x0,
+        real_type y0,
+        real_type theta0,
+        real_type x1,
+        real_type y1,
+        real_type theta1,
+        real_type tol = 1e-12) {
+      real_type A = 0.5 * m_CD.dk * m_L * m_L;
+      m_aabb_done = false;
+      m_aabb_tree.clear();
+      return m_CD.build_G1_warm(x0, y0, theta0, x1, y1, theta1, tol, m_L, A);
+    }
+
+    //!
+    //! As `build_G1_D` but the Newton iterations start from the current clothoid.
+    //!
+    int build_G1_D_warm(
+        real_type x0,
+        real_type y0,
+        real_type theta0,
+        real_type x1,
+        real_type y1,
+        real_type theta1,
+        real_type L_D[2],
+        real_type k_D[2],
+        real_type dk_D[2],
+        real_type tol = 1e-12) {
+      real_type A = 0.5 * m_CD.dk * m_L * m_L;
+      m_aabb_done = false;
+      m_aabb_tree.clear();
+      return m_CD.build_G1_warm(x0, y0, theta0, x1, y1, theta1, tol, m_L, A, true, L_D, k_D, dk_D);
+    }
+
     //!
     //! Build a clothoid by solving the forward problem.
     //!
@@ -408,6 +485,18 @@ namespace G2lib {
     //!
     real_type dkappa() const { return m_CD.dk; }
 
+    //!
+    //! Accuracy tier of the Fresnel integrals used to evaluate the position
+    //! along the curve (the construction is always exact).
+    //!
+    FresnelAccuracy fresnel_accuracy() const { return m_CD.accuracy; }
+
+    //!
+    //! Set the accuracy tier of the Fresnel integrals used to evaluate the
+    //! position along the curve.
+    //!
+    void fresnel_accuracy(FresnelAccuracy acc) { m_CD.accuracy = acc; }
+
     //!
     //! Clothoid curve total variation of the angle.
     //!
@@ -809,6 +898,28 @@ namespace G2lib {
       m_CD.eval_ISO_DDD(s, offs, x_DDD, y_DDD);
     }
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override { m_CD.evaluate_jet(s, offs, J); }
+
+    //!
+    //! Sample the clothoid at \f$ s = 0, ds, 2ds, \ldots \le L \f$ by forward
+    //! marching. The buffers must hold `sample_uniform_size(ds)` values,
+    //! `theta` and `kappa` may be `nullptr`. Return the number of samples.
+    //!
+    int_type sample_uniform(
+        real_type   ds,
+        real_type * x,
+        real_type * y,
+        real_type * theta = nullptr,
+        real_type * kappa = nullptr) const;
+
+    //!
+    //! Number of samples produced by `sample_uniform(ds,...)`. A length
+    //! that is a multiple of `ds` up to rounding keeps its last sample.
+    //!
+    int_type sample_uniform_size(real_type ds) const {
+      return int_type(floor(m_L / ds * (1 + Utils::machepsi100))) + 1;
+    }
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -917,6 +1028,14 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, ClothoidCurve const & C, real_type offs_C, IntersectList & ilist, bool swap_s_vals) const;
 
+    //!
+    //! Ray casting, the candidate triangles of the AABB tree are refined
+    //! with the Newton iteration of the intersection.
+    //!
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
+
     void info(ostream_type & stream) const override { stream << "Clothoid\n" << *this << '\n'; }
 
     friend ostream_type & operator<<(ostream_type & stream, ClothoidCurve const & c);
@@ -29,6 +29,7 @@
 #include "BaseCurve.hxx"
 #include "Clothoid.hxx"
 #include "ThreadLocalData.hxx"
+#include "ArcLengthIndex.hxx"
 
 namespace G2lib {
 
@@ -702,6 +703,240 @@ namespace G2lib {
     real_type thetaMinMax(real_type & thMin, real_type & thMax) const { return theta_min_max(thMin, thMax); }
   };
 
+  /*\
+   |   ____                                  _
+   |  / ___|  ___  __ _ _ __ ___   ___ _ __ | |_
+   |  \___ \ / _ \/ _` | '_ ` _ \ / _ \ '_ \| __|
+   |   ___) |  __/ (_| | | | | | |  __/ | | | |_
+   |  |____/ \___|\__, |_| |_| |_|\___|_| |_|\__|
+   |              |___/
+  \*/
+  //!
+  //! Compact record of a segment of a `ClothoidList`: the clothoid
+  //! parameters, the length and the direction of the initial tangent.
+  //! The stored direction saves the rotation by \f$ \theta_0 \f$ at each
+  //! evaluation of the position. The list stores the records contiguously,
+  //! a full `ClothoidCurve` is built by `curve()` only when needed.
+  //!
+  class ClothoidSegment {
+   public:
+    ClothoidData CD;         //!< clothoid data
+    real_type    L{0};       //!< length of the segment
+    real_type    cos0{1};    //!< \f$ \cos\theta_0 \f$
+    real_type    sin0{0};    //!< \f$ \sin\theta_0 \f$
+
+    ClothoidSegment() = default;
+
+    //! Build the record of the clothoid `C`.
+    explicit ClothoidSegment(ClothoidCurve const & C);
+
+    //! Build a `ClothoidCurve` equal to the segment.
+    ClothoidCurve curve() const;
+
+    //! Recompute `cos0` and `sin0` after a change of `CD.theta0`.
+    void update_direction() {
+      cos0 = cos(CD.theta0);
+      sin0 = sin(CD.theta0);
+    }
+
+    real_type length() const { return L; }
+    real_type length_ISO(real_type offs) const;
+    real_type dkappa() const { return CD.dk; }
+
+    real_type theta_begin() const { return CD.theta0; }
+    real_type theta_end() const { return CD.theta(L); }
+    real_type kappa_begin() const { return CD.kappa0; }
+    real_type kappa_end() const { return CD.kappa(L); }
+    real_type x_begin() const { return CD.x0; }
+    real_type y_begin() const { return CD.y0; }
+    real_type x_end() const { return X(L); }
+    real_type y_end() const { return Y(L); }
+    real_type x_begin_ISO(real_type offs) const { return CD.x0 - offs * sin0; }
+    real_type y_begin_ISO(real_type offs) const { return CD.y0 + offs * cos0; }
+    real_type x_end_ISO(real_type offs) const { return X_ISO(L, offs); }
+    real_type y_end_ISO(real_type offs) const { return Y_ISO(L, offs); }
+    real_type tx_Begin() const { return cos0; }
+    real_type ty_Begin() const { return sin0; }
+    real_type tx_End() const { return CD.tg_x(L); }
+    real_type ty_End() const { return CD.tg_y(L); }
+    real_type nx_Begin_ISO() const { return -sin0; }
+    real_type ny_Begin_ISO() const { return cos0; }
+    real_type nx_End_ISO() const { return -CD.tg_y(L); }
+    real_type ny_End_ISO() const { return CD.tg_x(L); }
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    real_type theta(real_type s) const { return CD.theta(s); }
+    real_type theta_D(real_type s) const { return CD.kappa(s); }
+    real_type theta_DD(real_type) const { return CD.dk; }
+    real_type theta_DDD(real_type) const { return 0; }
+
+    real_type tx(real_type s) const { return CD.tg_x(s); }
+    real_type ty(real_type s) const { return CD.tg_y(s); }
+    real_type tx_D(real_type s) const { return CD.tg_x_D(s); }
+    real_type ty_D(real_type s) const { return CD.tg_y_D(s); }
+    real_type tx_DD(real_type s) const { return CD.tg_x_DD(s); }
+    real_type ty_DD(real_type s) const { return CD.tg_y_DD(s); }
+    real_type tx_DDD(real_type s) const { return CD.tg_x_DDD(s); }
+    real_type ty_DDD(real_type s) const { return CD.tg_y_DDD(s); }
+
+    void tg(real_type s, real_type & tx, real_type & ty) const { CD.tg(s, tx, ty); }
+    void tg_D(real_type s, real_type & tx_D, real_type & ty_D) const { CD.tg_D(s, tx_D, ty_D); }
+    void tg_DD(real_type s, real_type & tx_DD, real_type & ty_DD) const { CD.tg_DD(s, tx_DD, ty_DD); }
+    void tg_DDD(real_type s, real_type & tx_DDD, real_type & ty_DDD) const { CD.tg_DDD(s, tx_DDD, ty_DDD); }
+
+    void nor_ISO(real_type s, real_type & nx, real_type & ny) const { CD.nor_ISO(s, nx, ny); }
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    real_type X(real_type s) const;
+    real_type Y(real_type s) const;
+
+    real_type X_D(real_type s) const { return CD.X_D(s); }
+    real_type Y_D(real_type s) const { return CD.Y_D(s); }
+    real_type X_DD(real_type s) const { return CD.X_DD(s); }
+    real_type Y_DD(real_type s) const { return CD.Y_DD(s); }
+    real_type X_DDD(real_type s) const { return CD.X_DDD(s); }
+    real_type Y_DDD(real_type s) const { return CD.Y_DDD(s); }
+
+    real_type X_ISO(real_type s, real_type offs) const { return X(s) + offs * CD.nor_x_ISO(s); }
+    real_type Y_ISO(real_type s, real_type offs) const { return Y(s) + offs * CD.nor_y_ISO(s); }
+
+    real_type X_ISO_D(real_type s, real_type offs) const { return CD.X_ISO_D(s, offs); }
+    real_type Y_ISO_D(real_type s, real_type offs) const { return CD.Y_ISO_D(s, offs); }
+    real_type X_ISO_DD(real_type s, real_type offs) const { return CD.X_ISO_DD(s, offs); }
+    real_type Y_ISO_DD(real_type s, real_type offs) const { return CD.Y_ISO_DD(s, offs); }
+    real_type X_ISO_DDD(real_type s, real_type offs) const { return CD.X_ISO_DDD(s, offs); }
+    real_type Y_ISO_DDD(real_type s, real_type offs) const { return CD.Y_ISO_DDD(s, offs); }
+
+    void eval(real_type s, real_type & x, real_type & y) const;
+    void eval_D(real_type s, real_type & x_D, real_type & y_D) const { CD.eval_D(s, x_D, y_D); }
+    void eval_DD(real_type s, real_type & x_DD, real_type & y_DD) const { CD.eval_DD(s, x_DD, y_DD); }
+    void eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) const { CD.eval_DDD(s, x_DDD, y_DDD); }
+
+    void eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const;
+
+    void eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const {
+      CD.eval_ISO_D(s, offs, x_D, y_D);
+    }
+
+    void eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
+      CD.eval_ISO_DD(s, offs, x_DD, y_DD);
+    }
+
+    void eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
+      CD.eval_ISO_DDD(s, offs, x_DDD, y_DDD);
+    }
+
+    void evaluate(real_type s, real_type & th, real_type & k, real_type & x, real_type & y) const {
+      eval(s, x, y);
+      th = CD.theta(s);
+      k  = CD.kappa(s);
+    }
+
+    void evaluate_ISO(real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) const {
+      eval_ISO(s, offs, x, y);
+      th = CD.theta(s);
+      k  = CD.kappa(s);
+      k /= 1 + offs * k;  // scale curvature
+    }
+
+    void evaluate_SAE(real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) const {
+      eval_ISO(s, -offs, x, y);
+      th = CD.theta(s);
+      k  = CD.kappa(s);
+      k /= 1 - offs * k;  // scale curvature
+    }
+
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const { CD.evaluate_jet(s, offs, J); }
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    void translate(real_type tx, real_type ty) {
+      CD.x0 += tx;
+      CD.y0 += ty;
+    }
+
+    void rotate(real_type angle, real_type cx, real_type cy) {
+      CD.rotate(angle, cx, cy);
+      update_direction();
+    }
+
+    void scale(real_type s) {
+      CD.kappa0 /= s;
+      CD.dk /= s * s;
+      L *= s;
+    }
+
+    void reverse() {
+      CD.reverse(L);
+      update_direction();
+    }
+
+    void change_origin(real_type newx0, real_type newy0) {
+      CD.x0 = newx0;
+      CD.y0 = newy0;
+    }
+
+    void trim(real_type s_begin, real_type s_end) {
+      CD.origin_at(s_begin);
+      L = s_end - s_begin;
+      update_direction();
+    }
+  };
+
+  //!
+  //! Parameters of the segments of a `ClothoidList` stored as structure of
+  //! arrays. The vector kernels of the batch evaluation gather from these
+  //! arrays the parameters of a different segment in each lane.
+  //! The initial abscissae of the segments are the breakpoints of the list.
+  //!
+  class ClothoidSegmentArrays {
+   public:
+    vector<real_type> x0;      //!< initial \f$ x \f$
+    vector<real_type> y0;      //!< initial \f$ y \f$
+    vector<real_type> theta0;  //!< initial angle
+    vector<real_type> kappa0;  //!< initial curvature
+    vector<real_type> dk;      //!< curvature derivative
+    vector<real_type> L;       //!< length
+
+    //! Number of stored segments.
+    size_t size() const { return L.size(); }
+
+    //! Remove all the segments.
+    void clear() { resize(0); }
+
+    //! Keep the first `n` segments (`n` must not exceed `size()`).
+    void resize(size_t n) {
+      x0.resize(n);
+      y0.resize(n);
+      theta0.resize(n);
+      kappa0.resize(n);
+      dk.resize(n);
+      L.resize(n);
+    }
+
+    //! Reserve room for `n` segments.
+    void reserve(size_t n) {
+      x0.reserve(n);
+      y0.reserve(n);
+      theta0.reserve(n);
+      kappa0.reserve(n);
+      dk.reserve(n);
+      L.reserve(n);
+    }
+
+    //! Append the parameters of `c`.
+    void push_back(ClothoidSegment const & c) {
+      x0.push_back(c.CD.x0);
+      y0.push_back(c.CD.y0);
+      theta0.push_back(c.CD.theta0);
+      kappa0.push_back(c.CD.kappa0);
+      dk.push_back(c.CD.dk);
+      L.push_back(c.L);
+    }
+  };
+
   /*\
    |   ____ _       _   _           _     _ _     _     _
    |  / ___| | ___ | |_| |__   ___ (_) __| | |   (_)___| |_
@@ -723,11 +958,13 @@ namespace G2lib {
   //! \endrst
   //!
   class ClothoidList : public BaseCurve {
-    bool                  m_curve_is_closed;
-    vector<real_type>     m_s0;
-    vector<ClothoidCurve> m_clotoidList;
+    bool                    m_curve_is_closed;
+    vector<real_type>       m_s0;
+    vector<ClothoidSegment> m_clotoidList;
+    ClothoidSegmentArrays   m_soa;  // mirror of m_clotoidList for the batch kernels
 
     mutable Utils::ThreadLocalData<int_type> m_lastInterval;
+    ArcLengthIndex                           m_s_index;
 
     mutable bool               m_aabb_done;
     mutable AABBtree           m_aabb_tree;
@@ -736,6 +973,24 @@ namespace G2lib {
     mutable real_type          m_aabb_max_size;
     mutable vector<Triangle2D> m_aabb_tri;
 
+    // collapse the triangle positions stored in `segments` to segment ranges
+    void triangle_ranges(vector<int_type> & segments, vector<real_type> & s_begin, vector<real_type> & s_end) const;
+
+    // insert in the AABB tree, if built, the triangles of the segments from `first`
+    void aabb_push_back(size_t first);
+
+    // refit the AABB tree after a rigid motion of the triangles
+    void aabb_refit();
+
+    // append a segment record, as `push_back(ClothoidCurve const &)`
+    void push_back_segment(ClothoidSegment const & c);
+
+    // copy in the structure of arrays the segments from `first`
+    void soa_push_back(size_t first);
+
+    // take the segments and the cached AABB tree of `L`, which is left empty
+    void move_from(ClothoidList & L) noexcept;
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     class T2D_collision_list_ISO {
       ClothoidList const * pList1;
@@ -759,11 +1014,22 @@ namespace G2lib {
     };
 #endif
 
-    void resetLastInterval() { *m_lastInterval.search(std::this_thread::get_id()) = 0; }
+    void resetLastInterval() { m_lastInterval.get() = 0; }
 
     int_type closest_point_internal(
         real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const;
 
+    void eval_batch_range(
+        int_type          i0,
+        int_type          i1,
+        real_type const * s,
+        bool              sorted,
+        real_type         offs,
+        real_type *       x,
+        real_type *       y,
+        real_type *       theta,
+        real_type *       kappa) const;
+
    public:
 #include "BaseCurve_using.hxx"
 
@@ -777,6 +1043,7 @@ namespace G2lib {
     ~ClothoidList() override {
       m_s0.clear();
       m_clotoidList.clear();
+      m_soa.clear();
       m_aabb_tri.clear();
     }
 
@@ -789,6 +1056,15 @@ namespace G2lib {
       copy(s);
     }
 
+    //!
+    //! Build a clothoid list taking the segments, the arc-length index and
+    //! the cached AABB tree of `s`, which is left empty
+    //!
+    ClothoidList(ClothoidList && s) noexcept
+        : BaseCurve(G2LIB_CLOTHOID_LIST), m_curve_is_closed(false), m_aabb_done(false) {
+      move_from(s);
+    }
+
     //!
     //! Initialize the clothoid list
     //!
@@ -812,6 +1088,14 @@ namespace G2lib {
       return *this;
     }
 
+    //!
+    //! Move an existing clothoid list, see the move constructor
+    //!
+    ClothoidList const & operator=(ClothoidList && s) noexcept {
+      move_from(s);
+      return *this;
+    }
+
     //!
     //! Build a clothoid from a line segment
     //!
@@ -1083,14 +1367,26 @@ namespace G2lib {
     }
 
     //!
-    //! Get the `idx`-th clothoid of the list
+    //! Get a copy of the `idx`-th clothoid of the list.
+    //!
+    //! \note The list stores compact `ClothoidSegment` records, so the
+    //!       curve is built at each call and returned by value (it used
+    //!       to be a `ClothoidCurve const &`). Use `segment(idx)` for a
+    //!       reference to the stored record.
+    //!
+    ClothoidCurve get(int_type idx) const;
+
+    //!
+    //! Get a copy of the `idx`-th clothoid of the list where `idx` is the clothoid at parameter `s`,
+    //! see `get` for the return by value
     //!
-    ClothoidCurve const & get(int_type idx) const;
+    ClothoidCurve getAtS(real_type s) const;
 
     //!
-    //! Get the `idx`-th clothoid of the list where `idx` is the clothoid at parameter `s`
+    //! The compact record of the `idx`-th clothoid of the list, cheaper
+    //! than `get` when only the evaluation of the segment is needed
     //!
-    ClothoidCurve const & getAtS(real_type s) const;
+    ClothoidSegment const & segment(int_type idx) const { return m_clotoidList[size_t(idx)]; }
 
     //!
     //! Return the numbber of clothoid of the list
@@ -1109,6 +1405,31 @@ namespace G2lib {
     //!
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` but the search starts from the caller-owned
+    //! interval `hint`, updated with the result. No locking is involved,
+    //! see `CurveCursor`.
+    //!
+    int_type findAtS(real_type & s, int_type & hint) const;
+
+    //!
+    //! Curvilinear coordinate of the beginning of the `idx`-th segment
+    //!
+    real_type segment_s0(int_type idx) const { return m_s0[size_t(idx)]; }
+
+    //!
+    //! Build the arc-length index used by `findAtS` for random access,
+    //! it is built by the `build*` methods and refreshed by `scale`,
+    //! `reverse` and `trim` and extended by `push_back` (amortized
+    //! \f$ O(1) \f$ per segment).
+    //!
+    void build_s_index() { m_s_index.build(int_type(m_s0.size()), m_s0.data()); }
+
+    //!
+    //! Drop the arc-length index
+    //!
+    void clear_s_index() { m_s_index.clear(); }
+
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
     real_type length() const override;
@@ -1277,6 +1598,68 @@ namespace G2lib {
 
     // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override;
+
+    //!
+    //! Sample the list at \f$ s = s_0, s_0+ds, \ldots \f$ up to the end of
+    //! the list, walking the segments in order (no search per point) and
+    //! marching forward inside each segment.
+    //! The buffers must hold `sample_uniform_size(ds)` values,
+    //! `theta` and `kappa` may be `nullptr`. Return the number of samples.
+    //!
+    int_type sample_uniform(
+        real_type   ds,
+        real_type * x,
+        real_type * y,
+        real_type * theta = nullptr,
+        real_type * kappa = nullptr) const;
+
+    //!
+    //! Number of samples produced by `sample_uniform(ds,...)`. A length
+    //! that is a multiple of `ds` up to rounding keeps its last sample.
+    //!
+    int_type sample_uniform_size(real_type ds) const {
+      return int_type(floor(this->length() / ds * (1 + Utils::machepsi100))) + 1;
+    }
+
+    //!
+    //! Evaluate the list at the `n` curvilinear coordinates `s`, storing
+    //! position and, when not `nullptr`, angle and curvature.
+    //! If `s` is non decreasing the segments are walked in lockstep with
+    //! the samples (no search), otherwise each point is located with a
+    //! hinted `findAtS`. Large batches are split in contiguous chunks over
+    //! `n_threads` workers (`0` = hardware concurrency), each chunk covers
+    //! a contiguous range of segments.
+    //! The points are evaluated in blocks: the segments are located first,
+    //! then the parameters are gathered from the structure of arrays mirror
+    //! of the segments and the positions are computed with the vector kernels.
+    //!
+    void eval_batch(
+        int_type          n,
+        real_type const * s,
+        real_type *       x,
+        real_type *       y,
+        real_type *       theta     = nullptr,
+        real_type *       kappa     = nullptr,
+        int_type          n_threads = 0) const;
+
+    //!
+    //! Evaluate the list at the `n` curvilinear coordinates `s` with
+    //! offset `offs`, as `evaluate_ISO`, storing position and, when not
+    //! `nullptr`, angle and scaled curvature. See `eval_batch`.
+    //!
+    void eval_batch_ISO(
+        int_type          n,
+        real_type const * s,
+        real_type         offs,
+        real_type *       x,
+        real_type *       y,
+        real_type *       theta     = nullptr,
+        real_type *       kappa     = nullptr,
+        int_type          n_threads = 0) const;
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
     real_type X(real_type s) const override;
     real_type Y(real_type s) const override;
     real_type X_D(real_type s) const override;
@@ -1399,6 +1782,48 @@ namespace G2lib {
     //!
     int_type closest_segment(real_type qx, real_type qy) const;
 
+    //!
+    //! Select the segments near the rectangle `[xmin,xmax]x[ymin,ymax]`,
+    //! i.e. the segments with a covering triangle whose bbox overlaps it.
+    //! The output vectors are reused, so repeated queries do not allocate.
+    //!
+    //! \param[in]  xmin     x-minimum of the rectangle
+    //! \param[in]  ymin     y-minimum of the rectangle
+    //! \param[in]  xmax     x-maximum of the rectangle
+    //! \param[in]  ymax     y-maximum of the rectangle
+    //! \param[out] segments index of the selected segments, increasing
+    //! \param[out] s_begin  curvilinear abscissa where the selected part of each segment begins
+    //! \param[out] s_end    curvilinear abscissa where the selected part of each segment ends
+    //!
+    void segments_in_box(
+        real_type           xmin,
+        real_type           ymin,
+        real_type           xmax,
+        real_type           ymax,
+        vector<int_type> &  segments,
+        vector<real_type> & s_begin,
+        vector<real_type> & s_end) const;
+
+    //!
+    //! Select the segments with a covering triangle at distance not greater
+    //! than `r` from the point `(x,y)`.
+    //! The output vectors are reused, so repeated queries do not allocate.
+    //!
+    //! \param[in]  x        x-coordinate of the center
+    //! \param[in]  y        y-coordinate of the center
+    //! \param[in]  r        radius
+    //! \param[out] segments index of the selected segments, increasing
+    //! \param[out] s_begin  curvilinear abscissa where the selected part of each segment begins
+    //! \param[out] s_end    curvilinear abscissa where the selected part of each segment ends
+    //!
+    void segments_in_radius(
+        real_type           x,
+        real_type           y,
+        real_type           r,
+        vector<int_type> &  segments,
+        vector<real_type> & s_begin,
+        vector<real_type> & s_end) const;
+
     //!
     //! \param  qx           x-coordinate of the point
     //! \param  qy           y-coordinate of the point
@@ -1653,6 +2078,14 @@ namespace G2lib {
     void intersect_ISO(
         real_type offs, ClothoidList const & CL, real_type offs_obj, IntersectList & ilist, bool swap_s_vals) const;
 
+    //!
+    //! Ray casting, the candidate triangles of the AABB tree are refined
+    //! with the Newton iteration of the intersection.
+    //!
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
+
     //!
     //! Save Clothoid list to a stream
     //!
@@ -1730,9 +2163,17 @@ namespace G2lib {
     mutable real_type * m_k_2;
     mutable real_type * m_dk_1;
     mutable real_type * m_dk_2;
+    mutable real_type * m_A;  // last solution of the G1 problems, warm start of the next
 
     real_type diff2pi(real_type in) const { return in - Utils::m_2pi * round(in / Utils::m_2pi); }
 
+    //!
+    //! Solve the hermite G1 problems of all the segments with
+    //! `build_G1_batch_warm` filling the work vectors, the Newton
+    //! iterations start from the solution of the previous call
+    //!
+    void build_segments(real_type const * theta, bool compute_deriv) const;
+
    public:
     ClothoidSplineG2() : /* realValues("ClothoidSplineG2"),*/ m_tt(P1) {}
 
@@ -23,8 +23,6 @@
  * SOFTWARE.
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #pragma once
-#include <utility>
-#include <map>
 #include "Types.hxx"
 
 namespace G2lib {
@@ -38,59 +36,38 @@ namespace G2lib {
     G2LIB_CLOTHOID_LIST
   } CurveType;
 
-  #ifndef DOXYGEN_SHOULD_SKIP_THIS
-
-  using Ppair = std::pair<CurveType, CurveType>;
-
-  // check if compiler is C++11
-  static std::map<Ppair, CurveType> const promote_map = {
-    { Ppair(G2LIB_LINE, G2LIB_LINE), G2LIB_LINE },
-    { Ppair(G2LIB_LINE, G2LIB_CIRCLE), G2LIB_CIRCLE },
-    { Ppair(G2LIB_LINE, G2LIB_CLOTHOID), G2LIB_CLOTHOID },
-    { Ppair(G2LIB_LINE, G2LIB_BIARC), G2LIB_BIARC_LIST },
-    { Ppair(G2LIB_LINE, G2LIB_BIARC_LIST), G2LIB_BIARC_LIST },
-    { Ppair(G2LIB_LINE, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_LINE, G2LIB_POLYLINE), G2LIB_POLYLINE },
-
-    { Ppair(G2LIB_CIRCLE, G2LIB_LINE), G2LIB_CIRCLE },
-    { Ppair(G2LIB_CIRCLE, G2LIB_CIRCLE), G2LIB_CIRCLE },
-    { Ppair(G2LIB_CIRCLE, G2LIB_CLOTHOID), G2LIB_CLOTHOID },
-    { Ppair(G2LIB_CIRCLE, G2LIB_BIARC), G2LIB_BIARC_LIST },
-    { Ppair(G2LIB_CIRCLE, G2LIB_BIARC_LIST), G2LIB_BIARC_LIST },
-    { Ppair(G2LIB_CIRCLE, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CIRCLE, G2LIB_POLYLINE), G2LIB_CLOTHOID_LIST },
+  //! Number of the curve types
+  inline constexpr int_type CurveType_count = G2LIB_CLOTHOID_LIST + 1;
 
-    { Ppair(G2LIB_BIARC, G2LIB_LINE), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_BIARC, G2LIB_CIRCLE), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_BIARC, G2LIB_CLOTHOID), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_BIARC, G2LIB_BIARC), G2LIB_BIARC },
-    { Ppair(G2LIB_BIARC, G2LIB_BIARC_LIST), G2LIB_BIARC_LIST },
-    { Ppair(G2LIB_BIARC, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_BIARC, G2LIB_POLYLINE), G2LIB_CLOTHOID_LIST },
-
-    { Ppair(G2LIB_CLOTHOID, G2LIB_LINE), G2LIB_CLOTHOID },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_CIRCLE), G2LIB_CLOTHOID },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_CLOTHOID), G2LIB_CLOTHOID },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_BIARC), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_BIARC_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID, G2LIB_POLYLINE), G2LIB_CLOTHOID_LIST },
-
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_LINE), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_CIRCLE), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_BIARC), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_BIARC_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_CLOTHOID_LIST, G2LIB_POLYLINE), G2LIB_CLOTHOID_LIST },
+  #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
-    { Ppair(G2LIB_POLYLINE, G2LIB_LINE), G2LIB_POLYLINE },
-    { Ppair(G2LIB_POLYLINE, G2LIB_CIRCLE), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_POLYLINE, G2LIB_CLOTHOID), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_POLYLINE, G2LIB_BIARC), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_POLYLINE, G2LIB_BIARC_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_POLYLINE, G2LIB_CLOTHOID_LIST), G2LIB_CLOTHOID_LIST },
-    { Ppair(G2LIB_POLYLINE, G2LIB_POLYLINE), G2LIB_POLYLINE }
+  //
+  // Type the two curves are converted to for collision and intersection,
+  // indexed as promote_table[type of the first][type of the second].
+  // Columns: LINE, POLYLINE, CIRCLE, BIARC, BIARC_LIST, CLOTHOID, CLOTHOID_LIST
+  //
+  inline constexpr CurveType promote_table[CurveType_count][CurveType_count] = {
+    // G2LIB_LINE
+    { G2LIB_LINE, G2LIB_POLYLINE, G2LIB_CIRCLE, G2LIB_BIARC_LIST,
+      G2LIB_BIARC_LIST, G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST },
+    // G2LIB_POLYLINE
+    { G2LIB_POLYLINE, G2LIB_POLYLINE, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST,
+      G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST },
+    // G2LIB_CIRCLE
+    { G2LIB_CIRCLE, G2LIB_CLOTHOID_LIST, G2LIB_CIRCLE, G2LIB_BIARC_LIST,
+      G2LIB_BIARC_LIST, G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST },
+    // G2LIB_BIARC
+    { G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_BIARC,
+      G2LIB_BIARC_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST },
+    // G2LIB_BIARC_LIST
+    { G2LIB_BIARC_LIST, G2LIB_CLOTHOID_LIST, G2LIB_BIARC_LIST, G2LIB_BIARC_LIST,
+      G2LIB_BIARC_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST },
+    // G2LIB_CLOTHOID
+    { G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST,
+      G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID, G2LIB_CLOTHOID_LIST },
+    // G2LIB_CLOTHOID_LIST
+    { G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST,
+      G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST, G2LIB_CLOTHOID_LIST }
   };
 
 #endif
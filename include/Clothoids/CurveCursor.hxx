@@ -0,0 +1,338 @@
+/** * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * @file CurveCursor.hxx
+ * @author Matteo Ragni (info@ragni.me)
+ *
+ * @copyright Copyright (c) 2022 Matteo Ragni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Based on the work of:
+ * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#pragma once
+#include "ClothoidList.hxx"
+
+#include <type_traits>
+#include <utility>
+
+namespace G2lib {
+
+  /*\
+   |    ____                       ____
+   |   / ___|   _ _ ____   _____ / ___|   _ _ __ ___  ___  _ __
+   |  | |  | | | | '__\ \ / / _ \ |  | | | | '__/ __|/ _ \| '__|
+   |  | |__| |_| | |   \ V /  __/ |__| |_| | |  \__ \ (_) | |
+   |   \____\__,_|_|    \_/ \___|\____\__,_|_|  |___/\___/|_|
+  \*/
+
+  //!
+  //! Evaluator of a list of curves (`ClothoidList`, `BiarcList` or
+  //! `PolyLine`) owned by the caller.
+  //!
+  //! The cursor keeps the index of the last segment found and uses it as
+  //! the starting point of the next search, as the list does with its
+  //! per-thread hint, but without locking: each thread uses its own cursor.
+  //! Sequential queries (increasing or decreasing `s`) find the segment
+  //! in constant time.
+  //!
+  //! The list must outlive the cursor, after the list is modified the
+  //! cursor is still valid but the hint restarts from the first segment.
+  //!
+  //! \code{.cpp}
+  //!   ClothoidListCursor C(list);
+  //!   for ( real_type s = 0; s < list.length(); s += ds ) C.eval( s, x, y );
+  //! \endcode
+  //!
+  template<typename LIST> class CurveCursor {
+   public:
+    using list_type    = LIST;
+    using segment_type = std::decay_t<decltype(std::declval<LIST const &>().segment(0))>;
+
+   private:
+    LIST const * m_list;
+    int_type     m_hint;
+
+    //!
+    //! Find the segment containing `s`, on exit `s` is local to the segment
+    //!
+    segment_type const & locate(real_type & s) {
+      int_type idx = m_list->findAtS(s, m_hint);
+      s -= m_list->segment_s0(idx);
+      return m_list->segment(idx);
+    }
+
+   public:
+    explicit CurveCursor(LIST const & L) : m_list(&L), m_hint(0) {}
+
+    //!
+    //! The list evaluated by the cursor
+    //!
+    LIST const & list() const { return *m_list; }
+
+    //!
+    //! Restart the search from the first segment
+    //!
+    void reset() { m_hint = 0; }
+
+    //!
+    //! Index of the segment found by the last query
+    //!
+    int_type last_segment() const { return m_hint; }
+
+    //!
+    //! Find the segment whose definition range contains `s`
+    //!
+    int_type findAtS(real_type & s) { return m_list->findAtS(s, m_hint); }
+
+    /*\
+     |  _   _          _
+     | | |_| |__   ___| |_ __ _
+     | | __| '_ \ / _ \ __/ _` |
+     | | |_| | | |  __/ || (_| |
+     |  \__|_| |_|\___|\__\__,_|
+    \*/
+
+    real_type theta(real_type s) {
+      segment_type const & S = locate(s);
+      return S.theta(s);
+    }
+
+    real_type theta_D(real_type s) {
+      segment_type const & S = locate(s);
+      return S.theta_D(s);
+    }
+
+    real_type theta_DD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.theta_DD(s);
+    }
+
+    real_type theta_DDD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.theta_DDD(s);
+    }
+
+    real_type kappa(real_type s) { return theta_D(s); }
+    real_type kappa_D(real_type s) { return theta_DD(s); }
+    real_type kappa_DD(real_type s) { return theta_DDD(s); }
+
+    void tg(real_type s, real_type & tg_x, real_type & tg_y) {
+      segment_type const & S = locate(s);
+      S.tg(s, tg_x, tg_y);
+    }
+
+    void nor_ISO(real_type s, real_type & nx, real_type & ny) {
+      segment_type const & S = locate(s);
+      S.nor_ISO(s, nx, ny);
+    }
+
+    /*\
+     |                  _             _
+     |   _____   ____ _| |_   _  __ _| |_ ___
+     |  / _ \ \ / / _` | | | | |/ _` | __/ _ \
+     | |  __/\ V / (_| | | |_| | (_| | ||  __/
+     |  \___| \_/ \__,_|_|\__,_|\__,_|\__\___|
+    \*/
+
+    void evaluate(real_type s, real_type & th, real_type & k, real_type & x, real_type & y) {
+      segment_type const & S = locate(s);
+      S.evaluate(s, th, k, x, y);
+    }
+
+    void evaluate_ISO(real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) {
+      segment_type const & S = locate(s);
+      S.evaluate_ISO(s, offs, th, k, x, y);
+    }
+
+    void evaluate_SAE(real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) {
+      segment_type const & S = locate(s);
+      S.evaluate_SAE(s, offs, th, k, x, y);
+    }
+
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) {
+      segment_type const & S = locate(s);
+      S.evaluate_jet(s, offs, J);
+    }
+
+    /*\
+     |  __  __   __   __
+     |  \ \/ /   \ \ / /
+     |   \  /     \ V /
+     |   /  \ _    | |
+     |  /_/\_( )   |_|
+     |       |/
+    \*/
+
+    real_type X(real_type s) {
+      segment_type const & S = locate(s);
+      return S.X(s);
+    }
+
+    real_type Y(real_type s) {
+      segment_type const & S = locate(s);
+      return S.Y(s);
+    }
+
+    real_type X_D(real_type s) {
+      segment_type const & S = locate(s);
+      return S.X_D(s);
+    }
+
+    real_type Y_D(real_type s) {
+      segment_type const & S = locate(s);
+      return S.Y_D(s);
+    }
+
+    real_type X_DD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.X_DD(s);
+    }
+
+    real_type Y_DD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.Y_DD(s);
+    }
+
+    real_type X_DDD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.X_DDD(s);
+    }
+
+    real_type Y_DDD(real_type s) {
+      segment_type const & S = locate(s);
+      return S.Y_DDD(s);
+    }
+
+    void eval(real_type s, real_type & x, real_type & y) {
+      segment_type const & S = locate(s);
+      S.eval(s, x, y);
+    }
+
+    void eval_D(real_type s, real_type & x_D, real_type & y_D) {
+      segment_type const & S = locate(s);
+      S.eval_D(s, x_D, y_D);
+    }
+
+    void eval_DD(real_type s, real_type & x_DD, real_type & y_DD) {
+      segment_type const & S = locate(s);
+      S.eval_DD(s, x_DD, y_DD);
+    }
+
+    void eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) {
+      segment_type const & S = locate(s);
+      S.eval_DDD(s, x_DDD, y_DDD);
+    }
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    real_type X_ISO(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.X_ISO(s, offs);
+    }
+
+    real_type Y_ISO(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.Y_ISO(s, offs);
+    }
+
+    real_type X_ISO_D(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.X_ISO_D(s, offs);
+    }
+
+    real_type Y_ISO_D(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.Y_ISO_D(s, offs);
+    }
+
+    real_type X_ISO_DD(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.X_ISO_DD(s, offs);
+    }
+
+    real_type Y_ISO_DD(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.Y_ISO_DD(s, offs);
+    }
+
+    real_type X_ISO_DDD(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.X_ISO_DDD(s, offs);
+    }
+
+    real_type Y_ISO_DDD(real_type s, real_type offs) {
+      segment_type const & S = locate(s);
+      return S.Y_ISO_DDD(s, offs);
+    }
+
+    void eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) {
+      segment_type const & S = locate(s);
+      S.eval_ISO(s, offs, x, y);
+    }
+
+    void eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) {
+      segment_type const & S = locate(s);
+      S.eval_ISO_D(s, offs, x_D, y_D);
+    }
+
+    void eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) {
+      segment_type const & S = locate(s);
+      S.eval_ISO_DD(s, offs, x_DD, y_DD);
+    }
+
+    void eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) {
+      segment_type const & S = locate(s);
+      S.eval_ISO_DDD(s, offs, x_DDD, y_DDD);
+    }
+
+    // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+    real_type X_SAE(real_type s, real_type offs) { return X_ISO(s, -offs); }
+    real_type Y_SAE(real_type s, real_type offs) { return Y_ISO(s, -offs); }
+    real_type X_SAE_D(real_type s, real_type offs) { return X_ISO_D(s, -offs); }
+    real_type Y_SAE_D(real_type s, real_type offs) { return Y_ISO_D(s, -offs); }
+    real_type X_SAE_DD(real_type s, real_type offs) { return X_ISO_DD(s, -offs); }
+    real_type Y_SAE_DD(real_type s, real_type offs) { return Y_ISO_DD(s, -offs); }
+    real_type X_SAE_DDD(real_type s, real_type offs) { return X_ISO_DDD(s, -offs); }
+    real_type Y_SAE_DDD(real_type s, real_type offs) { return Y_ISO_DDD(s, -offs); }
+
+    void eval_SAE(real_type s, real_type offs, real_type & x, real_type & y) { eval_ISO(s, -offs, x, y); }
+
+    void eval_SAE_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) {
+      eval_ISO_D(s, -offs, x_D, y_D);
+    }
+
+    void eval_SAE_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) {
+      eval_ISO_DD(s, -offs, x_DD, y_DD);
+    }
+
+    void eval_SAE_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) {
+      eval_ISO_DDD(s, -offs, x_DDD, y_DDD);
+    }
+  };
+
+  using ClothoidListCursor = CurveCursor<ClothoidList>;  //!< cursor over a `ClothoidList`
+  using BiarcListCursor    = CurveCursor<BiarcList>;     //!< cursor over a `BiarcList`
+  using PolyLineCursor     = CurveCursor<PolyLine>;      //!< cursor over a `PolyLine`
+
+}  // namespace G2lib
+
+///
+/// eof: CurveCursor.hxx
+///
@@ -30,6 +30,8 @@
 
 namespace G2lib {
 
+  struct CurveJet;
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   /*\
@@ -39,11 +41,31 @@ namespace G2lib {
    |  |  _|| | |  __/\__ \ | | |  __/ |
    |  |_|  |_|  \___||___/_| |_|\___|_|
   \*/
+  //!
+  //! Accuracy tier of the Fresnel integrals evaluation:
+  //!
+  //! - `Exact`: full double precision (the default);
+  //! - `Fast`: tabulated, absolute error against `Exact` below 1E-11 for
+  //!   `FresnelCS` and 1E-9 for `GeneralizedFresnelCS`;
+  //! - `Draft`: tabulated, absolute error against `Exact` below 1E-7 for
+  //!   `FresnelCS` and 1E-6 for `GeneralizedFresnelCS`, for visualization
+  //!   and broad-phase queries.
+  //!
+  //! The bounds of `GeneralizedFresnelCS` hold for \f$ |b| \leq 100 \f$,
+  //! the range where `Exact` is accurate for small \f$ |a| \f$.
+  //!
+  enum class FresnelAccuracy { Exact, Fast, Draft };
+
   /*
    * Compute Fresnel integrals
    */
   void FresnelCS(real_type x, real_type & C, real_type & S);
 
+  //!
+  //! Compute Fresnel integrals with the accuracy tier `acc`
+  //!
+  void FresnelCS(real_type x, real_type & C, real_type & S, FresnelAccuracy acc);
+
   //!
   //! Compute Fresnel integrals and its derivatives
   //!
@@ -56,6 +78,28 @@ namespace G2lib {
   //!
   void FresnelCS(int_type nk, real_type x, real_type * C, real_type * S);
 
+  //!
+  //! Compute Fresnel integrals and its derivatives with the accuracy tier `acc`
+  //!
+  void FresnelCS(int_type nk, real_type x, real_type * C, real_type * S, FresnelAccuracy acc);
+
+  //!
+  //! Compute Fresnel integrals for an array of abscissae
+  //!
+  //! \f[ C(x) = \int_0^x \cos\left(\frac{\pi}{2}t^2\right) dt, \qquad
+  //!     S(x) = \int_0^x \sin\left(\frac{\pi}{2}t^2\right) dt \f]
+  //! \param n  number of abscissae
+  //! \param x  the input abscissae, `n` values
+  //! \param C  C[i]=\f$ C(x_i) \f$
+  //! \param S  S[i]=\f$ S(x_i) \f$
+  //!
+  //! \note The vector kernel is used only when the library is compiled
+  //!       for AVX2+FMA or AVX-512 (`CLOTHOIDS_ENABLE_NATIVE_ARCH`), there
+  //!       is no run time dispatch. Otherwise the elements go through the
+  //!       scalar routine.
+  //!
+  void FresnelCS_batch(int_type n, real_type const * x, real_type * C, real_type * S);
+
   //!
   //! Compute the Fresnel integrals
   //!
@@ -73,6 +117,18 @@ namespace G2lib {
   //!
   void GeneralizedFresnelCS(int_type nk, real_type a, real_type b, real_type c, real_type * intC, real_type * intS);
 
+  //!
+  //! Compute the generalized Fresnel integrals with the accuracy tier `acc`
+  //!
+  void GeneralizedFresnelCS(
+      int_type        nk,
+      real_type       a,
+      real_type       b,
+      real_type       c,
+      real_type *     intC,
+      real_type *     intS,
+      FresnelAccuracy acc);
+
   //!
   //! Compute the Fresnel integrals
   //!
@@ -88,6 +144,44 @@ namespace G2lib {
   //!
   void GeneralizedFresnelCS(real_type a, real_type b, real_type c, real_type & intC, real_type & intS);
 
+  //!
+  //! Compute the generalized Fresnel integrals with the accuracy tier `acc`
+  //!
+  void GeneralizedFresnelCS(
+      real_type a, real_type b, real_type c, real_type & intC, real_type & intS, FresnelAccuracy acc);
+
+  //!
+  //! Compute the Fresnel integrals for `n` triples \f$ (a_i, b_i, c_i) \f$
+  //!
+  //! \f[
+  //!   \int_0^1 t^k \cos\left(a_i\frac{t^2}{2} + b_i t + c_i\right) dt,\qquad
+  //!   \int_0^1 t^k \sin\left(a_i\frac{t^2}{2} + b_i t + c_i\right) dt
+  //! \f]
+  //!
+  //! \param n    number of triples
+  //! \param nk   number of momentae to compute (1..3)
+  //! \param a    parameters \f$ a_i \f$, `n` values
+  //! \param b    parameters \f$ b_i \f$, `n` values
+  //! \param c    parameters \f$ c_i \f$, `n` values
+  //! \param intC cosine integrals, moment `k` of triple `i` in `intC[k*n+i]`
+  //! \param intS sine integrals, moment `k` of triple `i` in `intS[k*n+i]`
+  //!
+  //! \note The triples with \f$ |a| < 0.01 \f$ go through the scalar routine
+  //!       and give its results. The others may use the vector kernel,
+  //!       which agrees with the scalar routine to 1E-13 for
+  //!       \f$ |a| \geq 1 \f$. For \f$ 0.01 \leq |a| < 1 \f$ the formula of
+  //!       both paths loses digits by cancellation, they are accurate to
+  //!       1E-12, 1E-11 and 1E-8 for the moments 0, 1 and 2.
+  //!
+  void GeneralizedFresnelCS(
+      int_type          n,
+      int_type          nk,
+      real_type const * a,
+      real_type const * b,
+      real_type const * c,
+      real_type *       intC,
+      real_type *       intS);
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -103,7 +197,9 @@ namespace G2lib {
     real_type kappa0;  //!< initial curvature
     real_type dk;      //!< curvature derivative
 
-    ClothoidData() : x0(0), y0(0), theta0(0), kappa0(0), dk(0) {}
+    FresnelAccuracy accuracy;  //!< accuracy tier used by the evaluation of the position
+
+    ClothoidData() : x0(0), y0(0), theta0(0), kappa0(0), dk(0), accuracy(FresnelAccuracy::Exact) {}
 
     real_type deltaTheta(real_type s) const { return s * (kappa0 + 0.5 * s * dk); }
 
@@ -218,6 +314,12 @@ namespace G2lib {
 
     void evaluate(real_type s, real_type & theta, real_type & kappa, real_type & x, real_type & y) const;
 
+    //!
+    //! Evaluate the full state at `s` with offset `offs` (ISO) with a
+    //! single Fresnel integral and a single sine/cosine evaluation
+    //!
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const;
+
     void eval(real_type s, real_type & x, real_type & y) const;
 
     void eval_D(real_type s, real_type & x_D, real_type & y_D) const;
@@ -250,6 +352,23 @@ namespace G2lib {
 
     void eval(real_type s, ClothoidData & C) const;
 
+    //!
+    //! Sample the clothoid at `n` uniformly spaced points
+    //! \f$ s_j = s_0 + j\,ds \f$ marching forward from the previous point.
+    //! The tangent is advanced by exact angle-addition recurrences and the
+    //! position by a local series of the increment, the state is re-anchored
+    //! with an exact evaluation every few steps to bound the drift.
+    //! `theta` and `kappa` may be `nullptr` if not needed.
+    //!
+    void sample_uniform(
+        real_type   s0,
+        real_type   ds,
+        int_type    n,
+        real_type * x,
+        real_type * y,
+        real_type * theta,
+        real_type * kappa) const;
+
     real_type c0x() const { return x0 - (sin(theta0) / kappa0); }
     real_type c0y() const { return y0 + (cos(theta0) / kappa0); }
 
@@ -312,6 +431,28 @@ namespace G2lib {
         real_type   k_D[2]        = nullptr,
         real_type   dk_D[2]       = nullptr);
 
+    //!
+    //! Solve the hermite G1 problem starting the Newton iterations from `A`,
+    //! the value \f$ A = \kappa' L^2/2 \f$ of a previous solution.
+    //! If `A` is far from the cold guess or Newton does not converge
+    //! the iterations restart from the cold guess. On exit `A` is the
+    //! value of the new solution.
+    //!
+    int build_G1_warm(
+        real_type   x0,
+        real_type   y0,
+        real_type   theta0,
+        real_type   x1,
+        real_type   y1,
+        real_type   theta1,
+        real_type   tol,
+        real_type & L,
+        real_type & A,
+        bool        compute_deriv = false,
+        real_type   L_D[2]        = nullptr,
+        real_type   k_D[2]        = nullptr,
+        real_type   dk_D[2]       = nullptr);
+
     bool build_forward(
         real_type   x0,
         real_type   y0,
@@ -326,6 +467,72 @@ namespace G2lib {
   };
 
 #endif
+
+  //!
+  //! Solve `n` independent hermite G1 problems
+  //! \f$ (x_{0,i}, y_{0,i}, \theta_{0,i}) \to (x_{1,i}, y_{1,i}, \theta_{1,i}) \f$
+  //! at once. The Newton iterations of all the problems are advanced
+  //! together, the Fresnel integrals are computed with the vectorized
+  //! kernel and problems leave the iteration as soon as they converge.
+  //!
+  //! \param[in]  n     number of problems
+  //! \param[in]  x0    initial x positions
+  //! \param[in]  y0    initial y positions
+  //! \param[in]  th0   initial angles
+  //! \param[in]  x1    final x positions
+  //! \param[in]  y1    final y positions
+  //! \param[in]  th1   final angles
+  //! \param[in]  tol   tolerance of the Newton iterations
+  //! \param[out] L     lengths \f$ L_i \f$
+  //! \param[out] k     initial curvatures \f$ \kappa_i \f$
+  //! \param[out] dk    curvature variations \f$ \kappa'_i \f$
+  //! \param[out] L_D   if not `nullptr` derivatives of \f$ L_i \f$ w.r.t.
+  //!                   \f$ \theta_{0,i} \f$ in `L_D[i]` and w.r.t.
+  //!                   \f$ \theta_{1,i} \f$ in `L_D[n+i]`
+  //! \param[out] k_D   derivatives of \f$ \kappa_i \f$, same layout of `L_D`
+  //! \param[out] dk_D  derivatives of \f$ \kappa'_i \f$, same layout of `L_D`
+  //! \return maximum number of iteration performed
+  //!
+  int_type build_G1_batch(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * th0,
+      real_type const * x1,
+      real_type const * y1,
+      real_type const * th1,
+      real_type         tol,
+      real_type *       L,
+      real_type *       k,
+      real_type *       dk,
+      real_type *       L_D  = nullptr,
+      real_type *       k_D  = nullptr,
+      real_type *       dk_D = nullptr);
+
+  //!
+  //! As `build_G1_batch` but the Newton iterations start from `A`,
+  //! the values \f$ A_i = \kappa'_i L_i^2/2 \f$ of a previous solution.
+  //! Problems whose warm start is far from the cold guess or does not
+  //! converge restart from the cold guess. On exit `A` holds the values
+  //! of the new solutions.
+  //!
+  int_type build_G1_batch_warm(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * th0,
+      real_type const * x1,
+      real_type const * y1,
+      real_type const * th1,
+      real_type         tol,
+      real_type *       A,
+      real_type *       L,
+      real_type *       k,
+      real_type *       dk,
+      real_type *       L_D  = nullptr,
+      real_type *       k_D  = nullptr,
+      real_type *       dk_D = nullptr);
+
 }  // namespace G2lib
 
 ///
@@ -34,6 +34,7 @@
 //!
 namespace G2lib {
   extern bool            intersect_with_AABBtree;
+  extern int_type        intersect_num_threads;
 
   //!
   //! Disable AABB tree in computation
@@ -45,6 +46,14 @@ namespace G2lib {
   //!
   static inline void yesAABBtree() { intersect_with_AABBtree = true; }
 
+  //!
+  //! Set the number of threads used by the intersections and collisions
+  //! of curve lists with AABB tree (`0` = hardware concurrency), small
+  //! problems run on a single thread. The default is `1`, the queries
+  //! do not start threads unless asked to
+  //!
+  static inline void setIntersectThreads(int_type n) { intersect_num_threads = n; }
+
   /*
    * sin(x)/x
    */
@@ -329,10 +338,11 @@ namespace G2lib {
       real_type *       len);
 
 
-  // Without inline it will not compile.
-  inline CurveType curve_promote(CurveType A, CurveType B) {
-    return promote_map.at(Ppair(A, B));
-  }
+  //!
+  //! Type the curves of type `A` and `B` are converted to for
+  //! collision and intersection
+  //!
+  constexpr CurveType curve_promote(CurveType A, CurveType B) { return promote_table[A][B]; }
 
 }  // namespace G2lib
 
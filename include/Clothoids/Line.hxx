@@ -414,6 +414,10 @@ namespace G2lib {
       }
     }
 
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
+
     bool collision(LineSegment const & S) const;
 
     bool collision_ISO(real_type offs, LineSegment const & S, real_type S_offs) const;
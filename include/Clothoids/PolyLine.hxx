@@ -30,6 +30,7 @@
 #include "Line.hxx"
 #include "AABBtree.hxx"
 #include "ThreadLocalData.hxx"
+#include "ArcLengthIndex.hxx"
 
 namespace G2lib {
 
@@ -56,10 +57,11 @@ namespace G2lib {
    private:
     vector<LineSegment> m_polylineList;
     vector<real_type>   m_s0;
-    real_type           m_xe;
-    real_type           m_ye;
+    real_type           m_xe{0};
+    real_type           m_ye{0};
 
     mutable Utils::ThreadLocalData<int_type> m_lastInterval;
+    ArcLengthIndex                           m_s_index;
 
     mutable bool     m_aabb_done;
     mutable AABBtree m_aabb_tree;
@@ -80,7 +82,16 @@ namespace G2lib {
     };
 #endif
 
-    void resetLastInterval() { *m_lastInterval.search(std::this_thread::get_id()) = 0; }
+    void resetLastInterval() { m_lastInterval.get() = 0; }
+
+    // insert in the AABB tree, if built, the last segment
+    void aabb_push_back();
+
+    // take the segments and the cached AABB tree of `PL`, which is left empty
+    void move_from(PolyLine & PL) noexcept;
+
+    // refit the AABB tree, if built, after a rigid motion
+    void aabb_refit();
 
    public:
     // explicit
@@ -96,8 +107,36 @@ namespace G2lib {
       copy(PL);
     }
 
+    // take the segments, the arc-length index and the cached AABB tree of `PL`
+    PolyLine(PolyLine && PL) noexcept : BaseCurve(G2LIB_POLYLINE), m_aabb_done(false) { move_from(PL); }
+
     int_type findAtS(real_type & s) const;
 
+    //!
+    //! As `findAtS(s)` but the search starts from the caller-owned
+    //! interval `hint`, updated with the result. No locking is involved,
+    //! see `CurveCursor`.
+    //!
+    int_type findAtS(real_type & s, int_type & hint) const;
+
+    //!
+    //! Curvilinear coordinate of the beginning of the `idx`-th segment
+    //!
+    real_type segment_s0(int_type idx) const { return m_s0[size_t(idx)]; }
+
+    //!
+    //! Build the arc-length index used by `findAtS` for random access,
+    //! it is built by the `build*` methods and refreshed by `scale`,
+    //! `reverse` and `trim` and extended by `push_back` (amortized
+    //! \f$ O(1) \f$ per segment).
+    //!
+    void build_s_index() { m_s_index.build(int_type(m_s0.size()), m_s0.data()); }
+
+    //!
+    //! Drop the arc-length index
+    //!
+    void clear_s_index() { m_s_index.clear(); }
+
     explicit PolyLine(LineSegment const & LS);
     explicit PolyLine(CircleArc const & C, real_type tol);
     explicit PolyLine(Biarc const & B, real_type tol);
@@ -110,8 +149,23 @@ namespace G2lib {
       return *this;
     }
 
+    PolyLine const & operator=(PolyLine && s) noexcept {
+      move_from(s);
+      return *this;
+    }
+
     LineSegment const & getSegment(int_type n) const;
 
+    //!
+    //! Get the `idx`-th segment, same as `getSegment`
+    //!
+    LineSegment const & get(int_type idx) const { return m_polylineList[size_t(idx)]; }
+
+    //!
+    //! Get the `idx`-th segment, see `CurveCursor`
+    //!
+    LineSegment const & segment(int_type idx) const { return m_polylineList[size_t(idx)]; }
+
     int_type num_segments() const { return int_type(m_polylineList.size()); }
 
     int_type numPoints() const { return int_type(m_s0.size()); }
@@ -173,7 +227,7 @@ namespace G2lib {
       this->bbTriangles_ISO(-offs, tvec, max_angle, max_size, icurve);
     }
 
-    real_type length() const override { return m_s0.back(); }
+    real_type length() const override { return m_s0.empty() ? 0 : m_s0.back(); }
 
     real_type length_ISO(real_type) const override;
 
@@ -257,6 +311,12 @@ namespace G2lib {
 
     void eval_ISO_DDD(real_type, real_type, real_type & x_DDD, real_type & y_DDD) const override { x_DDD = y_DDD = 0; }
 
+    void evaluate_jet(real_type s, real_type offs, CurveJet & J) const override {
+      int_type  idx = this->findAtS(s);
+      real_type ss  = m_s0[size_t(idx)];
+      m_polylineList[size_t(idx)].evaluate_jet(s - ss, offs, J);
+    }
+
     /*\
      |  _                        __
      | | |_ _ __ __ _ _ __  ___ / _| ___  _ __ _ __ ___
@@ -269,12 +329,14 @@ namespace G2lib {
       std::vector<LineSegment>::iterator il;
       for (il = m_polylineList.begin(); il != m_polylineList.end(); ++il)
         il->translate(tx, ty);
+      this->aabb_refit();
     }
 
     void rotate(real_type angle, real_type cx, real_type cy) override {
       std::vector<LineSegment>::iterator il;
       for (il = m_polylineList.begin(); il != m_polylineList.end(); ++il)
         il->rotate(angle, cx, cy);
+      this->aabb_refit();
     }
 
     void reverse() override;
@@ -363,7 +425,15 @@ namespace G2lib {
     //! \param[in]  swap_s_vals if true store `(s2,s1)` instead of `(s1,s2)` for each
     //!                         intersection
     //!
-    void intersect_ISO(real_type offs, PolyLine const & pl, real_type offs_pl, IntersectList & ilist, bool swap_s_vals);
+    void intersect_ISO(
+        real_type offs, PolyLine const & pl, real_type offs_pl, IntersectList & ilist, bool swap_s_vals) const;
+
+    //!
+    //! Ray casting, the segments crossed by the ray are found with the AABB tree.
+    //!
+    bool raycast_unit(
+        real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t)
+        const override;
 
     void info(ostream_type & stream) const override { stream << "PolyLine\n" << *this << '\n'; }
 
@@ -375,6 +445,9 @@ namespace G2lib {
       if (!m_aabb_done) {
         this->build_AABBtree(m_aabb_tree);
         m_aabb_done = true;
+      } else if (!m_aabb_tree.optimized()) {
+        // collapse once the segments inserted by push_back
+        m_aabb_tree.optimize();
       }
     }
   };
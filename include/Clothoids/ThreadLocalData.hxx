@@ -28,58 +28,225 @@
  *  - http://ebertolazzi.github.io/Utils/
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #pragma once
-#include <map>
-#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace G2lib {
   namespace Utils {
 
+    //!
+    //! Registry of the slots of the running threads.
+    //!
+    //! Each thread takes the lowest free slot index the first time it uses
+    //! a `ThreadLocalData` and gives it back when it exits, so the slot
+    //! indices are bounded by the number of threads alive at the same time.
+    //! Each acquisition gets a new epoch, used to recognize data left by a
+    //! thread that has already exited.
+    //!
+    class ThreadSlot {
+      unsigned      m_slot;
+      std::uint64_t m_epoch;
+
+      struct Registry {
+        std::mutex                 mutex;
+        std::vector<unsigned>      free_slots;
+        unsigned                   next_slot = 0;
+        std::atomic<std::uint64_t> next_epoch{ 1 };
+      };
+
+      static Registry & registry() {
+        static Registry R;
+        return R;
+      }
+
+      ThreadSlot() {
+        Registry &                  R = registry();
+        std::lock_guard<std::mutex> l(R.mutex);
+        if (R.free_slots.empty()) {
+          m_slot = R.next_slot++;
+        } else {
+          m_slot = R.free_slots.back();
+          R.free_slots.pop_back();
+        }
+        m_epoch = R.next_epoch.fetch_add(1, std::memory_order_relaxed);
+      }
+
+     public:
+      ~ThreadSlot() {
+        Registry &                  R = registry();
+        std::lock_guard<std::mutex> l(R.mutex);
+        R.free_slots.push_back(m_slot);
+      }
+
+      ThreadSlot(ThreadSlot const &)             = delete;
+      ThreadSlot & operator=(ThreadSlot const &) = delete;
+
+      unsigned      slot() const { return m_slot; }
+      std::uint64_t epoch() const { return m_epoch; }
+
+      //!
+      //! Slot of the calling thread
+      //!
+      static ThreadSlot const & current() {
+        static thread_local ThreadSlot S;
+        return S;
+      }
+    };
+
+    //!
+    //! One instance of `Data` for each thread using the object.
+    //!
+    //! The instances are stored in chunks indexed by the slot of the thread
+    //! (see `ThreadSlot`), allocated on first use and never moved, so the
+    //! lookup is two loads with no locking. The first 16 slots use two
+    //! chunk pointers inline in the object, the others directories of
+    //! growing size reached through one more pointer and allocated on
+    //! demand, so the object is three pointers wide and there is no limit
+    //! on the threads alive. When a thread exits its slot is reused by the
+    //! next thread, which finds the instance reset to `Data()`. Copies of
+    //! the object start with no per-thread data.
+    //!
     template<typename Data> class ThreadLocalData {
      public:
       using DataPtr = std::shared_ptr<Data>;
 
      private:
-      mutable std::mutex                 m_data_mutex;
-      std::map<std::thread::id, DataPtr> m_data;
+      struct alignas(64) Entry {  // one cache line per thread, no false sharing
+        std::uint64_t epoch = 0;
+        Data          data{};
+      };
 
-     public:
-      ThreadLocalData() {}
+      using ChunkPtr = std::atomic<Entry *>;
+
+      static constexpr unsigned CHUNK_SIZE    = 8;   // threads of a chunk
+      static constexpr unsigned INLINE_CHUNKS = 2;   // chunks inline in the object, the first 16 threads alive
+      static constexpr unsigned MAX_DIRS      = 28;  // directory d holds INLINE_CHUNKS << d chunks, any unsigned slot
+
+      // the directories of the chunks past the inline ones
+      struct Overflow {
+        std::atomic<ChunkPtr *> dirs[MAX_DIRS];
 
-      ThreadLocalData(const ThreadLocalData<Data> & other) { *this = other; }
+        Overflow() noexcept {
+          for (auto & d : dirs) d.store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~Overflow() {
+          for (unsigned d = 0; d < MAX_DIRS; ++d) {
+            ChunkPtr * dir = dirs[d].load(std::memory_order_relaxed);
+            if (dir == nullptr) continue;
+            for (unsigned i = 0; i < (INLINE_CHUNKS << d); ++i) delete[] dir[i].load(std::memory_order_relaxed);
+            delete[] dir;
+          }
+        }
+      };
 
-      ThreadLocalData(ThreadLocalData<Data> && other) { *this = other; }
+      mutable ChunkPtr                m_chunks[INLINE_CHUNKS];
+      mutable std::atomic<Overflow *> m_overflow;
+
+      // allocate `*p` on first use, the loser of a race frees its copy
+      template<typename T, typename NEW, typename DELETE>
+      static T * get_or_create(std::atomic<T *> & p, NEW const & make, DELETE const & drop) {
+        T * c = p.load(std::memory_order_acquire);
+        if (c == nullptr) {
+          T * n = make();
+          if (p.compare_exchange_strong(c, n, std::memory_order_acq_rel))
+            c = n;
+          else
+            drop(n);  // another thread allocated it
+        }
+        return c;
+      }
 
-      ~ThreadLocalData() {
-        std::lock_guard<std::mutex> l(m_data_mutex);
-        m_data.clear();
+      // pointer to the chunk k, past the inline chunks in the directories
+      ChunkPtr & chunk_ptr(unsigned k) const {
+        if (k < INLINE_CHUNKS) return m_chunks[k];
+        Overflow * O = get_or_create(m_overflow, [] { return new Overflow; }, [](Overflow * o) { delete o; });
+        unsigned   j = k - INLINE_CHUNKS;
+        unsigned   d = 0;
+        while (j >= (INLINE_CHUNKS << d)) j -= INLINE_CHUNKS << d++;
+        unsigned   n   = INLINE_CHUNKS << d;
+        ChunkPtr * dir = get_or_create(
+            O->dirs[d],
+            [n] {
+              ChunkPtr * D = new ChunkPtr[n];
+              for (unsigned i = 0; i < n; ++i) D[i].store(nullptr, std::memory_order_relaxed);
+              return D;
+            },
+            [](ChunkPtr * D) { delete[] D; });
+        return dir[j];
       }
 
-      ThreadLocalData & operator=(const ThreadLocalData & other) {
-        std::lock_guard<std::mutex> l1(m_data_mutex);
-        std::lock_guard<std::mutex> l2(other.m_data_mutex);
-        m_data = other.m_data;
+      Entry * chunk(unsigned k) const {
+        return get_or_create(chunk_ptr(k), [] { return new Entry[CHUNK_SIZE]; }, [](Entry * c) { delete[] c; });
+      }
+
+      void clear() noexcept {
+        for (auto & c : m_chunks) delete[] c.exchange(nullptr, std::memory_order_acq_rel);
+        delete m_overflow.exchange(nullptr, std::memory_order_acq_rel);
+      }
+
+     public:
+      ThreadLocalData() noexcept {
+        for (auto & c : m_chunks) c.store(nullptr, std::memory_order_relaxed);
+        m_overflow.store(nullptr, std::memory_order_relaxed);
+      }
+
+      ThreadLocalData(ThreadLocalData<Data> const &) noexcept : ThreadLocalData() {}
+
+      ThreadLocalData(ThreadLocalData<Data> && other) noexcept : ThreadLocalData() { *this = std::move(other); }
+
+      ~ThreadLocalData() { clear(); }
+
+      ThreadLocalData & operator=(ThreadLocalData const & other) noexcept {
+        if (this != &other) clear();
         return *this;
       }
 
-      ThreadLocalData & operator=(ThreadLocalData && other) {
-        std::lock_guard<std::mutex> l1(m_data_mutex);
-        std::lock_guard<std::mutex> l2(other.m_data_mutex);
-        m_data = other.m_data;
+      ThreadLocalData & operator=(ThreadLocalData && other) noexcept {
+        if (this != &other) {
+          clear();
+          for (unsigned k = 0; k < INLINE_CHUNKS; ++k)
+            m_chunks[k].store(
+                other.m_chunks[k].exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+          m_overflow.store(other.m_overflow.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+        }
         return *this;
       }
 
-      DataPtr search(const std::thread::id & id) {
-        std::lock_guard<std::mutex> l(m_data_mutex);
-        auto                        el = m_data.find(id);
-        if (el == m_data.end()) {
-          auto data_ptr = std::make_shared<Data>(Data());
-          m_data[id]    = data_ptr;
-          return data_ptr;
-        } else {
-          return el->second;
+      //!
+      //! Data of the calling thread
+      //!
+      Data & get() const {
+        ThreadSlot const & S = ThreadSlot::current();
+        Entry &            E = chunk(S.slot() / CHUNK_SIZE)[S.slot() % CHUNK_SIZE];
+        if (E.epoch != S.epoch()) {
+          // first use by this thread, the slot may have been used by an exited thread
+          E.epoch = S.epoch();
+          E.data  = Data();
         }
+        return E.data;
+      }
+
+      //!
+      //! Data of the calling thread, kept with the signature of the former
+      //! map-based storage. `id` must be the id of the calling thread: the
+      //! data of other threads are not reachable. The returned pointer does
+      //! not own the data, which live as long as the object.
+      //!
+      [[deprecated("use get(), the data of the calling thread")]]
+      DataPtr search(std::thread::id const & id) const {
+        (void) id;
+        return DataPtr(DataPtr(), &get());
       }
     };
   }  // namespace Utils
-}  // namespace G2lib
\ No newline at end of file
+}  // namespace G2lib
+
+///
+/// eof: ThreadLocalData.hxx
+///
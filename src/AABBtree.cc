@@ -27,6 +27,7 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #include "Clothoids/AABBtree.hxx"
 #include "Utils.hxx"
+#include "SIMD.hxx"
 
 // Workaround for Visual Studio
 #ifdef min
@@ -38,6 +39,12 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <new>
+#include <queue>
+#include <thread>
+#include <type_traits>
 
 namespace G2lib {
 
@@ -163,6 +170,103 @@ namespace G2lib {
     return !((box.x_min() > x_max()) || (box.x_max() < x_min()) || (box.y_min() > y_max()) || (box.y_max() < y_min()));
   }
 
+  /*\
+   |   ____  ____             ____             _
+   |  | __ )| __ )  _____  __|  _ \ ___   ___ | |
+   |  |  _ \|  _ \ / _ \ \/ /| |_) / _ \ / _ \| |
+   |  | |_) | |_) | (_) >  < |  __/ (_) | (_) | |
+   |  |____/|____/ \___/_/\_\|_|   \___/ \___/|_|
+  \*/
+
+  // the boxes are never destroyed one by one, the block is just released
+  static_assert(std::is_trivially_destructible<BBox>::value, "BBoxPool requires a trivially destructible BBox");
+
+  class BBoxPool::Block {
+   public:
+    BBox *   m_data;
+    int_type m_size{0};
+    int_type m_capacity;
+
+    explicit Block(int_type n)
+        : m_data(static_cast<BBox *>(::operator new(sizeof(BBox) * size_t(n)))), m_capacity(n) {}
+
+    Block(Block const &)             = delete;
+    Block & operator=(Block const &) = delete;
+
+    ~Block() { ::operator delete(m_data); }
+  };
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BBoxPool::add_block(int_type n) {
+    m_blocks.push_back(make_shared<Block>(n));
+    m_first.push_back(m_capacity);
+    m_capacity += n;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  size_t BBoxPool::block_of(int_type i) const {
+    G2LIB_UTILS_ASSERT(i >= 0 && i < m_size, "BBoxPool, index %d out of range [0,%d)\n", i, m_size);
+    return size_t(std::upper_bound(m_first.begin(), m_first.end(), i) - m_first.begin()) - 1;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BBoxPool::reserve(int_type n) {
+    if (n > m_capacity)
+      add_block(n - m_capacity);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BBoxPool::clear() {
+    m_blocks.clear();
+    m_first.clear();
+    m_size     = 0;
+    m_capacity = 0;
+    m_current  = 0;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  int_type BBoxPool::add(
+      real_type xmin, real_type ymin, real_type xmax, real_type ymax, int_type id, int_type ipos) {
+    // blocks are filled in order, a full pool doubles
+    while (m_current < m_blocks.size() && m_blocks[m_current]->m_size == m_blocks[m_current]->m_capacity)
+      ++m_current;
+    if (m_current == m_blocks.size())
+      add_block(max(m_capacity, int_type(64)));
+    Block & B = *m_blocks[m_current];
+    new (B.m_data + B.m_size) BBox(xmin, ymin, xmax, ymax, id, ipos);
+    ++B.m_size;
+    return m_size++;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  BBox const & BBoxPool::operator[](int_type i) const {
+    size_t b = block_of(i);
+    return m_blocks[b]->m_data[i - m_first[b]];
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  BBoxPool::PtrBBox BBoxPool::get(int_type i) const {
+    size_t b = block_of(i);
+    return PtrBBox(m_blocks[b], m_blocks[b]->m_data + (i - m_first[b]));
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BBoxPool::get_all(vector<PtrBBox> & bboxes) const {
+    bboxes.clear();
+    bboxes.reserve(size_t(m_size));
+    for (shared_ptr<Block> const & B : m_blocks)
+      for (int_type k = 0; k < B->m_size; ++k)
+        bboxes.emplace_back(B, B->m_data + k);
+  }
+
   /*\
    |      _        _    ____  ____  _
    |     / \      / \  | __ )| __ )| |_ _ __ ___  ___
@@ -171,22 +275,331 @@ namespace G2lib {
    |  /_/   \_\/_/   \_\____/|____/ \__|_|  \___|\___|
   \*/
 
-  AABBtree::AABBtree() {
-    pBBox.reset();
-    children.clear();
+  // distance of the point (x,y) from the box, zero inside
+  static inline real_type bbox_distance(
+      real_type x, real_type y, real_type xmin, real_type ymin, real_type xmax, real_type ymax) {
+    real_type dx = max(max(xmin - x, x - xmax), real_type(0));
+    real_type dy = max(max(ymin - y, y - ymax), real_type(0));
+    return hypot(dx, dy);
   }
 
-  AABBtree::~AABBtree() {
-    pBBox.reset();
-    children.clear();
+  // maximum distance of the point (x,y) from the points of the box
+  static inline real_type bbox_max_distance(
+      real_type x, real_type y, real_type xmin, real_type ymin, real_type xmax, real_type ymax) {
+    real_type dx = max(abs(x - xmin), abs(x - xmax));
+    real_type dy = max(abs(y - ymin), abs(y - ymax));
+    return hypot(dx, dy);
   }
 
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  AABBtree::AABBtree() {}
+
+  AABBtree::~AABBtree() {}
+
   void AABBtree::clear() {
-    pBBox.reset();
-    children.clear();
+    m_nodes.clear();
+    m_node_bounds.clear();
+    m_prims.clear();
+    m_prim_bounds.clear();
+    m_wide_bounds.clear();
+    m_wide_child.clear();
+    m_node_lane.clear();
+    m_parent.clear();
+    m_prim_leaf.clear();
+    m_prim_handle.clear();
+    m_handle_pos.clear();
+    m_free_pairs.clear();
+    m_free_prims.clear();
+    m_free_handles.clear();
   }
 
-  bool AABBtree::empty() const { return children.empty() && !pBBox; }
+  bool AABBtree::empty() const { return m_nodes.empty(); }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  AABBtreeStrategy AABBtree_default_strategy = AABBtreeStrategy::Midpoint;
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // The tree is first built in a temporary layout where the descendants of
+  // a node covering n boxes use a fixed block of 2n-2 slots. Subtrees do not
+  // share memory and can be built concurrently, the result is independent
+  // of the scheduling. The layout is then compacted in the tree.
+  //
+  class AABBtree::Builder {
+    static constexpr int_type n_bins = 16;  // bins of the SAH
+
+    AABBtreeStrategy  m_strategy;
+    int_type          m_spawn_depth;
+    Bounds            m_box;       // bounds of the boxes, input order
+    vector<real_type> m_cx, m_cy;  // doubled centroids, input order
+    vector<int_type>  m_perm;
+    vector<Node>      m_nodes;   // temporary layout, 2n-1 slots
+    Bounds            m_bounds;  // bounds of the nodes in the temporary layout
+
+    // box[4] bounds of the boxes [b,e), cbox[4] bounds of their centroids
+    void range_bounds(int_type b, int_type e, real_type box[4], real_type cbox[4]) const {
+      box[0] = box[1] = cbox[0] = cbox[1] = numeric_limits<real_type>::infinity();
+      box[2] = box[3] = cbox[2] = cbox[3] = -numeric_limits<real_type>::infinity();
+      for (int_type k = b; k < e; ++k) {
+        size_t i = size_t(m_perm[size_t(k)]);
+        box[0]   = min(box[0], m_box.xmin[i]);
+        box[1]   = min(box[1], m_box.ymin[i]);
+        box[2]   = max(box[2], m_box.xmax[i]);
+        box[3]   = max(box[3], m_box.ymax[i]);
+        cbox[0]  = min(cbox[0], m_cx[i]);
+        cbox[1]  = min(cbox[1], m_cy[i]);
+        cbox[2]  = max(cbox[2], m_cx[i]);
+        cbox[3]  = max(cbox[3], m_cy[i]);
+      }
+    }
+
+    vector<real_type> const & centroid(int_type axis) const { return axis == 0 ? m_cx : m_cy; }
+
+    int_type split_median(int_type b, int_type e, int_type axis) {
+      vector<real_type> const & c  = centroid(axis);
+      int_type *                pb = m_perm.data() + b;
+      int_type *                pe = m_perm.data() + e;
+      int_type *                pm = pb + (e - b) / 2;
+      std::nth_element(pb, pm, pe, [&c](int_type i, int_type j) { return c[size_t(i)] < c[size_t(j)]; });
+      return b + (e - b) / 2;
+    }
+
+    int_type split_midpoint(int_type b, int_type e, real_type const box[4]) {
+      int_type                  axis = (box[3] - box[1]) > (box[2] - box[0]) ? 1 : 0;
+      real_type                 cut  = box[axis] + box[axis + 2];
+      vector<real_type> const & c    = centroid(axis);
+      int_type *                pb   = m_perm.data() + b;
+      int_type *                pe   = m_perm.data() + e;
+      int_type * pm = std::partition(pb, pe, [&c, cut](int_type i) { return c[size_t(i)] <= cut; });
+      if (pm == pb || pm == pe)
+        return split_median(b, e, axis);  // all the centroids on one side
+      return b + int_type(pm - pb);
+    }
+
+    int_type split_sah(int_type b, int_type e, real_type const cbox[4]) {
+      struct Bin {
+        int_type  count;
+        real_type box[4];
+      };
+      auto grow = [](real_type box[4], real_type const other[4]) {
+        box[0] = min(box[0], other[0]);
+        box[1] = min(box[1], other[1]);
+        box[2] = max(box[2], other[2]);
+        box[3] = max(box[3], other[3]);
+      };
+      // half perimeter, the 2D surface area
+      auto area = [](real_type const box[4]) { return (box[2] - box[0]) + (box[3] - box[1]); };
+
+      real_type const inf        = numeric_limits<real_type>::infinity();
+      real_type       best_cost  = inf;
+      int_type        best_axis  = -1;
+      int_type        best_split = 0;
+      for (int_type axis = 0; axis < 2; ++axis) {
+        real_type cmin = cbox[axis];
+        real_type ext  = cbox[axis + 2] - cmin;
+        if (!(ext > 0))
+          continue;
+        real_type                 scale = n_bins / ext;
+        vector<real_type> const & c     = centroid(axis);
+
+        Bin bins[n_bins];
+        for (Bin & B : bins) {
+          B.count  = 0;
+          B.box[0] = B.box[1] = inf;
+          B.box[2] = B.box[3] = -inf;
+        }
+        for (int_type k = b; k < e; ++k) {
+          size_t    i     = size_t(m_perm[size_t(k)]);
+          int_type  ib    = min(n_bins - 1, int_type((c[i] - cmin) * scale));
+          real_type bb[4] = {m_box.xmin[i], m_box.ymin[i], m_box.xmax[i], m_box.ymax[i]};
+          ++bins[ib].count;
+          grow(bins[ib].box, bb);
+        }
+
+        // right sweep: cost of the boxes in the bins j..n_bins-1
+        real_type right_cost[n_bins];
+        real_type acc[4]  = {inf, inf, -inf, -inf};
+        int_type  n_right = 0;
+        for (int_type j = n_bins - 1; j > 0; --j) {
+          n_right += bins[j].count;
+          if (bins[j].count > 0)
+            grow(acc, bins[j].box);
+          right_cost[j] = n_right > 0 ? area(acc) * n_right : 0;
+        }
+        // left sweep, the cut is between the bins j and j+1
+        real_type left[4] = {inf, inf, -inf, -inf};
+        int_type  n_left  = 0;
+        for (int_type j = 0; j < n_bins - 1; ++j) {
+          n_left += bins[j].count;
+          if (bins[j].count > 0)
+            grow(left, bins[j].box);
+          if (n_left == 0 || n_left == e - b)
+            continue;
+          real_type cost = area(left) * n_left + right_cost[j + 1];
+          if (cost < best_cost) {
+            best_cost  = cost;
+            best_axis  = axis;
+            best_split = j;
+          }
+        }
+      }
+      if (best_axis < 0)
+        return b + (e - b) / 2;  // all the centroids coincide, any cut is fine
+
+      vector<real_type> const & c     = centroid(best_axis);
+      real_type                 cmin  = cbox[best_axis];
+      real_type                 scale = n_bins / (cbox[best_axis + 2] - cmin);
+      int_type *                pb    = m_perm.data() + b;
+      int_type *                pe    = m_perm.data() + e;
+      int_type *                pm    = std::partition(pb, pe, [&](int_type i) {
+        return min(n_bins - 1, int_type((c[size_t(i)] - cmin) * scale)) <= best_split;
+      });
+      return b + int_type(pm - pb);
+    }
+
+    // set the node inode covering [b,e), return the split point or -1 for a leaf
+    int_type process(int_type inode, int_type desc, int_type b, int_type e) {
+      real_type box[4], cbox[4];
+      range_bounds(b, e, box, cbox);
+      size_t k         = size_t(inode);
+      m_bounds.xmin[k] = box[0];
+      m_bounds.ymin[k] = box[1];
+      m_bounds.xmax[k] = box[2];
+      m_bounds.ymax[k] = box[3];
+      m_nodes[k]       = Node{-1, b, e};
+      if (e - b <= max_leaf_size)
+        return -1;
+
+      int_type mid = b;
+      switch (m_strategy) {
+        case AABBtreeStrategy::Median:
+          mid = split_median(b, e, (cbox[3] - cbox[1]) > (cbox[2] - cbox[0]) ? 1 : 0);
+          break;
+        case AABBtreeStrategy::SAH:
+          mid = split_sah(b, e, cbox);
+          break;
+        default:
+          mid = split_midpoint(b, e, box);
+          break;
+      }
+      m_nodes[k].child = desc;
+      return mid;
+    }
+
+    void build_serial(int_type inode, int_type desc, int_type b, int_type e) {
+      struct Task {
+        int_type inode, desc, b, e;
+      };
+      vector<Task> todo;
+      todo.push_back(Task{inode, desc, b, e});
+      while (!todo.empty()) {
+        Task T = todo.back();
+        todo.pop_back();
+        int_type mid = process(T.inode, T.desc, T.b, T.e);
+        if (mid < 0)
+          continue;
+        // the left subtree uses 2*(mid-b)-2 slots after the two children
+        todo.push_back(Task{T.desc + 1, T.desc + 2 * (mid - T.b), mid, T.e});
+        todo.push_back(Task{T.desc, T.desc + 2, T.b, mid});
+      }
+    }
+
+    void build_parallel(int_type inode, int_type desc, int_type b, int_type e, int_type depth) {
+      if (depth <= 0 || e - b < parallel_build_size) {
+        build_serial(inode, desc, b, e);
+        return;
+      }
+      int_type mid = process(inode, desc, b, e);
+      if (mid < 0)
+        return;
+      std::future<void> left = std::async(std::launch::async, [this, desc, b, mid, depth] {
+        build_parallel(desc, desc + 2, b, mid, depth - 1);
+      });
+      build_parallel(desc + 1, desc + 2 * (mid - b), mid, e, depth - 1);
+      left.get();
+    }
+
+   public:
+    Builder(vector<PtrBBox> const & bboxes, AABBtreeStrategy strategy) {
+      m_strategy = strategy == AABBtreeStrategy::Default ? AABBtree_default_strategy : strategy;
+
+      // fork while there are idle cores
+      m_spawn_depth = 0;
+      for (unsigned nt = std::thread::hardware_concurrency(); (1u << m_spawn_depth) < nt; ++m_spawn_depth) {}
+
+      size_t n = bboxes.size();
+      m_box.resize(n);
+      m_cx.resize(n);
+      m_cy.resize(n);
+      m_perm.resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        BBox const & B = *bboxes[i];
+        m_box.xmin[i]  = B.x_min();
+        m_box.ymin[i]  = B.y_min();
+        m_box.xmax[i]  = B.x_max();
+        m_box.ymax[i]  = B.y_max();
+        m_cx[i]        = B.x_min() + B.x_max();
+        m_cy[i]        = B.y_min() + B.y_max();
+        m_perm[i]      = int_type(i);
+      }
+      m_nodes.resize(2 * n - 1);
+      m_bounds.resize(2 * n - 1);
+    }
+
+    void run() { build_parallel(0, 1, 0, int_type(m_perm.size()), m_spawn_depth); }
+
+    void store(vector<PtrBBox> const & bboxes, AABBtree & tree) const {
+      // compact the used slots, the two children stay adjacent
+      size_t n = m_perm.size();
+      tree.m_nodes.reserve(m_nodes.size());
+      tree.m_nodes.resize(1);
+      tree.m_node_bounds.resize(1);
+      tree.m_parent.reserve(m_nodes.size());
+      tree.m_parent.assign(1, -1);
+      tree.m_prim_leaf.resize(n);
+      vector<pair<int_type, int_type>> stack;
+      stack.emplace_back(0, 0);
+      while (!stack.empty()) {
+        auto [t, f] = stack.back();
+        stack.pop_back();
+        Node N = m_nodes[size_t(t)];
+        tree.m_node_bounds.xmin[size_t(f)] = m_bounds.xmin[size_t(t)];
+        tree.m_node_bounds.ymin[size_t(f)] = m_bounds.ymin[size_t(t)];
+        tree.m_node_bounds.xmax[size_t(f)] = m_bounds.xmax[size_t(t)];
+        tree.m_node_bounds.ymax[size_t(f)] = m_bounds.ymax[size_t(t)];
+        if (N.child >= 0) {
+          int_type fc = int_type(tree.m_nodes.size());
+          tree.m_nodes.resize(size_t(fc + 2));
+          tree.m_node_bounds.resize(size_t(fc + 2));
+          tree.m_parent.resize(size_t(fc + 2), f);
+          stack.emplace_back(N.child + 1, fc + 1);
+          stack.emplace_back(N.child, fc);
+          N.child = fc;
+        } else {
+          std::fill(tree.m_prim_leaf.begin() + N.begin, tree.m_prim_leaf.begin() + N.end, f);
+        }
+        tree.m_nodes[size_t(f)] = N;
+      }
+
+      // store the boxes in leaf order, the handle is the input position
+      tree.m_prims.resize(n);
+      tree.m_prim_bounds.resize(n);
+      tree.m_prim_handle.assign(m_perm.begin(), m_perm.end());
+      tree.m_handle_pos.resize(n);
+      for (size_t k = 0; k < n; ++k) {
+        size_t i                   = size_t(m_perm[k]);
+        tree.m_handle_pos[i]       = int_type(k);
+        tree.m_prims[k]            = bboxes[i];
+        tree.m_prim_bounds.xmin[k] = m_box.xmin[i];
+        tree.m_prim_bounds.ymin[k] = m_box.ymin[i];
+        tree.m_prim_bounds.xmax[k] = m_box.xmax[i];
+        tree.m_prim_bounds.ymax[k] = m_box.ymax[i];
+      }
+    }
+  };
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
@@ -196,167 +609,1144 @@ namespace G2lib {
     if (bboxes.empty())
       return;
 
-    size_t size = bboxes.size();
+    Builder B(bboxes, m_strategy);
+    B.run();
+    B.store(bboxes, *this);
+    build_wide();
+  }
 
-    if (size == 1) {
-      this->pBBox = bboxes.front();
-      return;
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::build(BBoxPool const & pool) {
+    vector<PtrBBox> bboxes;
+    pool.get_all(bboxes);
+    build(bboxes);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // lanes of a wide node, one register of boxes
+  static constexpr int_type wide_arity = Simd::width > 4 ? Simd::width : 4;
+
+  // child of the empty lanes, no reference takes it (`-1` is the root node)
+  static constexpr int_type empty_lane = numeric_limits<int_type>::min();
+
+  // bit i set if the lane i of the wide node W overlaps the box
+  static inline unsigned wide_overlap(
+      real_type const * W, real_type xmin, real_type ymin, real_type xmax, real_type ymax) {
+#if G2LIB_SIMD_WIDTH > 1
+    using namespace Simd;
+    vmask m = (load(W) <= vreal(xmax)) & (load(W + wide_arity) <= vreal(ymax)) &
+              (load(W + 2 * wide_arity) >= vreal(xmin)) & (load(W + 3 * wide_arity) >= vreal(ymin));
+    return bits(m);
+#else
+    unsigned m = 0;
+    for (int_type i = 0; i < wide_arity; ++i)
+      if (W[i] <= xmax && W[i + wide_arity] <= ymax && W[i + 2 * wide_arity] >= xmin && W[i + 3 * wide_arity] >= ymin)
+        m |= 1u << i;
+    return m;
+#endif
+  }
+
+  // squared distance of the point (x,y) from the lanes of the wide node W
+  static inline void wide_distance2(real_type const * W, real_type x, real_type y, real_type d2[]) {
+#if G2LIB_SIMD_WIDTH > 1
+    using namespace Simd;
+    // outside the box at most one of the two differences is positive
+    vreal X(x), Y(y), zero(0.0);
+    vreal ax = load(W) - X, bx = X - load(W + 2 * wide_arity);
+    vreal ay = load(W + wide_arity) - Y, by = Y - load(W + 3 * wide_arity);
+    vreal dx = select(ax > zero, ax, select(bx > zero, bx, zero));
+    vreal dy = select(ay > zero, ay, select(by > zero, by, zero));
+    store(d2, fma(dx, dx, dy * dy));
+#else
+    for (int_type i = 0; i < wide_arity; ++i) {
+      real_type dx = max(max(W[i] - x, x - W[i + 2 * wide_arity]), real_type(0));
+      real_type dy = max(max(W[i + wide_arity] - y, y - W[i + 3 * wide_arity]), real_type(0));
+      d2[i]        = dx * dx + dy * dy;
     }
+#endif
+  }
 
-    pBBox = shared_ptr<BBox>(new BBox(bboxes, 0, 0));
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::build_wide() {
+    drop_wide();
+    if (m_nodes.empty() || m_nodes[0].child < 0)
+      return;
 
-    real_type xmin = pBBox->Xmin();
-    real_type ymin = pBBox->Ymin();
-    real_type xmax = pBBox->Xmax();
-    real_type ymax = pBBox->Ymax();
+    real_type const inf = numeric_limits<real_type>::infinity();
+    auto            area = [this](int_type k) {
+      size_t kk = size_t(k);
+      return (m_node_bounds.xmax[kk] - m_node_bounds.xmin[kk]) + (m_node_bounds.ymax[kk] - m_node_bounds.ymin[kk]);
+    };
 
-    vector<PtrBBox> posBoxes;
-    vector<PtrBBox> negBoxes;
+    // (binary node, wide node) to be collapsed
+    vector<pair<int_type, int_type>> todo;
+    todo.emplace_back(0, 0);
+    // at most one wide node for each internal binary node
+    size_t n_internal = m_nodes.size() / 2;
+    m_wide_bounds.reserve(n_internal * size_t(4 * wide_arity));
+    m_wide_child.reserve(n_internal * size_t(wide_arity));
+    m_wide_bounds.resize(size_t(4 * wide_arity));
+    m_wide_child.resize(size_t(wide_arity));
+    m_node_lane.assign(m_nodes.size(), -1);
+    while (!todo.empty()) {
+      auto [inode, iwide] = todo.back();
+      todo.pop_back();
 
-    if ((ymax - ymin) > (xmax - xmin)) {
-      real_type                       cutPos = (ymax + ymin) / 2;
-      vector<PtrBBox>::const_iterator it;
-      for (it = bboxes.begin(); it != bboxes.end(); ++it) {
-        real_type ymid = ((*it)->Ymin() + (*it)->Ymax()) / 2;
-        if (ymid > cutPos)
-          posBoxes.push_back(*it);
-        else
-          negBoxes.push_back(*it);
+      // open the largest internal node until the lanes are full
+      int_type kids[wide_arity];
+      int_type nk = 2;
+      kids[0]     = m_nodes[size_t(inode)].child;
+      kids[1]     = kids[0] + 1;
+      while (nk < wide_arity) {
+        int_type  best = -1;
+        real_type amax = -inf;
+        for (int_type i = 0; i < nk; ++i) {
+          if (m_nodes[size_t(kids[i])].child >= 0 && area(kids[i]) > amax) {
+            amax = area(kids[i]);
+            best = i;
+          }
+        }
+        if (best < 0)
+          break;
+        int_type c = m_nodes[size_t(kids[best])].child;
+        kids[best] = c;
+        kids[nk++] = c + 1;
       }
-    } else {
-      real_type                       cutPos = (xmax + xmin) / 2;
-      vector<PtrBBox>::const_iterator it;
-      for (it = bboxes.begin(); it != bboxes.end(); ++it) {
-        real_type xmid = ((*it)->Xmin() + (*it)->Xmax()) / 2;
-        if (xmid > cutPos)
-          posBoxes.push_back(*it);
-        else
-          negBoxes.push_back(*it);
+
+      real_type * W  = m_wide_bounds.data() + 4 * wide_arity * iwide;
+      int_type *  WC = m_wide_child.data() + wide_arity * iwide;
+      for (int_type i = 0; i < wide_arity; ++i) {
+        if (i < nk) {
+          size_t k              = size_t(kids[i]);
+          m_node_lane[k]        = wide_arity * iwide + i;
+          W[i]                  = m_node_bounds.xmin[k];
+          W[i + wide_arity]     = m_node_bounds.ymin[k];
+          W[i + 2 * wide_arity] = m_node_bounds.xmax[k];
+          W[i + 3 * wide_arity] = m_node_bounds.ymax[k];
+          if (m_nodes[k].child < 0) {
+            WC[i] = -1 - kids[i];
+          } else {
+            int_type jwide = int_type(m_wide_child.size()) / wide_arity;
+            m_wide_bounds.resize(m_wide_bounds.size() + size_t(4 * wide_arity));
+            m_wide_child.resize(m_wide_child.size() + size_t(wide_arity));
+            W     = m_wide_bounds.data() + 4 * wide_arity * iwide;  // may be reallocated
+            WC    = m_wide_child.data() + wide_arity * iwide;
+            WC[i] = jwide;
+            todo.emplace_back(kids[i], jwide);
+          }
+        } else {
+          // empty lane, never overlaps and is infinitely far
+          W[i]                  = inf;
+          W[i + wide_arity]     = inf;
+          W[i + 2 * wide_arity] = -inf;
+          W[i + 3 * wide_arity] = -inf;
+          WC[i]                 = empty_lane;
+        }
       }
     }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::drop_wide() {
+    m_wide_bounds.clear();
+    m_wide_child.clear();
+    m_node_lane.clear();
+  }
 
-    if (negBoxes.empty()) {
-      vector<PtrBBox>::iterator midIdx;
-      midIdx = posBoxes.begin() + posBoxes.size() / 2;
-      negBoxes.insert(negBoxes.end(), midIdx, posBoxes.end());
-      posBoxes.erase(midIdx, posBoxes.end());
-    } else if (posBoxes.empty()) {
-      vector<PtrBBox>::iterator midIdx;
-      midIdx = negBoxes.begin() + negBoxes.size() / 2;
-      posBoxes.insert(posBoxes.end(), midIdx, negBoxes.end());
-      negBoxes.erase(midIdx, negBoxes.end());
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::node_lanes(
+      int_type ref, real_type const *& W, int_type const *& WC, real_type * Wbuf, int_type * WCbuf) const {
+    if (ref >= 0) {
+      W  = m_wide_bounds.data() + 4 * wide_arity * ref;
+      WC = m_wide_child.data() + wide_arity * ref;
+      return;
     }
+    real_type const inf   = numeric_limits<real_type>::infinity();
+    int_type        child = m_nodes[size_t(-1 - ref)].child;
+    for (int_type i = 0; i < wide_arity; ++i) {
+      if (i < 2) {
+        size_t k                 = size_t(child + i);
+        Wbuf[i]                  = m_node_bounds.xmin[k];
+        Wbuf[i + wide_arity]     = m_node_bounds.ymin[k];
+        Wbuf[i + 2 * wide_arity] = m_node_bounds.xmax[k];
+        Wbuf[i + 3 * wide_arity] = m_node_bounds.ymax[k];
+        WCbuf[i]                 = -1 - (child + i);
+      } else {
+        Wbuf[i] = Wbuf[i + wide_arity] = inf;
+        Wbuf[i + 2 * wide_arity] = Wbuf[i + 3 * wide_arity] = -inf;
+        WCbuf[i]                                             = empty_lane;
+      }
+    }
+    W  = Wbuf;
+    WC = WCbuf;
+  }
+
+  /*\
+   |      _                             _
+   |   __| |_   _ _ __   __ _ _ __ ___ (_) ___
+   |  / _` | | | | '_ \ / _` | '_ ` _ \| |/ __|
+   | | (_| | |_| | | | | (_| | | | | | | | (__
+   |  \__,_|\__, |_| |_|\__,_|_| |_| |_|_|\___|
+   |        |___/
+  \*/
 
-    PtrAABB neg = make_shared<AABBtree>();
-    PtrAABB pos = make_shared<AABBtree>();
+  // half perimeter, the 2D surface area
+  static inline real_type bbox_area(real_type xmin, real_type ymin, real_type xmax, real_type ymax) {
+    return (xmax - xmin) + (ymax - ymin);
+  }
 
-    neg->build(negBoxes);
-    if (!neg->empty())
-      children.push_back(neg);
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-    pos->build(posBoxes);
-    if (!pos->empty())
-      children.push_back(pos);
+  int_type AABBtree::alloc_pair() {
+    if (!m_free_pairs.empty()) {
+      int_type p = m_free_pairs.back();
+      m_free_pairs.pop_back();
+      return p;
+    }
+    int_type p = int_type(m_nodes.size());
+    m_nodes.resize(size_t(p + 2));
+    m_node_bounds.resize(size_t(p + 2));
+    m_parent.resize(size_t(p + 2));
+    return p;
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::print(ostream_type & stream, int level) const {
-    if (empty()) {
-      stream << "[EMPTY AABB tree]\n";
+  // point the children (or the primitives) of the node to its slot
+  void AABBtree::relink(int_type inode) {
+    Node const & N = m_nodes[size_t(inode)];
+    if (N.child >= 0) {
+      m_parent[size_t(N.child)]     = inode;
+      m_parent[size_t(N.child + 1)] = inode;
     } else {
-      stream << Utils::format_string("BBOX xmin=%-12.4f ymin=%-12.4f xmax=%-12.4f ymax=%-12.4f\n", 
-        pBBox->x_min(), pBBox->y_min(), pBBox->x_max(), pBBox->y_max());
-      vector<PtrAABB>::const_iterator it;
-      for (it = children.begin(); it != children.end(); ++it)
-        (*it)->print(stream, level + 1);
+      std::fill(m_prim_leaf.begin() + N.begin, m_prim_leaf.begin() + N.end, inode);
     }
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::intersect(AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree) const {
-    // check bbox with
-    if (!tree.pBBox->collision(*pBBox))
+  // copy the node in another slot, the slot keeps its parent
+  void AABBtree::move_node(int_type from, int_type to) {
+    size_t f              = size_t(from);
+    size_t t              = size_t(to);
+    m_nodes[t]            = m_nodes[f];
+    m_node_bounds.xmin[t] = m_node_bounds.xmin[f];
+    m_node_bounds.ymin[t] = m_node_bounds.ymin[f];
+    m_node_bounds.xmax[t] = m_node_bounds.xmax[f];
+    m_node_bounds.ymax[t] = m_node_bounds.ymax[f];
+    relink(to);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::set_prim(int_type pos, PtrBBox const & box) {
+    size_t p              = size_t(pos);
+    m_prims[p]            = box;
+    m_prim_bounds.xmin[p] = box->x_min();
+    m_prim_bounds.ymin[p] = box->y_min();
+    m_prim_bounds.xmax[p] = box->x_max();
+    m_prim_bounds.ymax[p] = box->y_max();
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // exchange two subtrees, the slots keep their parents
+  void AABBtree::swap_nodes(int_type i, int_type j) {
+    size_t ii = size_t(i), jj = size_t(j);
+    std::swap(m_nodes[ii], m_nodes[jj]);
+    std::swap(m_node_bounds.xmin[ii], m_node_bounds.xmin[jj]);
+    std::swap(m_node_bounds.ymin[ii], m_node_bounds.ymin[jj]);
+    std::swap(m_node_bounds.xmax[ii], m_node_bounds.xmax[jj]);
+    std::swap(m_node_bounds.ymax[ii], m_node_bounds.ymax[jj]);
+    relink(i);
+    relink(j);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // recompute the bounds of the node from its children or primitives
+  void AABBtree::fit_node(int_type inode) {
+    Node const &   N  = m_nodes[size_t(inode)];
+    Bounds const & B  = N.child >= 0 ? m_node_bounds : m_prim_bounds;
+    size_t         b  = size_t(N.child >= 0 ? N.child : N.begin);
+    size_t         e  = N.child >= 0 ? b + 2 : size_t(N.end);
+    size_t         k  = size_t(inode);
+    real_type      x0 = numeric_limits<real_type>::infinity();
+    real_type      y0 = x0, x1 = -x0, y1 = -x0;
+    for (size_t i = b; i < e; ++i) {
+      x0 = min(x0, B.xmin[i]);
+      y0 = min(y0, B.ymin[i]);
+      x1 = max(x1, B.xmax[i]);
+      y1 = max(y1, B.ymax[i]);
+    }
+    m_node_bounds.xmin[k] = x0;
+    m_node_bounds.ymin[k] = y0;
+    m_node_bounds.xmax[k] = x1;
+    m_node_bounds.ymax[k] = y1;
+    if (k < m_node_lane.size() && m_node_lane[k] >= 0) {
+      // keep the lane of the wide layer in sync
+      int_type    lane      = m_node_lane[k];
+      int_type    i         = lane % wide_arity;
+      real_type * W         = m_wide_bounds.data() + 4 * wide_arity * (lane / wide_arity);
+      W[i]                  = x0;
+      W[i + wide_arity]     = y0;
+      W[i + 2 * wide_arity] = x1;
+      W[i + 3 * wide_arity] = y1;
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // Tree rotation: swap a child of the node with a grandchild under the
+  // other child when it reduces the area of that child. The bounds of the
+  // node do not change.
+  //
+  void AABBtree::rotate_node(int_type inode) {
+    int_type c = m_nodes[size_t(inode)].child;
+    if (c < 0)
       return;
+    Bounds const & NB   = m_node_bounds;
+    auto           area = [&NB](int_type k) {
+      size_t kk = size_t(k);
+      return bbox_area(NB.xmin[kk], NB.ymin[kk], NB.xmax[kk], NB.ymax[kk]);
+    };
+    auto join_area = [&NB](int_type i, int_type j) {
+      size_t ii = size_t(i), jj = size_t(j);
+      return bbox_area(
+          min(NB.xmin[ii], NB.xmin[jj]), min(NB.ymin[ii], NB.ymin[jj]), max(NB.xmax[ii], NB.xmax[jj]),
+          max(NB.ymax[ii], NB.ymax[jj]));
+    };
+    real_type best_gain = 0;
+    int_type  best_a = -1, best_b = -1, best_up = -1;
+    for (int_type side = 0; side < 2; ++side) {
+      int_type a  = c + side;      // child moved down
+      int_type up = c + 1 - side;  // child receiving it
+      int_type g  = m_nodes[size_t(up)].child;
+      if (g < 0)
+        continue;
+      for (int_type k = 0; k < 2; ++k) {
+        // `a` takes the place of the grandchild g+k, next to g+1-k
+        real_type gain = area(up) - join_area(a, g + 1 - k);
+        if (gain > best_gain) {
+          best_gain = gain;
+          best_a    = a;
+          best_b    = g + k;
+          best_up   = up;
+        }
+      }
+    }
+    if (best_a < 0)
+      return;
+    swap_nodes(best_a, best_b);
+    fit_node(best_up);
+  }
 
-    int icase = (children.empty() ? 0 : 1) + (tree.children.empty() ? 0 : 2);
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-    switch (icase) {
-      case 0:  // both leaf
-        if (swap_tree)
-          intersectionList.push_back(PairPtrBBox(tree.pBBox, pBBox));
-        else
-          intersectionList.push_back(PairPtrBBox(pBBox, tree.pBBox));
+  void AABBtree::refit_path(int_type inode, bool rotate) {
+    for (; inode >= 0; inode = m_parent[size_t(inode)]) {
+      fit_node(inode);
+      if (rotate)
+        rotate_node(inode);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  int_type AABBtree::insert(PtrBBox const & box) {
+    drop_wide();
+
+    // primitive slot and handle
+    int_type pos;
+    if (!m_free_prims.empty()) {
+      pos = m_free_prims.back();
+      m_free_prims.pop_back();
+    } else {
+      pos = int_type(m_prims.size());
+      m_prims.emplace_back();
+      m_prim_bounds.resize(m_prims.size());
+      m_prim_leaf.push_back(-1);
+      m_prim_handle.push_back(-1);
+    }
+    int_type handle;
+    if (!m_free_handles.empty()) {
+      handle = m_free_handles.back();
+      m_free_handles.pop_back();
+    } else {
+      handle = int_type(m_handle_pos.size());
+      m_handle_pos.push_back(-1);
+    }
+    size_t p = size_t(pos);
+    set_prim(pos, box);
+    m_prim_handle[p]             = handle;
+    m_handle_pos[size_t(handle)] = pos;
+
+    if (m_nodes.empty()) {
+      m_nodes.push_back(Node{-1, pos, pos + 1});
+      m_node_bounds.resize(1);
+      m_parent.assign(1, -1);
+      m_prim_leaf[p] = 0;
+      fit_node(0);
+      return handle;
+    }
+
+    // descend to the sibling with the cheapest area increase
+    real_type const x0 = box->x_min(), y0 = box->y_min(), x1 = box->x_max(), y1 = box->y_max();
+    Bounds const &  NB        = m_node_bounds;
+    auto            join_area = [&](int_type k) {
+      size_t kk = size_t(k);
+      return bbox_area(min(NB.xmin[kk], x0), min(NB.ymin[kk], y0), max(NB.xmax[kk], x1), max(NB.ymax[kk], y1));
+    };
+    int_type sibling = 0;
+    while (m_nodes[size_t(sibling)].child >= 0) {
+      size_t    k         = size_t(sibling);
+      int_type  c         = m_nodes[k].child;
+      real_type combined  = join_area(sibling);
+      real_type cost      = 2 * combined;  // new parent here
+      real_type inherited = 2 * (combined - bbox_area(NB.xmin[k], NB.ymin[k], NB.xmax[k], NB.ymax[k]));
+      real_type cost_child[2];
+      for (int_type i = 0; i < 2; ++i) {
+        size_t kc     = size_t(c + i);
+        cost_child[i] = join_area(c + i) + inherited;
+        if (m_nodes[kc].child >= 0)
+          cost_child[i] -= bbox_area(NB.xmin[kc], NB.ymin[kc], NB.xmax[kc], NB.ymax[kc]);
+      }
+      if (cost < cost_child[0] && cost < cost_child[1])
         break;
-      case 1:  // first is a tree, second is a leaf
-      {
-        vector<PtrAABB>::const_iterator it;
-        for (it = children.begin(); it != children.end(); ++it)
-          tree.intersect(**it, intersectionList, !swap_tree);
-      } break;
-      case 2:  // first leaf, second is a tree
-      {
-        vector<PtrAABB>::const_iterator it;
-        for (it = tree.children.begin(); it != tree.children.end(); ++it)
-          this->intersect(**it, intersectionList, swap_tree);
-      } break;
-      case 3:  // first is a tree, second is a tree
-      {
-        vector<PtrAABB>::const_iterator c1;
-        vector<PtrAABB>::const_iterator c2;
-        for (c1 = children.begin(); c1 != children.end(); ++c1)
-          for (c2 = tree.children.begin(); c2 != tree.children.end(); ++c2)
-            (*c1)->intersect(**c2, intersectionList, swap_tree);
-      } break;
+      sibling = cost_child[0] <= cost_child[1] ? c : c + 1;
     }
+
+    // the sibling moves to a new pair of slots with the new leaf,
+    // its slot becomes their parent
+    int_type pair = alloc_pair();
+    move_node(sibling, pair);
+    m_nodes[size_t(pair + 1)] = Node{-1, pos, pos + 1};
+    m_prim_leaf[p]            = pair + 1;
+    fit_node(pair + 1);
+    m_nodes[size_t(sibling)]   = Node{pair, 0, 0};
+    m_parent[size_t(pair)]     = sibling;
+    m_parent[size_t(pair + 1)] = sibling;
+    refit_path(sibling, true);
+    return handle;
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  real_type AABBtree::min_maxdist(real_type x, real_type y, AABBtree const & tree, real_type mmDist) {
-    vector<PtrAABB> const & children = tree.children;
+  void AABBtree::remove(int_type handle) {
+    G2LIB_UTILS_ASSERT(
+        handle >= 0 && handle < int_type(m_handle_pos.size()) && m_handle_pos[size_t(handle)] >= 0,
+        "AABBtree::remove( handle = %d ) bad handle\n", handle);
+    drop_wide();
 
-    if (children.empty()) {
-      real_type dst = tree.pBBox->maxDistance(x, y);
-      return min(dst, mmDist);
+    // the last primitive of the leaf fills the hole
+    int_type pos  = m_handle_pos[size_t(handle)];
+    int_type leaf = m_prim_leaf[size_t(pos)];
+    Node &   N    = m_nodes[size_t(leaf)];
+    int_type last = --N.end;
+    size_t   l    = size_t(last);
+    if (pos != last) {
+      set_prim(pos, m_prims[l]);
+      m_prim_handle[size_t(pos)]            = m_prim_handle[l];
+      m_handle_pos[size_t(m_prim_handle[l])] = pos;
     }
+    m_prims[l].reset();
+    m_prim_handle[l] = -1;
+    m_prim_leaf[l]   = -1;
+    m_free_prims.push_back(last);
+    m_handle_pos[size_t(handle)] = -1;
+    m_free_handles.push_back(handle);
+
+    if (N.end > N.begin) {
+      refit_path(leaf, true);
+      return;
+    }
+
+    // empty leaf, the sibling takes the place of the parent
+    int_type parent = m_parent[size_t(leaf)];
+    if (parent < 0) {
+      clear();
+      return;
+    }
+    int_type c = m_nodes[size_t(parent)].child;
+    move_node(leaf == c ? c + 1 : c, parent);
+    m_nodes[size_t(c)]     = Node{-1, 0, 0};
+    m_nodes[size_t(c + 1)] = Node{-1, 0, 0};
+    m_free_pairs.push_back(c);
+    refit_path(m_parent[size_t(parent)], true);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::update(int_type handle, PtrBBox const & box) {
+    G2LIB_UTILS_ASSERT(
+        handle >= 0 && handle < int_type(m_handle_pos.size()) && m_handle_pos[size_t(handle)] >= 0,
+        "AABBtree::update( handle = %d ) bad handle\n", handle);
+    int_type pos = m_handle_pos[size_t(handle)];
+    set_prim(pos, box);
+    refit_path(m_prim_leaf[size_t(pos)], false);
+  }
 
-    real_type dmin = tree.pBBox->distance(x, y);
-    if (dmin > mmDist)
-      return mmDist;
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-    // check bbox with
-    vector<PtrAABB>::const_iterator it;
-    for (it = children.begin(); it != children.end(); ++it)
-      mmDist = min_maxdist(x, y, **it, mmDist);
+  void AABBtree::refit(BBoxPool const & pool) {
+    vector<PtrBBox> bboxes;
+    pool.get_all(bboxes);
+    refit(bboxes);
+  }
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-    return mmDist;
+  void AABBtree::refit(vector<PtrBBox> const & bboxes) {
+    G2LIB_UTILS_ASSERT(
+        bboxes.size() == m_handle_pos.size(), "AABBtree::refit, expected %d boxes, found %d\n",
+        int_type(m_handle_pos.size()), int_type(bboxes.size()));
+    for (size_t p = 0; p < m_prims.size(); ++p)
+      if (m_prim_handle[p] >= 0)
+        set_prim(int_type(p), bboxes[size_t(m_prim_handle[p])]);
+    if (m_nodes.empty())
+      return;
+    // after the dynamic updates a child may precede its parent,
+    // fit the nodes in reverse preorder
+    vector<int_type> order;
+    order.reserve(m_nodes.size());
+    order.push_back(0);
+    for (size_t i = 0; i < order.size(); ++i) {
+      int_type c = m_nodes[size_t(order[i])].child;
+      if (c >= 0) {
+        order.push_back(c);
+        order.push_back(c + 1);
+      }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) fit_node(*it);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-  void AABBtree::min_maxdist_select(
-      real_type x, real_type y, real_type mmDist, AABBtree const & tree, VecPtrBBox & candidateList) {
-    vector<PtrAABB> const & children = tree.children;
-    real_type               dst      = tree.pBBox->distance(x, y);
-    if (dst <= mmDist) {
-      if (children.empty()) {
-        candidateList.push_back(tree.pBBox);
+  // stack of node references (or pairs of references) with inline
+  // storage, it spills on the heap only for very unbalanced trees
+  template<typename T>
+  class NodeStack {
+    static constexpr size_t N_INLINE = 128;
+    T                       m_inline[N_INLINE];
+    vector<T>               m_heap;
+    T *                     m_data     = m_inline;
+    size_t                  m_size     = 0;
+    size_t                  m_capacity = N_INLINE;
+
+    void grow() {
+      if (m_data == m_inline)
+        m_heap.assign(m_inline, m_inline + m_size);
+      m_heap.resize(2 * m_capacity);
+      m_capacity = m_heap.size();
+      m_data     = m_heap.data();
+    }
+
+   public:
+    bool   empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    T &    operator[](size_t i) { return m_data[i]; }
+    T      pop() { return m_data[--m_size]; }
+    void push_back(T const & ref) {
+      if (m_size == m_capacity)
+        grow();
+      m_data[m_size++] = ref;
+    }
+  };
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // append the overlapping pairs of children of the references a, b (not
+  // both leaves) in reverse order of visit, as they are popped from a stack
+  template<typename STACK>
+  void AABBtree::dual_expand(AABBtree const & tree, int_type a, int_type b, STACK & stack) const {
+    real_type         Wbuf[4 * wide_arity], Wbuf2[4 * wide_arity];
+    int_type          WCbuf[wide_arity], WCbuf2[wide_arity];
+    real_type const * W;
+    real_type const * W2;
+    int_type const *  WC;
+    int_type const *  WC2;
+
+    if (is_leaf(a)) {  // first leaf, second internal
+      size_t k = size_t(-1 - a);
+      tree.node_lanes(b, W2, WC2, Wbuf2, WCbuf2);
+      unsigned m = wide_overlap(
+          W2, m_node_bounds.xmin[k], m_node_bounds.ymin[k], m_node_bounds.xmax[k], m_node_bounds.ymax[k]);
+      for (int_type j = wide_arity - 1; j >= 0; --j)
+        if (((m >> j) & 1u) && WC2[j] != empty_lane)
+          stack.push_back({a, WC2[j]});
+    } else if (tree.is_leaf(b)) {  // first internal, second leaf
+      size_t         k  = size_t(-1 - b);
+      Bounds const & NB = tree.m_node_bounds;
+      node_lanes(a, W, WC, Wbuf, WCbuf);
+      unsigned m = wide_overlap(W, NB.xmin[k], NB.ymin[k], NB.xmax[k], NB.ymax[k]);
+      for (int_type i = wide_arity - 1; i >= 0; --i)
+        if (((m >> i) & 1u) && WC[i] != empty_lane)
+          stack.push_back({WC[i], b});
+    } else {  // both internal, test each lane of the first against the second
+      node_lanes(a, W, WC, Wbuf, WCbuf);
+      tree.node_lanes(b, W2, WC2, Wbuf2, WCbuf2);
+      for (int_type i = wide_arity - 1; i >= 0; --i) {
+        if (WC[i] == empty_lane)
+          continue;
+        unsigned m = wide_overlap(W2, W[i], W[i + wide_arity], W[i + 2 * wide_arity], W[i + 3 * wide_arity]);
+        for (int_type j = wide_arity - 1; j >= 0; --j)
+          if (((m >> j) & 1u) && WC2[j] != empty_lane)
+            stack.push_back({WC[i], WC2[j]});
+      }
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::dual_traverse(AABBtree const & tree, int_type a, int_type b, PairFun fun, void * data) const {
+    // the stack holds pairs of references whose boxes overlap
+    NodeStack<pair<int_type, int_type>> stack;
+    stack.push_back({a, b});
+    while (!stack.empty()) {
+      auto [ra, rb] = stack.pop();
+      if (is_leaf(ra) && tree.is_leaf(rb)) {  // both leaf, test the primitives
+        Node const & A = m_nodes[size_t(-1 - ra)];
+        Node const & B = tree.m_nodes[size_t(-1 - rb)];
+        for (int_type i = A.begin; i < A.end; ++i)
+          for (int_type j = B.begin; j < B.end; ++j)
+            if (m_prim_bounds.collision(i, tree.m_prim_bounds, j) && fun(data, i, j))
+              return true;
       } else {
-        // check bbox with
-        vector<PtrAABB>::const_iterator it;
-        for (it = children.begin(); it != children.end(); ++it)
-          min_maxdist_select(x, y, mmDist, **it, candidateList);
+        dual_expand(tree, ra, rb, stack);
+      }
+    }
+    return false;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::dual_traverse(AABBtree const & tree, PairFun fun, void * data) const {
+    if (m_nodes.empty() || tree.m_nodes.empty())
+      return false;
+    if (!m_node_bounds.collision(0, tree.m_node_bounds, 0))
+      return false;
+    // a reference is a wide node (>= 0) or the binary node -1-ref
+    return dual_traverse(tree, m_wide_child.empty() ? -1 : 0, tree.m_wide_child.empty() ? -1 : 0, fun, data);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  //
+  // Expand the pairs of references level by level, keeping the order of
+  // visit, until there are at least `ntasks` of them. Traversing the tasks
+  // one after the other visits the primitives in the same order as the
+  // sequential traversal.
+  //
+  void AABBtree::dual_tasks(AABBtree const & tree, int_type ntasks, vector<pair<int_type, int_type>> & tasks) const {
+    tasks.clear();
+    if (m_nodes.empty() || tree.m_nodes.empty())
+      return;
+    if (!m_node_bounds.collision(0, tree.m_node_bounds, 0))
+      return;
+    tasks.emplace_back(m_wide_child.empty() ? -1 : 0, tree.m_wide_child.empty() ? -1 : 0);
+
+    vector<pair<int_type, int_type>> next, children;
+    for (bool expanded = true; expanded && tasks.size() < size_t(ntasks);) {
+      expanded = false;
+      next.clear();
+      for (auto const & [a, b] : tasks) {
+        if (is_leaf(a) && tree.is_leaf(b)) {
+          next.emplace_back(a, b);
+        } else {
+          children.clear();
+          dual_expand(tree, a, b, children);
+          next.insert(next.end(), children.rbegin(), children.rend());
+          expanded = true;
+        }
       }
+      tasks.swap(next);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::dual_traverse_parallel(AABBtree const & tree, int_type n_threads, PairFun fun, void * data) const {
+    int_type nt = Utils::num_workers(int_type(m_prims.size() + tree.m_prims.size()), n_threads, parallel_intersect_size);
+    if (nt <= 1)
+      return dual_traverse(tree, fun, data);
+
+    vector<pair<int_type, int_type>> tasks;
+    dual_tasks(tree, tasks_per_thread * nt, tasks);
+
+    // the first pair found stops the traversal of all the tasks
+    struct Stop {
+      PairFun           fun;
+      void *            data;
+      std::atomic<bool> found{false};
+    } stop{fun, data};
+    auto check = [](void * d, int_type i, int_type j) -> bool {
+      Stop & S = *static_cast<Stop *>(d);
+      if (S.found.load(std::memory_order_relaxed))
+        return true;
+      if (!S.fun(S.data, i, j))
+        return false;
+      S.found = true;
+      return true;
+    };
+    Utils::parallel_for(int_type(tasks.size()), nt, [&](int_type k) {
+      if (!stop.found.load(std::memory_order_relaxed))
+        dual_traverse(tree, tasks[size_t(k)].first, tasks[size_t(k)].second, check, &stop);
+    });
+    return stop.found;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::print_node(ostream_type & stream, int_type inode, int level) const {
+    size_t k = size_t(inode);
+    stream << Utils::format_string(
+        "BBOX xmin=%-12.4f ymin=%-12.4f xmax=%-12.4f ymax=%-12.4f\n", m_node_bounds.xmin[k], m_node_bounds.ymin[k],
+        m_node_bounds.xmax[k], m_node_bounds.ymax[k]);
+    Node const & N = m_nodes[k];
+    if (N.child >= 0) {
+      print_node(stream, N.child, level + 1);
+      print_node(stream, N.child + 1, level + 1);
+    } else if (N.end - N.begin > 1) {
+      for (int_type i = N.begin; i < N.end; ++i)
+        stream << Utils::format_string(
+            "BBOX xmin=%-12.4f ymin=%-12.4f xmax=%-12.4f ymax=%-12.4f\n", m_prim_bounds.xmin[size_t(i)],
+            m_prim_bounds.ymin[size_t(i)], m_prim_bounds.xmax[size_t(i)], m_prim_bounds.ymax[size_t(i)]);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::print(ostream_type & stream, int level) const {
+    if (empty())
+      stream << "[EMPTY AABB tree]\n";
+    else
+      print_node(stream, 0, level);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::overlapping_prims(
+      AABBtree const & tree, int_type n_threads, vector<pair<int_type, int_type>> & prims) const {
+    using VecPair = vector<pair<int_type, int_type>>;
+    int_type nt = Utils::num_workers(int_type(m_prims.size() + tree.m_prims.size()), n_threads, parallel_intersect_size);
+    if (nt <= 1) {
+      auto fun = [&prims](int_type i, int_type j) -> bool {
+        prims.emplace_back(i, j);
+        return false;
+      };
+      dual_traverse(tree, fun);
+      return;
+    }
+
+    // each task collects its pairs in its own buffer, the buffers are
+    // appended in the order of the tasks so the result does not depend on
+    // the number of threads
+    VecPair tasks;
+    dual_tasks(tree, tasks_per_thread * nt, tasks);
+    vector<VecPair> found(tasks.size());
+    Utils::parallel_for(int_type(tasks.size()), nt, [&](int_type k) {
+      VecPair & F   = found[size_t(k)];
+      auto      fun = [&F](int_type i, int_type j) -> bool {
+        F.emplace_back(i, j);
+        return false;
+      };
+      dual_traverse(tree, tasks[size_t(k)].first, tasks[size_t(k)].second, fun);
+    });
+    size_t n = 0;
+    for (VecPair const & F : found) n += F.size();
+    prims.reserve(prims.size() + n);
+    for (VecPair const & F : found) prims.insert(prims.end(), F.begin(), F.end());
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::intersect(
+      AABBtree const & tree, VecPairPtrBBox & intersectionList, bool swap_tree, int_type n_threads) const {
+    vector<pair<int_type, int_type>> prims;
+    overlapping_prims(tree, n_threads, prims);
+    intersectionList.reserve(intersectionList.size() + prims.size());
+    for (auto const & [i, j] : prims) {
+      PtrBBox const & b1 = m_prims[size_t(i)];
+      PtrBBox const & b2 = tree.m_prims[size_t(j)];
+      if (swap_tree)
+        intersectionList.emplace_back(b2, b1);
+      else
+        intersectionList.emplace_back(b1, b2);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::intersect(
+      AABBtree const & tree, vector<pair<int_type, int_type>> & iposList, bool swap_tree, int_type n_threads) const {
+    size_t n0 = iposList.size();
+    overlapping_prims(tree, n_threads, iposList);
+    for (size_t k = n0; k < iposList.size(); ++k) {
+      auto & [i, j] = iposList[k];
+      i = m_prims[size_t(i)]->Ipos();
+      j = tree.m_prims[size_t(j)]->Ipos();
+      if (swap_tree)
+        std::swap(i, j);
     }
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
   void AABBtree::min_distance(real_type x, real_type y, VecPtrBBox & candidateList) const {
-    real_type mmDist = min_maxdist(x, y, *this, numeric_limits<real_type>::infinity());
-    min_maxdist_select(x, y, mmDist, *this, candidateList);
+    auto fun = [&candidateList](PtrBBox const & box) -> bool {
+      candidateList.push_back(box);
+      return false;
+    };
+    visit_min_distance(x, y, fun);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::min_distance_visit(real_type x, real_type y, BoxFun fun, void * data) const {
+    if (m_nodes.empty())
+      return false;
+
+    Bounds const & PB = m_prim_bounds;
+
+    // a reference is a wide node (>= 0) or the binary node -1-ref, with the
+    // squared distance of its box. Boxes are pruned on the squared distance
+    // with a small relative margin, the final selection is done with the
+    // exact distance of the primitives.
+    struct Item {
+      int_type  ref;
+      real_type d2;
+    };
+    real_type const   margin = 1 + 1e-10;
+    real_type         d2[wide_arity];
+    real_type         Wbuf[4 * wide_arity];
+    int_type          WCbuf[wide_arity];
+    real_type const * W;
+    int_type const *  WC;
+    NodeStack<Item>   stack;
+
+    // first pass: minimum of the maximum distance, nearest child first
+    real_type mmDist = numeric_limits<real_type>::infinity();
+    real_type mm2    = mmDist;
+    stack.push_back(Item{m_wide_child.empty() ? -1 : 0, 0});
+    while (!stack.empty()) {
+      Item I = stack.pop();
+      if (I.d2 > mm2)
+        continue;
+      if (is_leaf(I.ref)) {
+        Node const & N = m_nodes[size_t(-1 - I.ref)];
+        for (size_t i = size_t(N.begin); i < size_t(N.end); ++i)
+          mmDist = min(mmDist, bbox_max_distance(x, y, PB.xmin[i], PB.ymin[i], PB.xmax[i], PB.ymax[i]));
+        mm2 = mmDist * mmDist * margin;
+      } else {
+        node_lanes(I.ref, W, WC, Wbuf, WCbuf);
+        wide_distance2(W, x, y, d2);
+        size_t first = stack.size();
+        for (int_type i = 0; i < wide_arity; ++i) {
+          if (WC[i] == empty_lane || d2[i] > mm2)
+            continue;
+          // keep the pushed lanes sorted by decreasing distance
+          Item   J{WC[i], d2[i]};
+          size_t k = stack.size();
+          stack.push_back(J);
+          for (; k > first && stack[k - 1].d2 < J.d2; --k) stack[k] = stack[k - 1];
+          stack[k] = J;
+        }
+      }
+    }
+
+    // second pass: select the boxes nearer than mmDist
+    stack.push_back(Item{m_wide_child.empty() ? -1 : 0, 0});
+    while (!stack.empty()) {
+      Item I = stack.pop();
+      if (is_leaf(I.ref)) {
+        Node const & N = m_nodes[size_t(-1 - I.ref)];
+        for (size_t i = size_t(N.begin); i < size_t(N.end); ++i)
+          if (bbox_distance(x, y, PB.xmin[i], PB.ymin[i], PB.xmax[i], PB.ymax[i]) <= mmDist && fun(data, int_type(i)))
+            return true;
+      } else {
+        node_lanes(I.ref, W, WC, Wbuf, WCbuf);
+        wide_distance2(W, x, y, d2);
+        for (int_type i = wide_arity - 1; i >= 0; --i)
+          if (WC[i] != empty_lane && d2[i] <= mm2)
+            stack.push_back(Item{WC[i], d2[i]});
+      }
+    }
+    return false;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  template<typename LANES, typename PRIM>
+  bool AABBtree::query_visit(LANES const & lanes, PRIM const & prim, BoxFun fun, void * data) const {
+    if (m_nodes.empty())
+      return false;
+    // a reference is a wide node (>= 0) or the binary node -1-ref
+    real_type         Wbuf[4 * wide_arity];
+    int_type          WCbuf[wide_arity];
+    real_type const * W;
+    int_type const *  WC;
+    NodeStack<int_type> stack;
+    stack.push_back(m_wide_child.empty() ? -1 : 0);
+    while (!stack.empty()) {
+      int_type ref = stack.pop();
+      if (is_leaf(ref)) {
+        Node const & N = m_nodes[size_t(-1 - ref)];
+        for (int_type i = N.begin; i < N.end; ++i)
+          if (prim(size_t(i)) && fun(data, i))
+            return true;
+      } else {
+        node_lanes(ref, W, WC, Wbuf, WCbuf);
+        unsigned m = lanes(W);
+        for (int_type i = wide_arity - 1; i >= 0; --i)
+          if (((m >> i) & 1u) && WC[i] != empty_lane)
+            stack.push_back(WC[i]);
+      }
+    }
+    return false;
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::query_box_visit(
+      real_type xmin, real_type ymin, real_type xmax, real_type ymax, BoxFun fun, void * data) const {
+    Bounds const & PB    = m_prim_bounds;
+    auto           lanes = [=](real_type const * W) -> unsigned { return wide_overlap(W, xmin, ymin, xmax, ymax); };
+    auto           prim  = [&PB, xmin, ymin, xmax, ymax](size_t i) -> bool {
+      return PB.xmin[i] <= xmax && PB.ymin[i] <= ymax && PB.xmax[i] >= xmin && PB.ymax[i] >= ymin;
+    };
+    return query_visit(lanes, prim, fun, data);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::query_radius_visit(real_type x, real_type y, real_type r, BoxFun fun, void * data) const {
+    Bounds const & PB    = m_prim_bounds;
+    real_type      r2    = r * r * (1 + 1e-10);  // nodes are pruned on the squared distance
+    auto           lanes = [x, y, r2](real_type const * W) -> unsigned {
+      real_type d2[wide_arity];
+      wide_distance2(W, x, y, d2);
+      unsigned m = 0;
+      for (int_type i = 0; i < wide_arity; ++i)
+        if (d2[i] <= r2)
+          m |= 1u << i;
+      return m;
+    };
+    auto prim = [&PB, x, y, r](size_t i) -> bool {
+      return bbox_distance(x, y, PB.xmin[i], PB.ymin[i], PB.xmax[i], PB.ymax[i]) <= r;
+    };
+    return query_visit(lanes, prim, fun, data);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::nearest_visit(real_type x, real_type y, NearestFun fun, void * data) const {
+    if (m_nodes.empty())
+      return;
+
+    // kind of the queued items, a node is a wide node (>= 0) or the binary node -1-id
+    enum : int_type { NODE, PRIM };
+    struct Item {
+      real_type dst;  // lower bound of the distance
+      int_type  kind;
+      int_type  id;
+      bool      operator<(Item const & rhs) const { return dst > rhs.dst; }  // nearest on top
+    };
+
+    Bounds const &    PB     = m_prim_bounds;
+    real_type const   margin = 1 + 1e-10;  // node distances come from squared values
+    real_type         d2[wide_arity];
+    real_type         bound = numeric_limits<real_type>::infinity();
+    real_type         Wbuf[4 * wide_arity];
+    int_type          WCbuf[wide_arity];
+    real_type const * W;
+    int_type const *  WC;
+
+    std::priority_queue<Item> queue;
+    queue.push(Item{0, NODE, m_wide_child.empty() ? -1 : 0});
+
+    while (!queue.empty()) {
+      Item I = queue.top();
+      if (I.dst > bound * margin)
+        break;  // all the remaining items are farther
+      queue.pop();
+      switch (I.kind) {
+        case PRIM:
+          if (I.dst <= bound)
+            bound = fun(data, I.id, I.dst);
+          break;
+        case NODE:
+          if (is_leaf(I.id)) {
+            Node const & N = m_nodes[size_t(-1 - I.id)];
+            for (size_t i = size_t(N.begin); i < size_t(N.end); ++i) {
+              real_type d = bbox_distance(x, y, PB.xmin[i], PB.ymin[i], PB.xmax[i], PB.ymax[i]);
+              if (d <= bound)
+                queue.push(Item{d, PRIM, int_type(i)});
+            }
+          } else {
+            node_lanes(I.id, W, WC, Wbuf, WCbuf);
+            wide_distance2(W, x, y, d2);
+            for (int_type i = 0; i < wide_arity; ++i) {
+              if (WC[i] == empty_lane)
+                continue;
+              real_type d = sqrt(d2[i]);
+              if (d <= bound * margin)
+                queue.push(Item{d, NODE, WC[i]});
+            }
+          }
+          break;
+      }
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::k_nearest(
+      real_type x, real_type y, int_type k, VecPtrBBox & candidateList, vector<real_type> & distances) const {
+    candidateList.clear();
+    distances.clear();
+    if (k <= 0)
+      return;
+
+    // max heap of the k nearest found so far, the bound is the farthest of them
+    vector<pair<real_type, int_type>> best;
+    best.reserve(size_t(k));
+    auto fun = [&best, k](int_type i, real_type dst) -> real_type {
+      if (int_type(best.size()) < k) {
+        best.emplace_back(dst, i);
+        std::push_heap(best.begin(), best.end());
+      } else if (dst < best.front().first) {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = {dst, i};
+        std::push_heap(best.begin(), best.end());
+      }
+      return int_type(best.size()) < k ? numeric_limits<real_type>::infinity() : best.front().first;
+    };
+    using FUN = decltype(fun);
+    nearest_visit(
+        x, y, [](void * data, int_type i, real_type dst) -> real_type { return (*static_cast<FUN *>(data))(i, dst); },
+        &fun);
+
+    std::sort_heap(best.begin(), best.end());
+    candidateList.reserve(best.size());
+    distances.reserve(best.size());
+    for (auto const & b : best) {
+      candidateList.push_back(m_prims[size_t(b.second)]);
+      distances.push_back(b.first);
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  // entry and exit parameters of the ray (x,y)+t*(dx,dy), 0 <= t <= tmax, in
+  // the box; ix, iy are the inverse of dx, dy (huge for a null component)
+  static inline bool ray_slab(
+      real_type   xmin,
+      real_type   ymin,
+      real_type   xmax,
+      real_type   ymax,
+      real_type   x,
+      real_type   y,
+      real_type   ix,
+      real_type   iy,
+      real_type   tmax,
+      real_type & tin,
+      real_type & tout) {
+    real_type tx0 = (xmin - x) * ix, tx1 = (xmax - x) * ix;
+    real_type ty0 = (ymin - y) * iy, ty1 = (ymax - y) * iy;
+    tin           = max(max(min(tx0, tx1), min(ty0, ty1)), real_type(0));
+    tout          = min(min(max(tx0, tx1), max(ty0, ty1)), tmax);
+    return xmin <= xmax && tin <= tout;  // empty lanes have xmin > xmax
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void AABBtree::raycast_visit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, RayFun fun, void * data) const {
+    if (m_nodes.empty())
+      return;
+
+    // a reference is a wide node (>= 0) or the binary node -1-ref, with the
+    // entry parameter of the ray in its box. The children are pushed
+    // nearest on top, the nodes entered after the bound are skipped.
+    struct Item {
+      int_type  ref;
+      real_type tin;
+    };
+    Bounds const &    PB    = m_prim_bounds;
+    real_type const   ix    = 1 / (dx != 0 ? dx : real_type(1e-300));
+    real_type const   iy    = 1 / (dy != 0 ? dy : real_type(1e-300));
+    real_type         bound = max_range;
+    real_type         Wbuf[4 * wide_arity];
+    int_type          WCbuf[wide_arity];
+    real_type const * W;
+    int_type const *  WC;
+    NodeStack<Item>   stack;
+
+    real_type tin, tout;
+    if (!ray_slab(
+            m_node_bounds.xmin[0], m_node_bounds.ymin[0], m_node_bounds.xmax[0], m_node_bounds.ymax[0], x, y, ix, iy,
+            bound, tin, tout))
+      return;
+    stack.push_back(Item{m_wide_child.empty() ? -1 : 0, tin});
+    while (!stack.empty()) {
+      Item I = stack.pop();
+      if (I.tin > bound)
+        continue;
+      if (is_leaf(I.ref)) {
+        Node const & N = m_nodes[size_t(-1 - I.ref)];
+        for (size_t i = size_t(N.begin); i < size_t(N.end); ++i)
+          if (ray_slab(PB.xmin[i], PB.ymin[i], PB.xmax[i], PB.ymax[i], x, y, ix, iy, bound, tin, tout))
+            bound = fun(data, int_type(i), tin, tout);
+      } else {
+        node_lanes(I.ref, W, WC, Wbuf, WCbuf);
+        size_t first = stack.size();
+        for (int_type i = 0; i < wide_arity; ++i) {
+          if (WC[i] == empty_lane)
+            continue;
+          if (!ray_slab(
+                  W[i], W[i + wide_arity], W[i + 2 * wide_arity], W[i + 3 * wide_arity], x, y, ix, iy, bound, tin,
+                  tout))
+            continue;
+          // keep the pushed lanes sorted by decreasing entry
+          Item   J{WC[i], tin};
+          size_t k = stack.size();
+          stack.push_back(J);
+          for (; k > first && stack[k - 1].tin < J.tin; --k) stack[k] = stack[k - 1];
+          stack[k] = J;
+        }
+      }
+    }
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  bool AABBtree::raycast(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, PtrBBox & box, real_type & t) const {
+    int_type ibest = -1;
+    t              = max_range;
+    auto fun       = [&ibest, &t](int_type i, real_type tin, real_type) -> real_type {
+      if (ibest < 0 || tin < t) {
+        ibest = i;
+        t     = tin;
+      }
+      return t;
+    };
+    using FUN = decltype(fun);
+    raycast_visit(
+        x, y, dx, dy, max_range,
+        [](void * data, int_type i, real_type tin, real_type tout) -> real_type {
+          return (*static_cast<FUN *>(data))(i, tin, tout);
+        },
+        &fun);
+    if (ibest < 0)
+      return false;
+    box = m_prims[size_t(ibest)];
+    return true;
   }
 
 }  // namespace G2lib
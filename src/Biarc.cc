@@ -577,6 +577,15 @@ namespace G2lib {
     }
   }
 
+  void Biarc::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    if (s < m_C0.length()) {
+      m_C0.evaluate_jet(s, offs, J);
+    } else {
+      s -= m_C0.length();
+      m_C1.evaluate_jet(s, offs, J);
+    }
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void Biarc::eval(real_type s, real_type & x, real_type & y) const {
@@ -760,6 +769,21 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  bool Biarc::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    // the second arc counts only if it is hit before the first one
+    bool      hit = m_C0.raycast_unit(x, y, dx, dy, max_range, s, t);
+    real_type s1, t1;
+    if (m_C1.raycast_unit(x, y, dx, dy, hit ? t : max_range, s1, t1) && (!hit || t1 < t)) {
+      s   = m_C0.length() + s1;
+      t   = t1;
+      hit = true;
+    }
+    return hit;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   int_type Biarc::closest_point_ISO(
       real_type qx, real_type qy, real_type & x, real_type & y, real_type & s, real_type & t, real_type & dst) const {
     real_type x1, y1, s1, t1, dst1;
@@ -28,6 +28,7 @@
 #include "Clothoids/BiarcList.hxx"
 #include "Utils.hxx"
 
+#include <algorithm>
 #include <cfloat>
 #include <limits>
 
@@ -112,6 +113,7 @@ namespace G2lib {
     m_s0.clear();
     m_biarcList.clear();
     this->resetLastInterval();
+    m_s_index.clear();
     m_aabb_done = false;
   }
 
@@ -123,15 +125,46 @@ namespace G2lib {
     std::copy(L.m_biarcList.begin(), L.m_biarcList.end(), back_inserter(m_biarcList));
     m_s0.reserve(L.m_s0.size());
     std::copy(L.m_s0.begin(), L.m_s0.end(), back_inserter(m_s0));
+    m_s_index = L.m_s_index;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::move_from(BiarcList & L) noexcept {
+    if (this == &L) return;
+    m_s0        = std::move(L.m_s0);
+    m_biarcList = std::move(L.m_biarcList);
+    m_s_index   = std::move(L.m_s_index);
+    m_aabb_done = L.m_aabb_done;
+    if (m_aabb_done) {
+      m_aabb_offs      = L.m_aabb_offs;
+      m_aabb_max_angle = L.m_aabb_max_angle;
+      m_aabb_max_size  = L.m_aabb_max_size;
+    }
+    m_aabb_tree = std::move(L.m_aabb_tree);
+    m_aabb_tri  = std::move(L.m_aabb_tri);
+    L.m_s0.clear();
+    L.m_biarcList.clear();
+    L.m_s_index.clear();
+    L.m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type BiarcList::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
-    Utils::search_interval<int_type, real_type>(
-        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, false, true);
-    return *lastInterval;
+    return findAtS(s, m_lastInterval.get());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type BiarcList::findAtS(real_type & s, int_type & hint) const {
+    int_type npts = static_cast<int_type>(m_s0.size());
+    if (hint < 0 || hint >= npts - 1) hint = 0;  // the list may have changed
+    // outside the hinted interval jump directly to the bin of s
+    real_type const * S = m_s0.data();
+    if ((s < S[hint] || s > S[hint + 1]) && m_s_index.valid_for(npts, S)) hint = m_s_index.guess(s, S);
+    Utils::search_interval<int_type, real_type>(npts, &m_s0.front(), s, hint, false, true);
+    return hint;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -144,6 +177,7 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void BiarcList::push_back(LineSegment const & LS) {
+    size_t n0 = m_biarcList.size();
     if (m_biarcList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(LS.length());
@@ -151,11 +185,14 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + LS.length());
     }
     m_biarcList.push_back(Biarc(LS));
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void BiarcList::push_back(CircleArc const & C) {
+    size_t n0 = m_biarcList.size();
     if (m_biarcList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(C.length());
@@ -163,11 +200,14 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + C.length());
     }
     m_biarcList.push_back(Biarc(C));
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void BiarcList::push_back(Biarc const & c) {
+    size_t n0 = m_biarcList.size();
     if (m_biarcList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(c.length());
@@ -175,11 +215,14 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + c.length());
     }
     m_biarcList.push_back(c);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void BiarcList::push_back(PolyLine const & c) {
+    size_t n0 = m_biarcList.size();
     m_s0.reserve(m_s0.size() + c.m_polylineList.size() + 1);
     m_biarcList.reserve(m_biarcList.size() + c.m_polylineList.size());
 
@@ -191,6 +234,8 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + ip->length());
       m_biarcList.push_back(Biarc(*ip));
     }
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -225,6 +270,7 @@ namespace G2lib {
       c.build(x[k - 1], y[k - 1], theta[k - 1], x[k], y[k], theta[k]);
       this->push_back(c);
     }
+    this->build_s_index();
     return true;
   }
 
@@ -272,7 +318,11 @@ namespace G2lib {
    |                |___/
   \*/
 
-  real_type BiarcList::length() const { return m_s0.back() - m_s0.front(); }
+  real_type BiarcList::length() const {
+    if (m_biarcList.empty())
+      return 0.0;
+    return m_s0.back() - m_s0.front();
+  }
 
   real_type BiarcList::length_ISO(real_type offs) const {
     real_type                     L  = 0;
@@ -525,6 +575,14 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void BiarcList::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    int_type      idx = this->findAtS(s);
+    Biarc const & c   = this->get(idx);
+    c.evaluate_jet(s - m_s0[idx], offs, J);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   real_type BiarcList::X(real_type s) const {
     int_type      idx = this->findAtS(s);
     Biarc const & c   = this->get(idx);
@@ -733,6 +791,11 @@ namespace G2lib {
     vector<Biarc>::iterator ic = m_biarcList.begin();
     for (; ic != m_biarcList.end(); ++ic)
       ic->translate(tx, ty);
+    if (m_aabb_done) {
+      for (Triangle2D & T : m_aabb_tri)
+        T.translate(tx, ty);
+      this->aabb_refit();
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -741,6 +804,11 @@ namespace G2lib {
     vector<Biarc>::iterator ic = m_biarcList.begin();
     for (; ic != m_biarcList.end(); ++ic)
       ic->rotate(angle, cx, cy);
+    if (m_aabb_done) {
+      for (Triangle2D & T : m_aabb_tri)
+        T.rotate(angle, cx, cy);
+      this->aabb_refit();
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -757,6 +825,8 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -777,6 +847,8 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -788,6 +860,7 @@ namespace G2lib {
       newx0 = ic->x_end();
       newy0 = ic->y_end();
     }
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -817,6 +890,8 @@ namespace G2lib {
     for (++ic; ic != m_biarcList.end(); ++ic, ++k)
       m_s0[k + 1] = m_s0[k] + ic->length();
     this->resetLastInterval();
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   /*\
@@ -830,26 +905,60 @@ namespace G2lib {
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
   void BiarcList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
     if (m_aabb_done && Utils::isZero(offs - m_aabb_offs) && Utils::isZero(max_angle - m_aabb_max_angle) &&
-        Utils::isZero(max_size - m_aabb_max_size))
+        Utils::isZero(max_size - m_aabb_max_size)) {
+      // collapse once the segments inserted by push_back
+      if (!m_aabb_tree.optimized())
+        m_aabb_tree.optimize();
       return;
+    }
 
-    vector<shared_ptr<BBox const>> bboxes;
-
+    m_aabb_tri.clear();
     bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
+    // one allocation for all the boxes
+    BBoxPool                           pool(int_type(m_aabb_tri.size()));
     vector<Triangle2D>::const_iterator it;
     int_type                           ipos = 0;
     for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
       real_type xmin, ymin, xmax, ymax;
       it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos);
     }
-    m_aabb_tree.build(bboxes);
+    m_aabb_tree.build(pool);
     m_aabb_done      = true;
     m_aabb_offs      = offs;
     m_aabb_max_angle = max_angle;
     m_aabb_max_size  = max_size;
   }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::aabb_push_back(size_t first) {
+    if (!m_aabb_done)
+      return;
+    // the handle of a triangle in the tree is its position
+    size_t ntri = m_aabb_tri.size();
+    for (size_t i = first; i < m_biarcList.size(); ++i)
+      m_biarcList[i].bbTriangles_ISO(m_aabb_offs, m_aabb_tri, m_aabb_max_angle, m_aabb_max_size, int_type(i));
+    BBoxPool pool(int_type(m_aabb_tri.size() - ntri));
+    for (size_t k = ntri; k < m_aabb_tri.size(); ++k) {
+      real_type xmin, ymin, xmax, ymax;
+      m_aabb_tri[k].bbox(xmin, ymin, xmax, ymax);
+      m_aabb_tree.insert(pool.get(pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, int_type(k))));
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::aabb_refit() {
+    BBoxPool pool(int_type(m_aabb_tri.size()));
+    int_type ipos = 0;
+    for (Triangle2D const & T : m_aabb_tri) {
+      real_type xmin, ymin, xmax, ymax;
+      T.bbox(xmin, ymin, xmax, ymax);
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos++);
+    }
+    m_aabb_tree.refit(pool);
+  }
 #endif
 
   /*\
@@ -866,7 +975,7 @@ namespace G2lib {
     this->build_AABBtree_ISO(0);
     C.build_AABBtree_ISO(0);
     T2D_collision_list_ISO fun(this, 0, &C, 0);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    return m_aabb_tree.collision(C.m_aabb_tree, fun, false, intersect_num_threads);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -875,7 +984,7 @@ namespace G2lib {
     this->build_AABBtree_ISO(offs);
     C.build_AABBtree_ISO(offs_C);
     T2D_collision_list_ISO fun(this, offs, &C, offs_C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    return m_aabb_tree.collision(C.m_aabb_tree, fun, false, intersect_num_threads);
   }
 
   /*\
@@ -892,37 +1001,47 @@ namespace G2lib {
     if (intersect_with_AABBtree) {
       this->build_AABBtree_ISO(offs);
       CL.build_AABBtree_ISO(offs_CL);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(CL.m_aabb_tree, iList);
+      vector<pair<int_type, int_type>> iList;
+      m_aabb_tree.intersect(CL.m_aabb_tree, iList, false, intersect_num_threads);
+
+      // the candidate pairs are refined in blocks, possibly concurrently,
+      // and the intersections of the blocks are appended in order
+      int_type const        block = 64;
+      int_type              nblk  = int_type((iList.size() + block - 1) / block);
+      vector<IntersectList> found(static_cast<size_t>(nblk));
+      Utils::parallel_for(nblk, Utils::num_workers(nblk, intersect_num_threads, int_type(4)), [&](int_type b) {
+        IntersectList ilist1;
+        size_t        ip_end = std::min(iList.size(), size_t(b + 1) * block);
+        for (size_t ip = size_t(b) * block; ip < ip_end; ++ip) {
+          size_t ipos1 = size_t(iList[ip].first);
+          size_t ipos2 = size_t(iList[ip].second);
 
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
+          Triangle2D const & T1 = m_aabb_tri[ipos1];
+          Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
 
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
+          Biarc const & C1 = m_biarcList[T1.Icurve()];
+          Biarc const & C2 = CL.m_biarcList[T2.Icurve()];
 
-        Biarc const & C1 = m_biarcList[T1.Icurve()];
-        Biarc const & C2 = CL.m_biarcList[T2.Icurve()];
+          ilist1.clear();
+          C1.intersect_ISO(offs, C2, offs_CL, ilist1, false);
 
-        IntersectList ilist1;
-        C1.intersect_ISO(offs, C2, offs_CL, ilist1, false);
-
-        for (IntersectList::const_iterator it = ilist1.begin(); it != ilist1.end(); ++it) {
-          real_type ss1 = it->first + m_s0[T1.Icurve()];
-          real_type ss2 = it->second + CL.m_s0[T2.Icurve()];
-          if (swap_s_vals)
-            swap(ss1, ss2);
-          ilist.push_back(Ipair(ss1, ss2));
+          for (IntersectList::const_iterator it = ilist1.begin(); it != ilist1.end(); ++it) {
+            real_type ss1 = it->first + m_s0[T1.Icurve()];
+            real_type ss2 = it->second + CL.m_s0[T2.Icurve()];
+            if (swap_s_vals)
+              swap(ss1, ss2);
+            found[size_t(b)].push_back(Ipair(ss1, ss2));
+          }
         }
-      }
+      });
+      for (IntersectList const & F : found) ilist.insert(ilist.end(), F.begin(), F.end());
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      CL.bbTriangles_ISO(offs_CL, CL.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      CL.bbTriangles_ISO(offs_CL, tri2, Utils::m_pi / 18, 1e100);
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = CL.m_aabb_tri.begin(); i2 != CL.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
@@ -944,6 +1063,26 @@ namespace G2lib {
     }
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool BiarcList::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    this->build_AABBtree_ISO(0);
+    bool hit    = false;
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type, real_type) -> real_type {
+      size_t    icurve = size_t(m_aabb_tri[size_t(box->Ipos())].Icurve());
+      real_type sb, tb;
+      if (m_biarcList[icurve].raycast_unit(x, y, dx, dy, hit ? t : max_range, sb, tb) && (!hit || tb < t)) {
+        hit = true;
+        s   = sb + m_s0[icurve];
+        t   = tb;
+      }
+      return hit ? t : max_range;
+    };
+    m_aabb_tree.raycast(x, y, dx, dy, max_range, refine);
+    return hit;
+  }
+
   /*\
    |      _ _     _
    |   __| (_)___| |_ __ _ _ __   ___ ___
@@ -956,16 +1095,13 @@ namespace G2lib {
       real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const {
     this->build_AABBtree_ISO(offs);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "BiarcList::closest_point_internal no candidate\n");
+    G2LIB_UTILS_ASSERT0(m_aabb_tree.num_bboxes() > 0, "BiarcList::closest_point_internal no candidate\n");
     int_type icurve = 0;
     DST             = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
+    // visit the triangles nearest first, refining only while they can improve DST
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type) -> real_type {
+      Triangle2D const & T   = m_aabb_tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
       if (dst < DST) {
         // refine distance
         real_type xx, yy, ss, tt;
@@ -978,7 +1114,9 @@ namespace G2lib {
           icurve = T.Icurve();
         }
       }
-    }
+      return DST;
+    };
+    m_aabb_tree.nearest(qx, qy, refine);
     return icurve;
   }
 
@@ -1009,6 +1147,72 @@ namespace G2lib {
       real_type qx, real_type qy, real_type & x, real_type & y, real_type & s, real_type & t, real_type & dst) const {
     return closest_point_ISO(qx, qy, 0, x, y, s, t, dst);
   }
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::triangle_ranges(
+      vector<int_type> & segments, vector<real_type> & s_begin, vector<real_type> & s_end) const {
+    // triangles are stored segment by segment, sorting the positions groups
+    // them by segment and the ranges are compacted in place
+    std::sort(segments.begin(), segments.end());
+    s_begin.clear();
+    s_end.clear();
+    size_t n = 0;
+    for (size_t k = 0; k < segments.size(); ++k) {
+      Triangle2D const & T  = m_aabb_tri[size_t(segments[k])];
+      int_type           ic = T.Icurve();
+      real_type          s0 = m_s0[size_t(ic)];
+      if (n > 0 && segments[n - 1] == ic) {
+        s_begin.back() = std::min(s_begin.back(), s0 + T.S0());
+        s_end.back()   = std::max(s_end.back(), s0 + T.S1());
+      } else {
+        segments[n++] = ic;
+        s_begin.push_back(s0 + T.S0());
+        s_end.push_back(s0 + T.S1());
+      }
+    }
+    segments.resize(n);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::segments_in_box(
+      real_type           xmin,
+      real_type           ymin,
+      real_type           xmax,
+      real_type           ymax,
+      vector<int_type> &  segments,
+      vector<real_type> & s_begin,
+      vector<real_type> & s_end) const {
+    this->build_AABBtree_ISO(0);
+    segments.clear();
+    auto fun = [&segments](AABBtree::PtrBBox const & box) -> bool {
+      segments.push_back(box->Ipos());
+      return false;
+    };
+    m_aabb_tree.query_box(xmin, ymin, xmax, ymax, fun);
+    triangle_ranges(segments, s_begin, s_end);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void BiarcList::segments_in_radius(
+      real_type           x,
+      real_type           y,
+      real_type           r,
+      vector<int_type> &  segments,
+      vector<real_type> & s_begin,
+      vector<real_type> & s_end) const {
+    this->build_AABBtree_ISO(0);
+    segments.clear();
+    auto fun = [this, &segments, x, y, r](AABBtree::PtrBBox const & box) -> bool {
+      if (m_aabb_tri[size_t(box->Ipos())].distMin(x, y) <= r)
+        segments.push_back(box->Ipos());
+      return false;
+    };
+    m_aabb_tree.query_radius(x, y, r, fun);
+    triangle_ranges(segments, s_begin, s_end);
+  }
+
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -245,6 +245,31 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void CircleArc::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    real_type sk    = (s * m_k) / 2;
+    real_type LS    = s * Sinc(sk);
+    real_type arg   = m_theta0 + sk;
+    real_type theta = m_theta0 + s * m_k;
+    real_type C     = cos(theta);
+    real_type S     = sin(theta);
+    real_type scale = 1 - offs * m_k;
+    real_type k2    = m_k * m_k;
+
+    J.x       = m_x0 + LS * cos(arg) - offs * S;
+    J.y       = m_y0 + LS * sin(arg) + offs * C;
+    J.theta   = theta;
+    J.kappa   = m_k / (1 + offs * m_k);  // same scaling of evaluate_ISO
+    J.kappa_D = 0;
+    J.x_D     = C * scale;
+    J.y_D     = S * scale;
+    J.x_DD    = -m_k * scale * S;
+    J.y_DD    = m_k * scale * C;
+    J.x_DDD   = -k2 * scale * C;
+    J.y_DDD   = -k2 * scale * S;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   void CircleArc::trim(real_type s_begin, real_type s_end) {
     G2LIB_UTILS_ASSERT(
         s_end > s_begin, "CircleArc::trim( begin=%f, s_end=%f ) s_end must be > s_begin\n", s_begin, s_end);
@@ -392,7 +417,7 @@ namespace G2lib {
       real_type ny  = xx2 - xx0;
       xx1 -= nx * tg;
       yy1 -= ny * tg;
-      tvec.push_back(Triangle2D(xx0, yy0, xx1, yy1, xx2, yy2, 0, 0, icurve));
+      tvec.push_back(Triangle2D(xx0, yy0, xx1, yy1, xx2, yy2, ss - ds, ss, icurve));
       xx0 = xx2;
       yy0 = yy2;
     }
@@ -426,7 +451,7 @@ namespace G2lib {
       real_type ny  = xx2 - xx0;
       xx1 -= nx * tg;
       yy1 -= ny * tg;
-      tvec.push_back(Triangle2D(xx0, yy0, xx1, yy1, xx2, yy2, 0, 0, icurve));
+      tvec.push_back(Triangle2D(xx0, yy0, xx1, yy1, xx2, yy2, ss - ds, ss, icurve));
       xx0 = xx2;
       yy0 = yy2;
     }
@@ -558,6 +583,32 @@ namespace G2lib {
     }
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool CircleArc::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    // the ray is a circle with null curvature, clipped to the arc so the
+    // far roots of a nearly tangent ray are discarded
+    real_type xmin, ymin, xmax, ymax;
+    this->bbox(xmin, ymin, xmax, ymax);
+    max_range = Utils::ray_reach(x, y, xmin, ymin, xmax, ymax, max_range);
+    real_type s1[2], s2[2];
+    int_type  ni   = intersectCircleCircle(m_x0, m_y0, m_theta0, m_k, x, y, atan2(dy, dx), 0, s1, s2);
+    real_type eps1 = Utils::machepsi100 * m_L;
+    real_type eps2 = Utils::machepsi100 * max_range;
+    bool      hit  = false;
+    for (int_type i = 0; i < ni; ++i) {
+      if (s1[i] < -eps1 || s1[i] > m_L + eps1 || s2[i] < -eps2 || s2[i] > max_range)
+        continue;
+      if (!hit || s2[i] < t) {
+        hit = true;
+        s   = min(max(s1[i], real_type(0)), m_L);
+        t   = max(s2[i], real_type(0));
+      }
+    }
+    return hit;
+  }
+
   /*\
    |        _                     _   ____       _       _
    |    ___| | ___  ___  ___  ___| |_|  _ \ ___ (_)_ __ | |_
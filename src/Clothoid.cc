@@ -301,6 +301,20 @@ namespace G2lib {
     return 0;
   }
 
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  int_type ClothoidCurve::sample_uniform(
+      real_type   ds,
+      real_type * x,
+      real_type * y,
+      real_type * theta,
+      real_type * kappa) const {
+    G2LIB_UTILS_ASSERT(ds > 0, "ClothoidCurve::sample_uniform( ds = %g, ...) expected ds > 0\n", ds);
+    int_type n = sample_uniform_size(ds);
+    m_CD.sample_uniform(0, ds, n, x, y, theta, kappa);
+    return n;
+  }
+
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
   /*\
    |     _        _    ____  ____  _
@@ -316,18 +330,18 @@ namespace G2lib {
         Utils::isZero(max_size - m_aabb_max_size))
       return;
 
-    vector<shared_ptr<BBox const>> bboxes;
-
+    m_aabb_tri.clear();
     bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
+    // one allocation for all the boxes
+    BBoxPool                           pool(int_type(m_aabb_tri.size()));
     vector<Triangle2D>::const_iterator it;
     int_type                           ipos = 0;
     for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
       real_type xmin, ymin, xmax, ymax;
       it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos);
     }
-    m_aabb_tree.build(bboxes);
+    m_aabb_tree.build(pool);
     m_aabb_done      = true;
     m_aabb_offs      = offs;
     m_aabb_max_angle = max_angle;
@@ -474,16 +488,10 @@ namespace G2lib {
     if (intersect_with_AABBtree) {
       this->build_AABBtree_ISO(offs);
       C.build_AABBtree_ISO(offs_C);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(C.m_aabb_tree, iList);
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
-
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = C.m_aabb_tri[ipos2];
+      // refine the pairs of overlapping triangles as they are found
+      auto refine = [&](AABBtree::PtrBBox const & b1, AABBtree::PtrBBox const & b2) -> bool {
+        Triangle2D const & T1 = m_aabb_tri[size_t(b1->Ipos())];
+        Triangle2D const & T2 = C.m_aabb_tri[size_t(b2->Ipos())];
 
         real_type ss1, ss2;
         bool      converged = aabb_intersect_ISO(T1, offs, &C, T2, offs_C, ss1, ss2);
@@ -493,13 +501,16 @@ namespace G2lib {
             swap(ss1, ss2);
           ilist.push_back(Ipair(ss1, ss2));
         }
-      }
+        return false;
+      };
+      m_aabb_tree.visit_overlaps(C.m_aabb_tree, refine);
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      C.bbTriangles_ISO(offs_C, C.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      C.bbTriangles_ISO(offs_C, tri2, Utils::m_pi / 18, 1e100);
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = C.m_aabb_tri.begin(); i2 != C.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
@@ -516,6 +527,33 @@ namespace G2lib {
     }
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidCurve::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    this->build_AABBtree_ISO(0);
+    // the ray as a straight clothoid clipped to the tree, a degenerate
+    // triangle carries the range of the ray inside the candidate box for
+    // the Newton iteration
+    real_type xmin, ymin, xmax, ymax;
+    m_aabb_tree.bbox(xmin, ymin, xmax, ymax);
+    ClothoidCurve ray(x, y, atan2(dy, dx), 0, 0, Utils::ray_reach(x, y, xmin, ymin, xmax, ymax, max_range));
+    bool          hit    = false;
+    auto          refine = [&](AABBtree::PtrBBox const & box, real_type tin, real_type tout) -> real_type {
+      Triangle2D const & T1 = m_aabb_tri[size_t(box->Ipos())];
+      Triangle2D         T2(x, y, x, y, x, y, tin, tout, 0);
+      real_type          ss1, ss2;
+      if (aabb_intersect_ISO(T1, 0, &ray, T2, 0, ss1, ss2) && (!hit || ss2 < t)) {
+        hit = true;
+        s   = ss1;
+        t   = ss2;
+      }
+      return hit ? t : max_range;
+    };
+    m_aabb_tree.raycast(x, y, dx, dy, max_range, refine);
+    return hit;
+  }
+
   /*\
    |        _                     _   ____       _       _
    |    ___| | ___  ___  ___  ___| |_|  _ \ ___ (_)_ __ | |_
@@ -594,14 +632,11 @@ namespace G2lib {
     DST = numeric_limits<real_type>::infinity();
     this->build_AABBtree_ISO(offs);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidCurve::closest_point_internal no candidate\n");
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
+    G2LIB_UTILS_ASSERT0(m_aabb_tree.num_bboxes() > 0, "ClothoidCurve::closest_point_internal no candidate\n");
+    // visit the triangles nearest first, refining only while they can improve DST
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type) -> real_type {
+      Triangle2D const & T   = m_aabb_tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
       if (dst < DST) {
         // refine distance
         real_type xx, yy, ss;
@@ -613,7 +648,9 @@ namespace G2lib {
           y   = yy;
         }
       }
-    }
+      return DST;
+    };
+    m_aabb_tree.nearest(qx, qy, refine);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
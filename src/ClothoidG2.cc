@@ -30,6 +30,7 @@
 
 #include <cfloat>
 #include <iostream>
+#include <limits>
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -1117,7 +1118,7 @@ namespace G2lib {
     m_npts    = n;
     size_t n1 = size_t(n - 1);
 
-    realValues = std::vector<real_type>(2 * size_t(n) + 10 * n1, 0.0);
+    realValues = std::vector<real_type>(2 * size_t(n) + 11 * n1, 0.0);
 
     m_x    = &realValues.front();
     m_y    = m_x + n;
@@ -1131,8 +1132,11 @@ namespace G2lib {
     m_k_2  = m_k_1 + n1;
     m_dk_1 = m_k_2 + n1;
     m_dk_2 = m_dk_1 + n1;
+    m_A    = m_dk_2 + n1;
     std::copy_n(xvec, n, m_x);
     std::copy_n(yvec, n, m_y);
+    // no previous solution, first call start from the cold guess
+    std::fill_n(m_A, n1, std::numeric_limits<real_type>::quiet_NaN());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1154,8 +1158,21 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void ClothoidSplineG2::build_segments(real_type const * theta, bool compute_deriv) const {
+    int_type ne = m_npts - 1;
+    // m_L_2, m_k_2, m_dk_2 follow m_L_1, m_k_1, m_dk_1 in the work vector
+    if (compute_deriv)
+      build_G1_batch_warm(
+          ne, m_x, m_y, theta, m_x + 1, m_y + 1, theta + 1, 1e-12, m_A, m_L, m_k, m_dk, m_L_1, m_k_1, m_dk_1);
+    else
+      build_G1_batch_warm(ne, m_x, m_y, theta, m_x + 1, m_y + 1, theta + 1, 1e-12, m_A, m_L, m_k, m_dk);
+    for (int_type j = 0; j < ne; ++j) m_kL[j] = m_k[j] + m_dk[j] * m_L[j];
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   bool ClothoidSplineG2::objective(real_type const * theta, real_type & f) const {
-    ClothoidCurve cL, cR, c;
+    ClothoidCurve cL, cR;
     int_type      ne  = m_npts - 1;
     int_type      ne1 = m_npts - 2;
     switch (m_tt) {
@@ -1181,41 +1198,39 @@ namespace G2lib {
         f = cL.length() + cR.length();
         break;
       case P6:
+        build_segments(theta, false);
         f = 0;
-        for (int_type j = 0; j < ne; ++j) {
-          c.build_G1(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1]);
-          f += c.length();
-        }
+        for (int_type j = 0; j < ne; ++j) f += m_L[j];
         break;
       case P7:
+        build_segments(theta, false);
         f = 0;
         for (int_type j = 0; j < ne; ++j) {
-          c.build_G1(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1]);
-          real_type Len  = c.length();
-          real_type kur  = c.kappa_begin();
-          real_type dkur = c.dkappa();
+          real_type Len  = m_L[j];
+          real_type kur  = m_k[j];
+          real_type dkur = m_dk[j];
           f              = f + Len * (Len * (dkur * ((dkur * Len) / 3 + kur)) + kur * kur);
         }
         break;
       case P8:
+        build_segments(theta, false);
         f = 0;
         for (int_type j = 0; j < ne; ++j) {
-          c.build_G1(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1]);
-          real_type Len  = c.length();
-          real_type dkur = c.dkappa();
+          real_type Len  = m_L[j];
+          real_type dkur = m_dk[j];
           f += Len * dkur * dkur;
         }
         break;
       case P9:
+        build_segments(theta, false);
         f = 0;
         for (int_type j = 0; j < ne; ++j) {
-          c.build_G1(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1]);
-          real_type Len  = c.length();
-          real_type kur  = c.kappa_begin();
+          real_type Len  = m_L[j];
+          real_type kur  = m_k[j];
           real_type k2   = kur * kur;
           real_type k3   = k2 * kur;
           real_type k4   = k2 * k2;
-          real_type dkur = c.dkappa();
+          real_type dkur = m_dk[j];
           real_type dk2  = dkur * dkur;
           real_type dk3  = dkur * dk2;
           f              = f +
@@ -1229,7 +1244,7 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidSplineG2::gradient(real_type const * theta, real_type * g) const {
-    ClothoidCurve cL, cR, c;
+    ClothoidCurve cL, cR;
     real_type     LL_D[2], kL_D[2], dkL_D[2];
     real_type     LR_D[2], kR_D[2], dkR_D[2];
     std::fill_n(g, m_npts, 0);
@@ -1262,24 +1277,25 @@ namespace G2lib {
         g[ne]  = LR_D[1];
         break;
       case P6:
+        build_segments(theta, true);
         for (int_type j = 0; j < ne; ++j) {
-          real_type L_D[2], k_D[2], dk_D[2];
-          c.build_G1_D(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1], L_D, k_D, dk_D);
-          g[j] += L_D[0];
-          g[j + 1] += L_D[1];
+          g[j] += m_L_1[j];
+          g[j + 1] += m_L_2[j];
         }
         break;
       case P7:
+        build_segments(theta, true);
         for (int_type j = 0; j < ne; ++j) {
-          real_type L_D[2], k_D[2], dk_D[2];
-          c.build_G1_D(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1], L_D, k_D, dk_D);
-          real_type Len  = c.length();
-          real_type L2   = Len * Len;
-          real_type L3   = Len * L2;
-          real_type kur  = c.kappa_begin();
-          real_type k2   = kur * kur;
-          real_type dkur = c.dkappa();
-          real_type dk2  = dkur * dkur;
+          real_type L_D[2]  = { m_L_1[j], m_L_2[j] };
+          real_type k_D[2]  = { m_k_1[j], m_k_2[j] };
+          real_type dk_D[2] = { m_dk_1[j], m_dk_2[j] };
+          real_type Len     = m_L[j];
+          real_type L2      = Len * Len;
+          real_type L3      = Len * L2;
+          real_type kur     = m_k[j];
+          real_type k2      = kur * kur;
+          real_type dkur    = m_dk[j];
+          real_type dk2     = dkur * dkur;
           g[j] += 2 * (dkur * dk_D[0] * L3) / 3 + (dk2 * L2 * L_D[0]) + dk_D[0] * L2 * kur +
                   2 * dkur * Len * L_D[0] * kur + dkur * L2 * k_D[0] + L_D[0] * k2 + 2 * Len * kur * k_D[0];
           g[j + 1] += 2 * (dkur * dk_D[1] * L3) / 3 + (dk2 * L2 * L_D[1]) + dk_D[1] * L2 * kur +
@@ -1287,29 +1303,32 @@ namespace G2lib {
         }
         break;
       case P8:
+        build_segments(theta, true);
         for (int_type j = 0; j < ne; ++j) {
-          real_type L_D[2], k_D[2], dk_D[2];
-          c.build_G1_D(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1], L_D, k_D, dk_D);
-          real_type Len  = c.length();
-          real_type dkur = c.dkappa();
+          real_type L_D[2]  = { m_L_1[j], m_L_2[j] };
+          real_type dk_D[2] = { m_dk_1[j], m_dk_2[j] };
+          real_type Len     = m_L[j];
+          real_type dkur    = m_dk[j];
           g[j] += (2 * Len * dk_D[0] + L_D[0] * dkur) * dkur;
           g[j + 1] += (2 * Len * dk_D[1] + L_D[1] * dkur) * dkur;
         }
         break;
       case P9:
+        build_segments(theta, true);
         for (int_type j = 0; j < ne; ++j) {
-          real_type L_D[2], k_D[2], dk_D[2];
-          c.build_G1_D(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1], L_D, k_D, dk_D);
-          real_type Len  = c.length();
-          real_type kur  = c.kappa_begin();
-          real_type k2   = kur * kur;
-          real_type k3   = kur * k2;
-          real_type dkur = c.dkappa();
-          real_type dk2  = dkur * dkur;
-          real_type dkL  = dkur * Len;
-          real_type A    = (((dkL + 4 * kur) * dkL + 6 * k2) * dkL + 4 * k3) * dkL + dk2 + k2 * k2;
-          real_type B    = ((((3 * kur + 0.8 * dkL) * dkL + 4 * k2) * dkL + 2 * k3) * Len + 2 * dkur) * Len;
-          real_type C    = (((dkL + 4 * kur) * dkL + 6 * k2) * dkL + 4 * k3) * Len;
+          real_type L_D[2]  = { m_L_1[j], m_L_2[j] };
+          real_type k_D[2]  = { m_k_1[j], m_k_2[j] };
+          real_type dk_D[2] = { m_dk_1[j], m_dk_2[j] };
+          real_type Len     = m_L[j];
+          real_type kur     = m_k[j];
+          real_type k2      = kur * kur;
+          real_type k3      = kur * k2;
+          real_type dkur    = m_dk[j];
+          real_type dk2     = dkur * dkur;
+          real_type dkL     = dkur * Len;
+          real_type A       = (((dkL + 4 * kur) * dkL + 6 * k2) * dkL + 4 * k3) * dkL + dk2 + k2 * k2;
+          real_type B       = ((((3 * kur + 0.8 * dkL) * dkL + 4 * k2) * dkL + 2 * k3) * Len + 2 * dkur) * Len;
+          real_type C       = (((dkL + 4 * kur) * dkL + 6 * k2) * dkL + 4 * k3) * Len;
           g[j] += A * L_D[0] + B * dk_D[0] + C * k_D[0];
           g[j + 1] += A * L_D[1] + B * dk_D[1] + C * k_D[1];
         }
@@ -1321,17 +1340,10 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidSplineG2::constraints(real_type const * theta, real_type * c) const {
-    ClothoidCurve cc;
-    int_type      ne  = m_npts - 1;
-    int_type      ne1 = m_npts - 2;
+    int_type ne  = m_npts - 1;
+    int_type ne1 = m_npts - 2;
 
-    for (int_type j = 0; j < ne; ++j) {
-      cc.build_G1(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1]);
-      m_k[j]  = cc.kappa_begin();
-      m_dk[j] = cc.dkappa();
-      m_L[j]  = cc.length();
-      m_kL[j] = m_k[j] + m_dk[j] * m_L[j];
-    }
+    build_segments(theta, false);
 
     for (int_type j = 0; j < ne1; ++j)
       c[j] = m_kL[j] - m_k[j + 1];
@@ -1483,24 +1495,9 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidSplineG2::jacobian(real_type const * theta, real_type * vals) const {
-    ClothoidCurve cc;
-    int_type      ne  = m_npts - 1;
-    int_type      ne1 = m_npts - 2;
+    int_type ne1 = m_npts - 2;
 
-    for (int_type j = 0; j < ne; ++j) {
-      real_type L_D[2], k_D[2], dk_D[2];
-      cc.build_G1_D(m_x[j], m_y[j], theta[j], m_x[j + 1], m_y[j + 1], theta[j + 1], L_D, k_D, dk_D);
-      m_k[j]    = cc.kappa_begin();
-      m_dk[j]   = cc.dkappa();
-      m_L[j]    = cc.length();
-      m_kL[j]   = m_k[j] + m_dk[j] * m_L[j];
-      m_L_1[j]  = L_D[0];
-      m_L_2[j]  = L_D[1];
-      m_k_1[j]  = k_D[0];
-      m_k_2[j]  = k_D[1];
-      m_dk_1[j] = dk_D[0];
-      m_dk_2[j] = dk_D[1];
-    }
+    build_segments(theta, true);
 
     int_type kk = 0;
     for (int_type j = 0; j < ne1; ++j) {
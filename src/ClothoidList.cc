@@ -27,7 +27,10 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #include "Clothoids/ClothoidList.hxx"
 #include "Utils.hxx"
+#include "SIMD.hxx"
 
+#include <algorithm>
+#include <cstdint>
 #include <cfloat>
 #include <limits>
 #include <sstream>
@@ -49,6 +52,138 @@ namespace G2lib {
   using std::swap;
   using std::vector;
 
+  /*\
+   |   ____                                  _
+   |  / ___|  ___  __ _ _ __ ___   ___ _ __ | |_
+   |  \___ \ / _ \/ _` | '_ ` _ \ / _ \ '_ \| __|
+   |   ___) |  __/ (_| | | | | | |  __/ | | | |_
+   |  |____/ \___|\__, |_| |_| |_|\___|_| |_|\__|
+   |              |___/
+  \*/
+
+  ClothoidSegment::ClothoidSegment(ClothoidCurve const & C) {
+    CD.x0       = C.x_begin();
+    CD.y0       = C.y_begin();
+    CD.theta0   = C.theta_begin();
+    CD.kappa0   = C.kappa_begin();
+    CD.dk       = C.dkappa();
+    CD.accuracy = C.fresnel_accuracy();
+    L           = C.length();
+    update_direction();
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  ClothoidCurve ClothoidSegment::curve() const {
+    ClothoidCurve C(CD.x0, CD.y0, CD.theta0, CD.kappa0, CD.dk, L);
+    C.fresnel_accuracy(CD.accuracy);
+    return C;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  real_type ClothoidSegment::length_ISO(real_type) const {
+    G2LIB_UTILS_ERROR0("Offset length not available for Clothoids\n");
+    return 0;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // the Fresnel integrals are computed with zero initial angle
+  // and rotated with the stored direction
+
+  void ClothoidSegment::eval(real_type s, real_type & x, real_type & y) const {
+    real_type C, S;
+    GeneralizedFresnelCS(CD.dk * s * s, CD.kappa0 * s, 0, C, S, CD.accuracy);
+    x = CD.x0 + s * (C * cos0 - S * sin0);
+    y = CD.y0 + s * (C * sin0 + S * cos0);
+  }
+
+  real_type ClothoidSegment::X(real_type s) const {
+    real_type C, S;
+    GeneralizedFresnelCS(CD.dk * s * s, CD.kappa0 * s, 0, C, S, CD.accuracy);
+    return CD.x0 + s * (C * cos0 - S * sin0);
+  }
+
+  real_type ClothoidSegment::Y(real_type s) const {
+    real_type C, S;
+    GeneralizedFresnelCS(CD.dk * s * s, CD.kappa0 * s, 0, C, S, CD.accuracy);
+    return CD.y0 + s * (C * sin0 + S * cos0);
+  }
+
+  void ClothoidSegment::eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const {
+    eval(s, x, y);
+    real_type theta = CD.theta(s);
+    x -= offs * sin(theta);
+    y += offs * cos(theta);
+  }
+
+  /*\
+   |      _             _                    _   _     ___           _
+   |     / \   _ __ ___| |    ___ _ __   __ _| |_| |__ |_ _|_ __   __| | _____  __
+   |    / _ \ | '__/ __| |   / _ \ '_ \ / _` | __| '_ \ | || '_ \ / _` |/ _ \ \/ /
+   |   / ___ \| | | (__| |__|  __/ | | | (_| | |_| | | || || | | | (_| |  __/>  <
+   |  /_/   \_\_|  \___|_____\___|_| |_|\__, |\__|_| |_|___|_| |_|\__,_|\___/_/\_\
+   |                                    |___/
+  \*/
+
+  void ArcLengthIndex::build(int_type npts, real_type const * s0, real_type bins_per_segment) {
+    this->clear();
+    if (npts < 2) return;
+    real_type L = s0[npts - 1] - s0[0];
+    if (!(L > 0) || !(bins_per_segment > 0)) return;
+
+    m_nseg             = npts - 1;
+    m_nbins            = std::max(int_type(1), int_type(std::ceil(m_nseg * bins_per_segment)));
+    m_bins_per_segment = bins_per_segment;
+    m_s_min            = s0[0];
+    m_s_max            = s0[npts - 1];
+    m_inv_h            = m_nbins / L;
+    m_first.resize(size_t(m_nbins + 1));
+    this->fill_bins(0, s0);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ArcLengthIndex::extend(int_type npts, real_type const * s0) {
+    if (m_nbins == 0) return;
+    int_type nseg = npts - 1;
+    // not an append: the old breakpoints changed
+    if (nseg < m_nseg || s0[0] != m_s_min || s0[m_nseg] != m_s_max) {
+      this->build(npts, s0, m_bins_per_segment);
+      return;
+    }
+    if (nseg == m_nseg) return;
+    // the appended segments are short compared to the bins, rebuild
+    // when the segments per bin doubled (amortized O(1) per segment)
+    if (nseg * m_bins_per_segment > 2 * m_nbins) {
+      this->build(npts, s0, m_bins_per_segment);
+      return;
+    }
+    // same bin width, new bins up to the new end
+    int_type nb = m_nbins;
+    m_nbins     = std::max(nb, int_type(std::ceil((s0[nseg] - m_s_min) * m_inv_h)));
+    m_nseg      = nseg;
+    m_s_max     = s0[nseg];
+    m_first.resize(size_t(m_nbins + 1));
+    // the last old bin may now end in an appended segment
+    this->fill_bins(nb, s0);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ArcLengthIndex::fill_bins(int_type b0, real_type const * s0) {
+    // sweep bins and segments together, m_first[b] is the segment
+    // containing the left border of the bin b
+    real_type h   = 1 / m_inv_h;
+    int_type  seg = b0 > 0 ? m_first[size_t(b0 - 1)] : 0;
+    for (int_type b = b0; b < m_nbins; ++b) {
+      real_type sb = m_s_min + b * h;
+      while (seg < m_nseg - 1 && s0[seg + 1] <= sb) ++seg;
+      m_first[size_t(b)] = seg;
+    }
+    m_first[size_t(m_nbins)] = m_nseg - 1;
+  }
+
   /*\
    |   ____ _       _   _           _     _ _     _     _
    |  / ___| | ___ | |_| |__   ___ (_) __| | |   (_)___| |_
@@ -133,10 +268,23 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type ClothoidList::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
-    Utils::search_interval<int_type, real_type>(
-        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, m_curve_is_closed, true);
-    return *lastInterval;
+    return findAtS(s, m_lastInterval.get());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type ClothoidList::findAtS(real_type & s, int_type & hint) const {
+    int_type npts = static_cast<int_type>(m_s0.size());
+    if (hint < 0 || hint >= npts - 1) hint = 0;  // the list may have changed
+    // outside the hinted interval jump directly to the bin of s
+    real_type const * S = m_s0.data();
+    if ((s < S[hint] || s > S[hint + 1]) && m_s_index.valid_for(npts, S)) {
+      real_type ss = s;
+      if (m_curve_is_closed) wrap_in_range(ss);
+      hint = m_s_index.guess(ss, S);
+    }
+    Utils::search_interval<int_type, real_type>(npts, &m_s0.front(), s, hint, m_curve_is_closed, true);
+    return hint;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -159,7 +307,9 @@ namespace G2lib {
   void ClothoidList::init() {
     m_s0.clear();
     m_clotoidList.clear();
+    m_soa.clear();
     this->resetLastInterval();
+    m_s_index.clear();
     m_aabb_done = false;
     this->resetLastInterval();
   }
@@ -168,10 +318,38 @@ namespace G2lib {
 
   void ClothoidList::copy(ClothoidList const & L) {
     this->init();
+    m_curve_is_closed = L.m_curve_is_closed;
     m_clotoidList.reserve(L.m_clotoidList.size());
     std::copy(L.m_clotoidList.begin(), L.m_clotoidList.end(), back_inserter(m_clotoidList));
     m_s0.reserve(L.m_s0.size());
     std::copy(L.m_s0.begin(), L.m_s0.end(), back_inserter(m_s0));
+    m_soa     = L.m_soa;
+    m_s_index = L.m_s_index;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::move_from(ClothoidList & L) noexcept {
+    if (this == &L) return;
+    m_curve_is_closed = L.m_curve_is_closed;
+    m_s0              = std::move(L.m_s0);
+    m_clotoidList     = std::move(L.m_clotoidList);
+    m_soa             = std::move(L.m_soa);
+    m_s_index         = std::move(L.m_s_index);
+    m_aabb_done       = L.m_aabb_done;
+    if (m_aabb_done) {
+      m_aabb_offs      = L.m_aabb_offs;
+      m_aabb_max_angle = L.m_aabb_max_angle;
+      m_aabb_max_size  = L.m_aabb_max_size;
+    }
+    m_aabb_tree = std::move(L.m_aabb_tree);
+    m_aabb_tri  = std::move(L.m_aabb_tri);
+    // the hints of this list may be out of range, findAtS resets them
+    L.m_s0.clear();
+    L.m_clotoidList.clear();
+    L.m_soa.clear();
+    L.m_s_index.clear();
+    L.m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -179,48 +357,73 @@ namespace G2lib {
   void ClothoidList::reserve(int_type n) {
     m_s0.reserve(size_t(n + 1));
     m_clotoidList.reserve(size_t(n));
+    m_soa.reserve(size_t(n));
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::soa_push_back(size_t first) {
+    m_soa.resize(first);
+    for (size_t i = first; i < m_clotoidList.size(); ++i) m_soa.push_back(m_clotoidList[i]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(LineSegment const & LS) {
+    size_t n0 = m_clotoidList.size();
     if (m_clotoidList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(LS.length());
     } else {
       m_s0.push_back(m_s0.back() + LS.length());
     }
-    m_clotoidList.push_back(ClothoidCurve(LS));
+    m_clotoidList.emplace_back(ClothoidCurve(LS));
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(CircleArc const & C) {
+    size_t n0 = m_clotoidList.size();
     if (m_clotoidList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(C.length());
     } else {
       m_s0.push_back(m_s0.back() + C.length());
     }
-    m_clotoidList.push_back(ClothoidCurve(C));
+    m_clotoidList.emplace_back(ClothoidCurve(C));
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(Biarc const & c) {
+    size_t n0 = m_clotoidList.size();
     if (m_clotoidList.empty())
       m_s0.push_back(0);
     CircleArc const & C0 = c.C0();
     CircleArc const & C1 = c.C1();
     m_s0.push_back(m_s0.back() + C0.length());
     m_s0.push_back(m_s0.back() + C1.length());
-    m_clotoidList.push_back(ClothoidCurve(C0));
-    m_clotoidList.push_back(ClothoidCurve(C1));
+    m_clotoidList.emplace_back(ClothoidCurve(C0));
+    m_clotoidList.emplace_back(ClothoidCurve(C1));
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  void ClothoidList::push_back(ClothoidCurve const & c) {
+  void ClothoidList::push_back(ClothoidCurve const & c) { push_back_segment(ClothoidSegment(c)); }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::push_back_segment(ClothoidSegment const & c) {
+    size_t n0 = m_clotoidList.size();
     if (m_clotoidList.empty()) {
       m_s0.push_back(0);
       m_s0.push_back(c.length());
@@ -228,29 +431,39 @@ namespace G2lib {
       m_s0.push_back(m_s0.back() + c.length());
     }
     m_clotoidList.push_back(c);
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(BiarcList const & c) {
-    m_s0.reserve(m_s0.size() + c.m_biarcList.size() + 1);
+    size_t n0 = m_clotoidList.size();
+    m_s0.reserve(m_s0.size() + 2 * c.m_biarcList.size() + 1);
     m_clotoidList.reserve(m_clotoidList.size() + 2 * c.m_biarcList.size());
 
     if (m_s0.empty())
       m_s0.push_back(0);
 
+    // two segments, and two breakpoints, for each biarc
     vector<Biarc>::const_iterator ip = c.m_biarcList.begin();
     for (; ip != c.m_biarcList.end(); ++ip) {
-      m_s0.push_back(m_s0.back() + ip->length());
       Biarc const & b = *ip;
-      m_clotoidList.push_back(ClothoidCurve(b.C0()));
-      m_clotoidList.push_back(ClothoidCurve(b.C1()));
+      m_s0.push_back(m_s0.back() + b.C0().length());
+      m_s0.push_back(m_s0.back() + b.C1().length());
+      m_clotoidList.emplace_back(ClothoidCurve(b.C0()));
+      m_clotoidList.emplace_back(ClothoidCurve(b.C1()));
     }
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(PolyLine const & c) {
+    size_t n0 = m_clotoidList.size();
     m_s0.reserve(m_s0.size() + c.m_polylineList.size() + 1);
     m_clotoidList.reserve(m_clotoidList.size() + c.m_polylineList.size());
 
@@ -260,24 +473,31 @@ namespace G2lib {
     vector<LineSegment>::const_iterator ip = c.m_polylineList.begin();
     for (; ip != c.m_polylineList.end(); ++ip) {
       m_s0.push_back(m_s0.back() + ip->length());
-      m_clotoidList.push_back(ClothoidCurve(*ip));
+      m_clotoidList.emplace_back(ClothoidCurve(*ip));
     }
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::push_back(ClothoidList const & c) {
+    size_t n0 = m_clotoidList.size();
     m_s0.reserve(m_s0.size() + c.m_clotoidList.size() + 1);
     m_clotoidList.reserve(m_clotoidList.size() + c.m_clotoidList.size());
 
     if (m_s0.empty())
       m_s0.push_back(0);
 
-    vector<ClothoidCurve>::const_iterator ip = c.m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ip = c.m_clotoidList.begin();
     for (; ip != c.m_clotoidList.end(); ++ip) {
       m_s0.push_back(m_s0.back() + ip->length());
       m_clotoidList.push_back(*ip);
     }
+    this->soa_push_back(n0);
+    this->aabb_push_back(n0);
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -324,17 +544,11 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool ClothoidList::build_G1(int_type n, real_type const * x, real_type const * y) {
-    init();
-    reserve(n - 1);
-    ClothoidCurve c;
-
     G2LIB_UTILS_ASSERT0(n > 1, "ClothoidList::build_G1, at least 2 points are necessary\n");
 
+    vector<real_type> theta(static_cast<size_t>(n));
     if (n == 2) {
-      real_type theta = atan2(y[1] - y[0], x[1] - x[0]);
-      c.build_G1(x[0], y[0], theta, x[1], y[1], theta);
-      push_back(c);
-
+      theta[0] = theta[1] = atan2(y[1] - y[0], x[1] - x[0]);
     } else {
       Biarc     b;
       bool      ok, ciclic = hypot(x[0] - x[n - 1], y[0] - y[n - 1]) < 1e-10;
@@ -346,24 +560,16 @@ namespace G2lib {
       }
       ok = b.build_3P(x[0], y[0], x[1], y[1], x[2], y[2]);
       G2LIB_UTILS_ASSERT0(ok, "ClothoidList::build_G1, failed\n");
-      real_type theta0 = ciclic ? thetaC : b.theta_begin();
-      real_type theta1 = b.theta_middle();
-      c.build_G1(x[0], y[0], theta0, x[1], y[1], theta1);
-      push_back(c);
+      theta[0] = ciclic ? thetaC : b.theta_begin();
+      theta[1] = b.theta_middle();
       for (int_type k = 2; k < n - 1; ++k) {
-        theta0 = theta1;
-        ok     = b.build_3P(x[k - 1], y[k - 1], x[k], y[k], x[k + 1], y[k + 1]);
+        ok = b.build_3P(x[k - 1], y[k - 1], x[k], y[k], x[k + 1], y[k + 1]);
         G2LIB_UTILS_ASSERT0(ok, "ClothoidList::build_G1, failed\n");
-        theta1 = b.theta_middle();
-        c.build_G1(x[k - 1], y[k - 1], theta0, x[k], y[k], theta1);
-        push_back(c);
+        theta[size_t(k)] = b.theta_middle();
       }
-      theta0 = theta1;
-      theta1 = ciclic ? thetaC : b.theta_end();
-      c.build_G1(x[n - 2], y[n - 2], theta0, x[n - 1], y[n - 1], theta1);
-      push_back(c);
+      theta[size_t(n - 1)] = ciclic ? thetaC : b.theta_end();
     }
-    return true;
+    return this->build_G1(n, x, y, theta.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -371,13 +577,22 @@ namespace G2lib {
   bool ClothoidList::build_G1(int_type n, real_type const * x, real_type const * y, real_type const * theta) {
     G2LIB_UTILS_ASSERT0(n > 1, "ClothoidList::build_G1, at least 2 points are necessary\n");
 
+    // solve all the hermite problems at once
+    size_t            ns = size_t(n - 1);
+    vector<real_type> work(3 * ns);
+    real_type *       L  = work.data();
+    real_type *       k  = L + ns;
+    real_type *       dk = k + ns;
+    build_G1_batch(n - 1, x, y, theta, x + 1, y + 1, theta + 1, 1e-12, L, k, dk);
+
     init();
     reserve(n - 1);
     ClothoidCurve c;
-    for (int_type k = 1; k < n; ++k) {
-      c.build_G1(x[k - 1], y[k - 1], theta[k - 1], x[k], y[k], theta[k]);
+    for (size_t i = 0; i < ns; ++i) {
+      c.build(x[i], y[i], theta[i], k[i], dk[i], L[i]);
       push_back(c);
     }
+    this->build_s_index();
     return true;
   }
 
@@ -414,6 +629,7 @@ namespace G2lib {
           i, L, k, dk);
       push_back(k, dk, L);
     }
+    this->build_s_index();
     return true;
   }
 
@@ -440,22 +656,23 @@ namespace G2lib {
       real_type L  = pa[1] - pa[0];
       push_back(*px, *py, *pt, *pk, dk, L);
     }
+    this->build_s_index();
     return true;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  ClothoidCurve const & ClothoidList::get(int_type idx) const {
+  ClothoidCurve ClothoidList::get(int_type idx) const {
     G2LIB_UTILS_ASSERT(!m_clotoidList.empty(), "ClothoidList::get( %d ) empty list\n", idx);
     G2LIB_UTILS_ASSERT(
         idx >= 0 && idx < int_type(m_clotoidList.size()), "ClothoidList::get( %d ) bad index, must be in [0,%d]\n", idx,
         m_clotoidList.size() - 1);
-    return m_clotoidList[idx];
+    return m_clotoidList[size_t(idx)].curve();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  ClothoidCurve const & ClothoidList::getAtS(real_type s) const {
+  ClothoidCurve ClothoidList::getAtS(real_type s) const {
     int_type idx = this->findAtS(s);
     return get(idx);
   }
@@ -476,21 +693,25 @@ namespace G2lib {
   }
 
   real_type ClothoidList::length_ISO(real_type offs) const {
-    real_type                             L  = 0;
-    vector<ClothoidCurve>::const_iterator is = m_clotoidList.begin();
+    real_type                               L  = 0;
+    vector<ClothoidSegment>::const_iterator is = m_clotoidList.begin();
     for (; is != m_clotoidList.end(); ++is)
       L += is->length_ISO(offs);
     return L;
   }
 
   real_type ClothoidList::segment_length(int_type nseg) const {
-    ClothoidCurve const & c = get(nseg);
-    return c.length();
+    G2LIB_UTILS_ASSERT(
+        nseg >= 0 && nseg < int_type(m_clotoidList.size()),
+        "ClothoidList::segment_length( %d ) bad index, must be in [0,%d]\n", nseg, m_clotoidList.size() - 1);
+    return m_clotoidList[size_t(nseg)].length();
   }
 
   real_type ClothoidList::segment_length_ISO(int_type nseg, real_type offs) const {
-    ClothoidCurve const & c = get(nseg);
-    return c.length_ISO(offs);
+    G2LIB_UTILS_ASSERT(
+        nseg >= 0 && nseg < int_type(m_clotoidList.size()),
+        "ClothoidList::segment_length_ISO( %d ) bad index, must be in [0,%d]\n", nseg, m_clotoidList.size() - 1);
+    return m_clotoidList[size_t(nseg)].length_ISO(offs);
   }
 
   /*\
@@ -503,18 +724,18 @@ namespace G2lib {
 
   void ClothoidList::bbTriangles(
       vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
     for (int_type ipos = icurve; ic != m_clotoidList.end(); ++ic, ++ipos)
-      ic->bbTriangles(tvec, max_angle, max_size, ipos);
+      ic->curve().bbTriangles(tvec, max_angle, max_size, ipos);
   }
 
   // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
   void ClothoidList::bbTriangles_ISO(
       real_type offs, vector<Triangle2D> & tvec, real_type max_angle, real_type max_size, int_type icurve) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
     for (int_type ipos = icurve; ic != m_clotoidList.end(); ++ic, ++ipos)
-      ic->bbTriangles_ISO(offs, tvec, max_angle, max_size, ipos);
+      ic->curve().bbTriangles_ISO(offs, tvec, max_angle, max_size, ipos);
   }
 
   /*\
@@ -571,32 +792,32 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::theta(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.theta(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.theta_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.theta_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::theta_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.theta_DDD(s - m_s0[idx]);
   }
 
@@ -609,104 +830,104 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::tx(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tx(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.ty(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tx_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.ty_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tx_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.ty_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::tx_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tx_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::ty_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.ty_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg(real_type s, real_type & tg_x, real_type & tg_y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tg(s - m_s0[idx], tg_x, tg_y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_D(real_type s, real_type & tg_x_D, real_type & tg_y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tg_D(s - m_s0[idx], tg_x_D, tg_y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_DD(real_type s, real_type & tg_x_DD, real_type & tg_y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tg_DD(s - m_s0[idx], tg_x_DD, tg_y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::tg_DDD(real_type s, real_type & tg_x_DDD, real_type & tg_y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.tg_DDD(s - m_s0[idx], tg_x_DDD, tg_y_DDD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::evaluate(real_type s, real_type & th, real_type & k, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     c.evaluate(s - m_s0[idx], th, k, x, y);
   }
 
@@ -714,104 +935,327 @@ namespace G2lib {
 
   void ClothoidList::evaluate_ISO(
       real_type s, real_type offs, real_type & th, real_type & k, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     c.evaluate_ISO(s - m_s0[idx], offs, th, k, x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void ClothoidList::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
+    c.evaluate_jet(s - m_s0[idx], offs, J);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type ClothoidList::sample_uniform(
+      real_type   ds,
+      real_type * x,
+      real_type * y,
+      real_type * theta,
+      real_type * kappa) const {
+    G2LIB_UTILS_ASSERT(ds > 0, "ClothoidList::sample_uniform( ds = %g, ...) expected ds > 0\n", ds);
+    if (m_clotoidList.empty()) return 0;
+    int_type const  n    = sample_uniform_size(ds);
+    int_type const  nseg = num_segments();
+    real_type const s0   = m_s0.front();
+    int_type        j    = 0;
+    for (int_type i = 0; i < nseg && j < n; ++i) {
+      // samples j...jend-1 fall in segment i, i.e. s0 + j*ds < m_s0[i+1]
+      int_type jend = n;
+      if (i + 1 < nseg) jend = std::clamp(int_type(ceil((m_s0[size_t(i + 1)] - s0) / ds)), j, n);
+      if (jend == j) continue;
+      m_clotoidList[size_t(i)].CD.sample_uniform(
+          s0 + j * ds - m_s0[size_t(i)],
+          ds,
+          jend - j,
+          x + j,
+          y + j,
+          theta == nullptr ? nullptr : theta + j,
+          kappa == nullptr ? nullptr : kappa + j);
+      j = jend;
+    }
+    return n;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // Fresnel arguments of the points `j < m` lying on the segments `seg[j]`
+  // at the local abscissae `ss[j]`, plus the angle and the curvature
+  //
+  static void eval_batch_args(
+      ClothoidSegmentArrays const & P,
+      int_type                      m,
+      int_type const *              seg,
+      real_type const *             ss,
+      real_type *                   a,
+      real_type *                   b,
+      real_type *                   c,
+      real_type *                   th,
+      real_type *                   kp) {
+    int_type j = 0;
+#if G2LIB_SIMD_WIDTH > 1
+    using Simd::vreal;
+    for (; j + Simd::width <= m; j += Simd::width) {
+      vreal s  = Simd::load(ss + j);
+      vreal k0 = Simd::gather(P.kappa0.data(), seg + j);
+      vreal dk = Simd::gather(P.dk.data(), seg + j);
+      vreal t0 = Simd::gather(P.theta0.data(), seg + j);
+      Simd::store(a + j, dk * s * s);
+      Simd::store(b + j, k0 * s);
+      Simd::store(c + j, t0);
+      Simd::store(th + j, t0 + s * (k0 + vreal(0.5) * s * dk));
+      Simd::store(kp + j, k0 + s * dk);
+    }
+#endif
+    for (; j < m; ++j) {
+      size_t    i  = size_t(seg[j]);
+      real_type s  = ss[j];
+      real_type k0 = P.kappa0[i];
+      real_type dk = P.dk[i];
+      a[j]         = dk * s * s;
+      b[j]         = k0 * s;
+      c[j]         = P.theta0[i];
+      th[j]        = c[j] + s * (k0 + 0.5 * s * dk);
+      kp[j]        = k0 + s * dk;
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //
+  // positions of the points `j < m` from the Fresnel integrals `C`, `S`,
+  // moved by `offs` along the normal, the curvature is scaled in place
+  //
+  static void eval_batch_positions(
+      ClothoidSegmentArrays const & P,
+      int_type                      m,
+      int_type const *              seg,
+      real_type const *             ss,
+      real_type const *             C,
+      real_type const *             S,
+      real_type const *             th,
+      real_type *                   kp,
+      real_type                     offs,
+      real_type *                   x,
+      real_type *                   y) {
+    int_type j = 0;
+#if G2LIB_SIMD_WIDTH > 1
+    using Simd::vreal;
+    for (; j + Simd::width <= m; j += Simd::width) {
+      vreal s  = Simd::load(ss + j);
+      vreal xx = Simd::fma(s, Simd::load(C + j), Simd::gather(P.x0.data(), seg + j));
+      vreal yy = Simd::fma(s, Simd::load(S + j), Simd::gather(P.y0.data(), seg + j));
+      if (offs != 0) {
+        vreal sn, cs, k = Simd::load(kp + j);
+        Simd::sincos(Simd::load(th + j), sn, cs);
+        xx = xx - vreal(offs) * sn;
+        yy = yy + vreal(offs) * cs;
+        Simd::store(kp + j, k / (vreal(1.0) + vreal(offs) * k));
+      }
+      Simd::store(x + j, xx);
+      Simd::store(y + j, yy);
+    }
+#endif
+    for (; j < m; ++j) {
+      size_t i = size_t(seg[j]);
+      x[j]     = P.x0[i] + ss[j] * C[j];
+      y[j]     = P.y0[i] + ss[j] * S[j];
+      if (offs != 0) {
+        x[j] -= offs * sin(th[j]);
+        y[j] += offs * cos(th[j]);
+        kp[j] /= 1 + offs * kp[j];
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_batch_range(
+      int_type          i0,
+      int_type          i1,
+      real_type const * s,
+      bool              sorted,
+      real_type         offs,
+      real_type *       x,
+      real_type *       y,
+      real_type *       theta,
+      real_type *       kappa) const {
+    if (i0 >= i1) return;
+
+    // the points are processed in blocks: the segments are located with the
+    // scalar search, the rest of the evaluation runs on the vector kernels
+    int_type const block = 256;
+    int_type       seg[block];
+    real_type      ss[block], a[block], b[block], c[block], C[block], S[block], th[block], kp[block];
+
+    // in the sorted case the chunk starts at the segment of s[i0] and then
+    // moves forward only, points beyond the ends extend the first/last segment
+    int_type nseg = num_segments();
+    int_type iseg = 0;
+    if (sorted) iseg = int_type(std::upper_bound(m_s0.begin() + 1, m_s0.end() - 1, s[i0]) - (m_s0.begin() + 1));
+
+    for (int_type k0 = i0; k0 < i1; k0 += block) {
+      int_type m = std::min(block, i1 - k0);
+      for (int_type j = 0; j < m; ++j) {
+        real_type si = s[k0 + j];
+        if (sorted)
+          while (iseg < nseg - 1 && si >= m_s0[size_t(iseg + 1)]) ++iseg;
+        else
+          iseg = findAtS(si, iseg);
+        seg[j] = iseg;
+        ss[j]  = si - m_s0[size_t(iseg)];
+      }
+      eval_batch_args(m_soa, m, seg, ss, a, b, c, th, kp);
+      GeneralizedFresnelCS(m, 1, a, b, c, C, S);
+      eval_batch_positions(m_soa, m, seg, ss, C, S, th, kp, offs, x + k0, y + k0);
+      if (theta != nullptr) std::copy(th, th + m, theta + k0);
+      if (kappa != nullptr) std::copy(kp, kp + m, kappa + k0);
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_batch(
+      int_type          n,
+      real_type const * s,
+      real_type *       x,
+      real_type *       y,
+      real_type *       theta,
+      real_type *       kappa,
+      int_type          n_threads) const {
+    eval_batch_ISO(n, s, 0, x, y, theta, kappa, n_threads);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::eval_batch_ISO(
+      int_type          n,
+      real_type const * s,
+      real_type         offs,
+      real_type *       x,
+      real_type *       y,
+      real_type *       theta,
+      real_type *       kappa,
+      int_type          n_threads) const {
+    G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::eval_batch, empty list\n");
+    G2LIB_UTILS_ASSERT(
+        m_soa.size() == m_clotoidList.size(), "ClothoidList::eval_batch, %d segments but %d parameter sets\n",
+        int_type(m_clotoidList.size()), int_type(m_soa.size()));
+    if (n <= 0) return;
+
+    // closed curves wrap s, the walk is used only inside one period
+    bool sorted = true;
+    for (int_type i = 1; i < n && sorted; ++i) sorted = s[i - 1] <= s[i];
+    if (sorted && m_curve_is_closed) sorted = s[0] >= m_s0.front() && s[n - 1] <= m_s0.back();
+
+    // one contiguous chunk of at least min_chunk points per worker, otherwise
+    // the thread start-up dominates
+    int_type const min_chunk = 4096;
+    int_type const nt        = Utils::num_workers(n, n_threads, min_chunk);
+    Utils::parallel_for(nt, nt, [&](int_type t) {
+      int_type i0 = int_type((int64_t(n) * t) / nt);
+      int_type i1 = int_type((int64_t(n) * (t + 1)) / nt);
+      eval_batch_range(i0, i1, s, sorted, offs, x, y, theta, kappa);
+    });
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   real_type ClothoidList::X(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_D(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_D(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_DD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_DD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_DDD(real_type s) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_DDD(s - m_s0[idx]);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval(real_type s, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval(s - m_s0[idx], x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_D(real_type s, real_type & x_D, real_type & y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_D(s - m_s0[idx], x_D, y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_DD(real_type s, real_type & x_DD, real_type & y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_DD(s - m_s0[idx], x_DD, y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_DDD(real_type s, real_type & x_DDD, real_type & y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_DDD(s - m_s0[idx], x_DDD, y_DDD);
   }
 
@@ -824,96 +1268,96 @@ namespace G2lib {
   \*/
 
   real_type ClothoidList::X_ISO(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_ISO(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_ISO(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_D(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_ISO_D(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_D(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_ISO_D(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_DD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_ISO_DD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_DD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_ISO_DD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::X_ISO_DDD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.X_ISO_DDD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   real_type ClothoidList::Y_ISO_DDD(real_type s, real_type offs) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.Y_ISO_DDD(s - m_s0[idx], offs);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_ISO(s - m_s0[idx], offs, x, y);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_D(real_type s, real_type offs, real_type & x_D, real_type & y_D) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_ISO_D(s - m_s0[idx], offs, x_D, y_D);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_ISO_DD(s - m_s0[idx], offs, x_DD, y_DD);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
-    int_type              idx = findAtS(s);
-    ClothoidCurve const & c   = get(idx);
+    int_type                idx = findAtS(s);
+    ClothoidSegment const & c   = m_clotoidList[size_t(idx)];
     return c.eval_ISO_DDD(s - m_s0[idx], offs, x_DDD, y_DDD);
   }
 
@@ -926,26 +1370,38 @@ namespace G2lib {
   \*/
 
   void ClothoidList::translate(real_type tx, real_type ty) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::iterator ic = m_clotoidList.begin();
     for (; ic != m_clotoidList.end(); ++ic)
       ic->translate(tx, ty);
+    this->soa_push_back(0);
+    if (m_aabb_done) {
+      for (Triangle2D & T : m_aabb_tri)
+        T.translate(tx, ty);
+      this->aabb_refit();
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::rotate(real_type angle, real_type cx, real_type cy) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::iterator ic = m_clotoidList.begin();
     for (; ic != m_clotoidList.end(); ++ic)
       ic->rotate(angle, cx, cy);
+    this->soa_push_back(0);
+    if (m_aabb_done) {
+      for (Triangle2D & T : m_aabb_tri)
+        T.rotate(angle, cx, cy);
+      this->aabb_refit();
+    }
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::scale(real_type sfactor) {
-    vector<ClothoidCurve>::iterator ic    = m_clotoidList.begin();
-    real_type                       newx0 = ic->x_begin();
-    real_type                       newy0 = ic->y_begin();
-    m_s0[0]                               = 0;
+    vector<ClothoidSegment>::iterator ic    = m_clotoidList.begin();
+    real_type                         newx0 = ic->x_begin();
+    real_type                         newy0 = ic->y_begin();
+    m_s0[0]                                 = 0;
     for (size_t k = 0; ic != m_clotoidList.end(); ++ic, ++k) {
       ic->scale(sfactor);
       ic->change_origin(newx0, newy0);
@@ -953,13 +1409,16 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    this->soa_push_back(0);
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::reverse() {
     std::reverse(m_clotoidList.begin(), m_clotoidList.end());
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::iterator ic = m_clotoidList.begin();
     ic->reverse();
     real_type newx0 = ic->x_end();
     real_type newy0 = ic->y_end();
@@ -973,17 +1432,22 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    this->soa_push_back(0);
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::change_origin(real_type newx0, real_type newy0) {
-    vector<ClothoidCurve>::iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::iterator ic = m_clotoidList.begin();
     for (; ic != m_clotoidList.end(); ++ic) {
       ic->change_origin(newx0, newy0);
       newx0 = ic->x_end();
       newy0 = ic->y_end();
     }
+    this->soa_push_back(0);
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -991,7 +1455,9 @@ namespace G2lib {
   void ClothoidList::trim(real_type s_begin, real_type s_end) {
     ClothoidList newCL;
     this->trim(s_begin, s_end, newCL);
-    this->copy(newCL);
+    bool indexed = !m_s_index.empty();
+    *this        = std::move(newCL);
+    if (indexed) this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1017,39 +1483,42 @@ namespace G2lib {
     int_type i_begin = findAtS(s_begin);
     int_type i_end   = findAtS(s_end);
 
+    // no reallocation of the segment storage while appending
+    newCL.reserve(s_begin < s_end ? i_end - i_begin + 1 : n_seg - i_begin + i_end + 1);
+
     if (s_begin < s_end) {
       // get initial and final segment
       if (i_begin == i_end) {  // stesso segmento
-        real_type     ss0 = m_s0[i_begin];
-        ClothoidCurve C   = m_clotoidList[i_begin];
+        real_type       ss0 = m_s0[i_begin];
+        ClothoidSegment C   = m_clotoidList[i_begin];
         C.trim(s_begin - ss0, s_end - ss0);
-        newCL.push_back(C);
+        newCL.push_back_segment(C);
       } else {
-        ClothoidCurve C0 = m_clotoidList[i_begin];
+        ClothoidSegment C0 = m_clotoidList[i_begin];
         C0.trim(s_begin - m_s0[i_begin], C0.length());
-        newCL.push_back(C0);
+        newCL.push_back_segment(C0);
 
         for (++i_begin; i_begin < i_end; ++i_begin)
-          newCL.push_back(m_clotoidList[i_begin]);
+          newCL.push_back_segment(m_clotoidList[i_begin]);
 
-        ClothoidCurve C1 = m_clotoidList[i_end];
+        ClothoidSegment C1 = m_clotoidList[i_end];
         C1.trim(0, s_end - m_s0[i_end]);
-        newCL.push_back(C1);
+        newCL.push_back_segment(C1);
       }
     } else {
-      ClothoidCurve C0 = m_clotoidList[i_begin];
+      ClothoidSegment C0 = m_clotoidList[i_begin];
       C0.trim(s_begin - m_s0[i_begin], C0.length());
-      newCL.push_back(C0);
+      newCL.push_back_segment(C0);
 
       for (++i_begin; i_begin < n_seg; ++i_begin)
-        newCL.push_back(m_clotoidList[i_begin]);
+        newCL.push_back_segment(m_clotoidList[i_begin]);
 
       for (i_begin = 0; i_begin < i_end; ++i_begin)
-        newCL.push_back(m_clotoidList[i_begin]);
+        newCL.push_back_segment(m_clotoidList[i_begin]);
 
-      ClothoidCurve C1 = m_clotoidList[i_end];
+      ClothoidSegment C1 = m_clotoidList[i_end];
       C1.trim(0, s_end - m_s0[i_end]);
-      newCL.push_back(C1);
+      newCL.push_back_segment(C1);
     }
   }
 
@@ -1064,26 +1533,60 @@ namespace G2lib {
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
   void ClothoidList::build_AABBtree_ISO(real_type offs, real_type max_angle, real_type max_size) const {
     if (m_aabb_done && Utils::isZero(offs - m_aabb_offs) && Utils::isZero(max_angle - m_aabb_max_angle) &&
-        Utils::isZero(max_size - m_aabb_max_size))
+        Utils::isZero(max_size - m_aabb_max_size)) {
+      // collapse once the segments inserted by push_back
+      if (!m_aabb_tree.optimized())
+        m_aabb_tree.optimize();
       return;
+    }
 
-    vector<shared_ptr<BBox const>> bboxes;
-
+    m_aabb_tri.clear();
     bbTriangles_ISO(offs, m_aabb_tri, max_angle, max_size);
-    bboxes.reserve(m_aabb_tri.size());
+    // one allocation for all the boxes
+    BBoxPool                           pool(int_type(m_aabb_tri.size()));
     vector<Triangle2D>::const_iterator it;
     int_type                           ipos = 0;
     for (it = m_aabb_tri.begin(); it != m_aabb_tri.end(); ++it, ++ipos) {
       real_type xmin, ymin, xmax, ymax;
       it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos));
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos);
     }
-    m_aabb_tree.build(bboxes);
+    m_aabb_tree.build(pool);
     m_aabb_done      = true;
     m_aabb_offs      = offs;
     m_aabb_max_angle = max_angle;
     m_aabb_max_size  = max_size;
   }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::aabb_push_back(size_t first) {
+    if (!m_aabb_done)
+      return;
+    // the handle of a triangle in the tree is its position
+    size_t ntri = m_aabb_tri.size();
+    for (size_t i = first; i < m_clotoidList.size(); ++i)
+      m_clotoidList[i].curve().bbTriangles_ISO(m_aabb_offs, m_aabb_tri, m_aabb_max_angle, m_aabb_max_size, int_type(i));
+    BBoxPool pool(int_type(m_aabb_tri.size() - ntri));
+    for (size_t k = ntri; k < m_aabb_tri.size(); ++k) {
+      real_type xmin, ymin, xmax, ymax;
+      m_aabb_tri[k].bbox(xmin, ymin, xmax, ymax);
+      m_aabb_tree.insert(pool.get(pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, int_type(k))));
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::aabb_refit() {
+    BBoxPool pool(int_type(m_aabb_tri.size()));
+    int_type ipos = 0;
+    for (Triangle2D const & T : m_aabb_tri) {
+      real_type xmin, ymin, xmax, ymax;
+      T.bbox(xmin, ymin, xmax, ymax);
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_CLOTHOID, ipos++);
+    }
+    m_aabb_tree.refit(pool);
+  }
 #endif
 
   /*\
@@ -1100,7 +1603,7 @@ namespace G2lib {
     this->build_AABBtree_ISO(0);
     C.build_AABBtree_ISO(0);
     T2D_collision_list_ISO fun(this, 0, &C, 0);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    return m_aabb_tree.collision(C.m_aabb_tree, fun, false, intersect_num_threads);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1109,7 +1612,7 @@ namespace G2lib {
     this->build_AABBtree_ISO(offs);
     C.build_AABBtree_ISO(offs_C);
     T2D_collision_list_ISO fun(this, offs, &C, offs_C);
-    return m_aabb_tree.collision(C.m_aabb_tree, fun, false);
+    return m_aabb_tree.collision(C.m_aabb_tree, fun, false, intersect_num_threads);
   }
 
   /*\
@@ -1126,42 +1629,51 @@ namespace G2lib {
     if (intersect_with_AABBtree) {
       this->build_AABBtree_ISO(offs);
       CL.build_AABBtree_ISO(offs_CL);
-      AABBtree::VecPairPtrBBox iList;
-      m_aabb_tree.intersect(CL.m_aabb_tree, iList);
-
-      AABBtree::VecPairPtrBBox::const_iterator ip;
-      for (ip = iList.begin(); ip != iList.end(); ++ip) {
-        size_t ipos1 = size_t(ip->first->Ipos());
-        size_t ipos2 = size_t(ip->second->Ipos());
-
-        Triangle2D const & T1 = m_aabb_tri[ipos1];
-        Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
+      vector<pair<int_type, int_type>> iList;
+      m_aabb_tree.intersect(CL.m_aabb_tree, iList, false, intersect_num_threads);
+
+      // the candidate pairs are refined in blocks, possibly concurrently,
+      // and the intersections of the blocks are appended in order
+      int_type const        block = 64;
+      int_type              nblk  = int_type((iList.size() + block - 1) / block);
+      vector<IntersectList> found(static_cast<size_t>(nblk));
+      Utils::parallel_for(nblk, Utils::num_workers(nblk, intersect_num_threads, int_type(4)), [&](int_type b) {
+        size_t ip_end = std::min(iList.size(), size_t(b + 1) * block);
+        for (size_t ip = size_t(b) * block; ip < ip_end; ++ip) {
+          size_t ipos1 = size_t(iList[ip].first);
+          size_t ipos2 = size_t(iList[ip].second);
+
+          Triangle2D const & T1 = m_aabb_tri[ipos1];
+          Triangle2D const & T2 = CL.m_aabb_tri[ipos2];
+
+          ClothoidCurve const C1 = m_clotoidList[T1.Icurve()].curve();
+          ClothoidCurve const C2 = CL.m_clotoidList[T2.Icurve()].curve();
 
-        ClothoidCurve const & C1 = m_clotoidList[T1.Icurve()];
-        ClothoidCurve const & C2 = CL.m_clotoidList[T2.Icurve()];
-
-        real_type ss1, ss2;
-        bool      converged = C1.aabb_intersect_ISO(T1, offs, &C2, T2, offs_CL, ss1, ss2);
+          real_type ss1, ss2;
+          bool      converged = C1.aabb_intersect_ISO(T1, offs, &C2, T2, offs_CL, ss1, ss2);
 
-        if (converged) {
-          ss1 += m_s0[T1.Icurve()];
-          ss2 += CL.m_s0[T2.Icurve()];
-          if (swap_s_vals)
-            swap(ss1, ss2);
-          ilist.push_back(Ipair(ss1, ss2));
+          if (converged) {
+            ss1 += m_s0[T1.Icurve()];
+            ss2 += CL.m_s0[T2.Icurve()];
+            if (swap_s_vals)
+              swap(ss1, ss2);
+            found[size_t(b)].push_back(Ipair(ss1, ss2));
+          }
         }
-      }
+      });
+      for (IntersectList const & F : found) ilist.insert(ilist.end(), F.begin(), F.end());
     } else {
-      bbTriangles_ISO(offs, m_aabb_tri, Utils::m_pi / 18, 1e100);
-      CL.bbTriangles_ISO(offs_CL, CL.m_aabb_tri, Utils::m_pi / 18, 1e100);
+      vector<Triangle2D> tri1, tri2;
+      bbTriangles_ISO(offs, tri1, Utils::m_pi / 18, 1e100);
+      CL.bbTriangles_ISO(offs_CL, tri2, Utils::m_pi / 18, 1e100);
       vector<Triangle2D>::const_iterator i1, i2;
-      for (i1 = m_aabb_tri.begin(); i1 != m_aabb_tri.end(); ++i1) {
-        for (i2 = CL.m_aabb_tri.begin(); i2 != CL.m_aabb_tri.end(); ++i2) {
+      for (i1 = tri1.begin(); i1 != tri1.end(); ++i1) {
+        for (i2 = tri2.begin(); i2 != tri2.end(); ++i2) {
           Triangle2D const & T1 = *i1;
           Triangle2D const & T2 = *i2;
 
-          ClothoidCurve const & C1 = m_clotoidList[T1.Icurve()];
-          ClothoidCurve const & C2 = CL.m_clotoidList[T2.Icurve()];
+          ClothoidCurve const C1 = m_clotoidList[T1.Icurve()].curve();
+          ClothoidCurve const C2 = CL.m_clotoidList[T2.Icurve()].curve();
 
           real_type ss1, ss2;
           bool      converged = C1.aabb_intersect_ISO(T1, offs, &C2, T2, offs_CL, ss1, ss2);
@@ -1178,6 +1690,36 @@ namespace G2lib {
     }
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool ClothoidList::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    if (m_clotoidList.empty())
+      return false;
+    this->build_AABBtree_ISO(0);
+    // the ray as a straight clothoid clipped to the tree, a degenerate
+    // triangle carries the range of the ray inside the candidate box for
+    // the Newton iteration
+    real_type xmin, ymin, xmax, ymax;
+    m_aabb_tree.bbox(xmin, ymin, xmax, ymax);
+    ClothoidCurve ray(x, y, atan2(dy, dx), 0, 0, Utils::ray_reach(x, y, xmin, ymin, xmax, ymax, max_range));
+    bool          hit    = false;
+    auto          refine = [&](AABBtree::PtrBBox const & box, real_type tin, real_type tout) -> real_type {
+      Triangle2D const &    T1 = m_aabb_tri[size_t(box->Ipos())];
+      Triangle2D            T2(x, y, x, y, x, y, tin, tout, 0);
+      ClothoidCurve const   C1 = m_clotoidList[size_t(T1.Icurve())].curve();
+      real_type             ss1, ss2;
+      if (C1.aabb_intersect_ISO(T1, 0, &ray, T2, 0, ss1, ss2) && (!hit || ss2 < t)) {
+        hit = true;
+        s   = ss1 + m_s0[size_t(T1.Icurve())];
+        t   = ss2;
+      }
+      return hit ? t : max_range;
+    };
+    m_aabb_tree.raycast(x, y, dx, dy, max_range, refine);
+    return hit;
+  }
+
   /*\
    |      _ _     _
    |   __| (_)___| |_ __ _ _ __   ___ ___
@@ -1190,20 +1732,17 @@ namespace G2lib {
       real_type qx, real_type qy, real_type offs, real_type & x, real_type & y, real_type & s, real_type & DST) const {
     this->build_AABBtree_ISO(offs);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidList::closest_point_internal no candidate\n");
+    G2LIB_UTILS_ASSERT0(m_aabb_tree.num_bboxes() > 0, "ClothoidList::closest_point_internal no candidate\n");
     int_type icurve = 0;
     DST             = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
+    // visit the triangles nearest first, refining only while they can improve DST
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type) -> real_type {
+      Triangle2D const & T   = m_aabb_tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
       if (dst < DST) {
         // refine distance
         real_type xx, yy, ss;
-        m_clotoidList[T.Icurve()].closest_point_internal(T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
+        m_clotoidList[T.Icurve()].curve().closest_point_internal(T.S0(), T.S1(), qx, qy, offs, xx, yy, ss, dst);
         if (dst < DST) {
           DST    = dst;
           s      = ss + m_s0[T.Icurve()];
@@ -1212,7 +1751,9 @@ namespace G2lib {
           icurve = T.Icurve();
         }
       }
-    }
+      return DST;
+    };
+    m_aabb_tree.nearest(qx, qy, refine);
     return icurve;
   }
 
@@ -1257,28 +1798,93 @@ namespace G2lib {
   int_type ClothoidList::closest_segment(real_type qx, real_type qy) const {
     this->build_AABBtree_ISO(0);
 
-    AABBtree::VecPtrBBox candidateList;
-    m_aabb_tree.min_distance(qx, qy, candidateList);
-    AABBtree::VecPtrBBox::const_iterator ic;
-    G2LIB_UTILS_ASSERT0(candidateList.size() > 0, "ClothoidList::closest_segment no candidate\n");
+    G2LIB_UTILS_ASSERT0(m_aabb_tree.num_bboxes() > 0, "ClothoidList::closest_segment no candidate\n");
     int_type  icurve = 0;
     real_type DST    = numeric_limits<real_type>::infinity();
-    for (ic = candidateList.begin(); ic != candidateList.end(); ++ic) {
-      size_t             ipos = size_t((*ic)->Ipos());
-      Triangle2D const & T    = m_aabb_tri[ipos];
-      real_type          dst  = T.distMin(qx, qy);
+    // visit the triangles nearest first, refining only while they can improve DST
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type) -> real_type {
+      Triangle2D const & T   = m_aabb_tri[size_t(box->Ipos())];
+      real_type          dst = T.distMin(qx, qy);
       if (dst < DST) {
         // refine distance
         real_type xx, yy, ss;
-        m_clotoidList[T.Icurve()].closest_point_internal(T.S0(), T.S1(), qx, qy, 0, xx, yy, ss, dst);
+        m_clotoidList[T.Icurve()].curve().closest_point_internal(T.S0(), T.S1(), qx, qy, 0, xx, yy, ss, dst);
         if (dst < DST) {
           DST    = dst;
           icurve = T.Icurve();
         }
       }
-    }
+      return DST;
+    };
+    m_aabb_tree.nearest(qx, qy, refine);
     return icurve;
   }
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::triangle_ranges(
+      vector<int_type> & segments, vector<real_type> & s_begin, vector<real_type> & s_end) const {
+    // triangles are stored segment by segment, sorting the positions groups
+    // them by segment and the ranges are compacted in place
+    std::sort(segments.begin(), segments.end());
+    s_begin.clear();
+    s_end.clear();
+    size_t n = 0;
+    for (size_t k = 0; k < segments.size(); ++k) {
+      Triangle2D const & T  = m_aabb_tri[size_t(segments[k])];
+      int_type           ic = T.Icurve();
+      real_type          s0 = m_s0[size_t(ic)];
+      if (n > 0 && segments[n - 1] == ic) {
+        s_begin.back() = std::min(s_begin.back(), s0 + T.S0());
+        s_end.back()   = std::max(s_end.back(), s0 + T.S1());
+      } else {
+        segments[n++] = ic;
+        s_begin.push_back(s0 + T.S0());
+        s_end.push_back(s0 + T.S1());
+      }
+    }
+    segments.resize(n);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::segments_in_box(
+      real_type           xmin,
+      real_type           ymin,
+      real_type           xmax,
+      real_type           ymax,
+      vector<int_type> &  segments,
+      vector<real_type> & s_begin,
+      vector<real_type> & s_end) const {
+    this->build_AABBtree_ISO(0);
+    segments.clear();
+    auto fun = [&segments](AABBtree::PtrBBox const & box) -> bool {
+      segments.push_back(box->Ipos());
+      return false;
+    };
+    m_aabb_tree.query_box(xmin, ymin, xmax, ymax, fun);
+    triangle_ranges(segments, s_begin, s_end);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void ClothoidList::segments_in_radius(
+      real_type           x,
+      real_type           y,
+      real_type           r,
+      vector<int_type> &  segments,
+      vector<real_type> & s_begin,
+      vector<real_type> & s_end) const {
+    this->build_AABBtree_ISO(0);
+    segments.clear();
+    auto fun = [this, &segments, x, y, r](AABBtree::PtrBBox const & box) -> bool {
+      if (m_aabb_tri[size_t(box->Ipos())].distMin(x, y) <= r)
+        segments.push_back(box->Ipos());
+      return false;
+    };
+    m_aabb_tree.query_radius(x, y, r, fun);
+    triangle_ranges(segments, s_begin, s_end);
+  }
+
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
@@ -1297,7 +1903,7 @@ namespace G2lib {
     int_type nsegs = this->num_segments();
     if (nsegs == 1) {  // only 1 segment to check
       icurve       = 0;
-      int_type res = m_clotoidList.front().closest_point_ISO(qx, qy, x, y, s, t, dst);
+      int_type res = m_clotoidList.front().curve().closest_point_ISO(qx, qy, x, y, s, t, dst);
       s += m_s0[0];
       return res;
     }
@@ -1311,7 +1917,7 @@ namespace G2lib {
     G2LIB_UTILS_ASSERT(ib >= 0 && ie >= 0, "ClothoidList::closest_point_in_range_ISO, ib = %d ie = %d\n", ib, ie);
 
     icurve       = ib;
-    int_type res = m_clotoidList[icurve].closest_point_ISO(qx, qy, x, y, s, t, dst);
+    int_type res = m_clotoidList[icurve].curve().closest_point_ISO(qx, qy, x, y, s, t, dst);
     s += m_s0[icurve];
 
     if (ib == ie)
@@ -1322,7 +1928,7 @@ namespace G2lib {
       if (++iseg >= nsegs)
         iseg -= nsegs;  // next segment
       real_type C_x, C_y, C_s, C_t, C_dst;
-      int_type  C_res = m_clotoidList[iseg].closest_point_ISO(qx, qy, C_x, C_y, C_s, C_t, C_dst);
+      int_type  C_res = m_clotoidList[iseg].curve().closest_point_ISO(qx, qy, C_x, C_y, C_s, C_t, C_dst);
       if (C_dst < dst) {
         dst    = C_dst;
         x      = C_x;
@@ -1366,31 +1972,31 @@ namespace G2lib {
     int_type res     = 0;
     if (i_begin == i_end) {
       // stesso segmento
-      real_type     ss0 = m_s0[i_begin];
-      ClothoidCurve C   = m_clotoidList[i_begin];  // crea copia
-      C.trim(s_begin - ss0, s_end - ss0);
-      res = C.closest_point_ISO(qx, qy, x, y, s, t, dst);
+      real_type       ss0 = m_s0[i_begin];
+      ClothoidSegment seg = m_clotoidList[i_begin];
+      seg.trim(s_begin - ss0, s_end - ss0);
+      res = seg.curve().closest_point_ISO(qx, qy, x, y, s, t, dst);
       s += s_begin;
     } else {
       // segmenti consecutivi
       int_type  res1;
       real_type x1, y1, s1, t1, dst1;
 
-      real_type     ss0 = m_s0[i_begin];
-      real_type     ss1 = m_s0[i_end];
-      ClothoidCurve C0  = m_clotoidList[i_begin];  // crea copia
-      ClothoidCurve C1  = m_clotoidList[i_end];    // crea copia
+      real_type       ss0  = m_s0[i_begin];
+      real_type       ss1  = m_s0[i_end];
+      ClothoidSegment seg0 = m_clotoidList[i_begin];
+      ClothoidSegment seg1 = m_clotoidList[i_end];
 
       // taglia il segmento
-      C0.trim(s_begin - ss0, C0.length());
+      seg0.trim(s_begin - ss0, seg0.length());
 
       // calcolo closest point
-      res = C0.closest_point_ISO(qx, qy, x, y, s, t, dst);
+      res = seg0.curve().closest_point_ISO(qx, qy, x, y, s, t, dst);
       s += s_begin;
       icurve = i_begin;
 
-      C1.trim(0, s_end - ss1);
-      res1 = C1.closest_point_ISO(qx, qy, x1, y1, s1, t1, dst1);
+      seg1.trim(0, s_end - ss1);
+      res1 = seg1.curve().closest_point_ISO(qx, qy, x1, y1, s1, t1, dst1);
       s1 += ss1;
 
       if (dst1 < dst) {
@@ -1430,9 +2036,9 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getSK(real_type * s, real_type * kappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    real_type                             ss = 0;
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    int_type                                k  = 0;
+    real_type                               ss = 0;
     while (ic != m_clotoidList.end()) {
       s[k]     = ss;
       kappa[k] = ic->kappa_begin();
@@ -1451,9 +2057,9 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getSTK(real_type * s, real_type * theta, real_type * kappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
-    real_type                             ss = 0;
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    int_type                                k  = 0;
+    real_type                               ss = 0;
     while (ic != m_clotoidList.end()) {
       s[k]     = ss;
       theta[k] = ic->theta_begin();
@@ -1471,8 +2077,8 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getXY(real_type * x, real_type * y) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    int_type                                k  = 0;
     while (ic != m_clotoidList.end()) {
       x[k] = ic->x_begin();
       y[k] = ic->y_begin();
@@ -1487,8 +2093,8 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getDeltaTheta(real_type * deltaTheta) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    int_type                                k  = 0;
     for (++ic; ic != m_clotoidList.end(); ++ic, ++k) {
       real_type tmp = ic->theta_begin() - ic[-1].theta_end();
       if (tmp > Utils::m_pi)
@@ -1502,8 +2108,8 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::getDeltaKappa(real_type * deltaKappa) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    int_type                              k  = 0;
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    int_type                                k  = 0;
     for (++ic; ic != m_clotoidList.end(); ++ic, ++k)
       deltaKappa[k] = ic->kappa_begin() - ic[-1].kappa_end();
   }
@@ -1512,14 +2118,14 @@ namespace G2lib {
 
   int_type ClothoidList::findST1(real_type x, real_type y, real_type & s, real_type & t) const {
     G2LIB_UTILS_ASSERT0(!m_clotoidList.empty(), "ClothoidList::findST, empty list\n");
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
-    vector<real_type>::const_iterator     is = m_s0.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
+    vector<real_type>::const_iterator       is = m_s0.begin();
 
     s = t          = 0;
     int_type  ipos = 0;
     int_type  iseg = 0;
     real_type S, T;
-    bool      ok = ic->findST_ISO(x, y, S, T);
+    bool      ok = ic->curve().findST_ISO(x, y, S, T);
     if (ok) {
       s    = *is + S;
       t    = T;
@@ -1527,7 +2133,7 @@ namespace G2lib {
     }
 
     for (++ic, ++is, ++ipos; ic != m_clotoidList.end(); ++ic, ++is, ++ipos) {
-      bool ok1 = ic->findST_ISO(x, y, S, T);
+      bool ok1 = ic->curve().findST_ISO(x, y, S, T);
       if (ok && ok1)
         ok1 = abs(T) < abs(t);
       if (ok1) {
@@ -1554,9 +2160,9 @@ namespace G2lib {
     int_type iseg = 0;
     bool     ok   = false;
     for (int_type k = ibegin; k <= iend; ++k) {
-      ClothoidCurve const & ck = m_clotoidList[k];
-      real_type             S, T;
-      bool                  ok1 = ck.findST_ISO(x, y, S, T);
+      ClothoidCurve const ck = m_clotoidList[k].curve();
+      real_type           S, T;
+      bool                ok1 = ck.findST_ISO(x, y, S, T);
       if (ok && ok1)
         ok1 = abs(T) < abs(t);
       if (ok1) {
@@ -1573,7 +2179,7 @@ namespace G2lib {
 
   void ClothoidList::export_table(ostream_type & stream) const {
     stream << "x\ty\ttheta0\tkappa0\tdkappa\tL\n";
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
     for (; ic != m_clotoidList.end(); ++ic)
       stream << Utils::format_string("%f\t%f\t%f\t%f\t%f\t%f\n", 
         ic->x_begin(), ic->y_begin(), ic->theta_begin(), ic->kappa_begin(),
@@ -1584,7 +2190,7 @@ namespace G2lib {
 
   void ClothoidList::export_ruby(ostream_type & stream) const {
     stream << "data = {\n";
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
     for (; ic != m_clotoidList.end(); ++ic)
       stream << Utils::format_string("%f\t%f\t%f\t%f\t%f\t%f\n", 
           ic->x_begin(), ic->y_begin(), ic->theta_begin(), ic->kappa_begin(),
@@ -1595,9 +2201,9 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   ostream_type & operator<<(ostream_type & stream, ClothoidList const & CL) {
-    vector<ClothoidCurve>::const_iterator ic = CL.m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = CL.m_clotoidList.begin();
     for (; ic != CL.m_clotoidList.end(); ++ic)
-      stream << *ic << '\n';
+      stream << ic->curve() << '\n';
     return stream;
   }
 
@@ -1655,11 +2261,11 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void ClothoidList::save(ostream_type & stream) const {
-    vector<ClothoidCurve>::const_iterator ic = m_clotoidList.begin();
+    vector<ClothoidSegment>::const_iterator ic = m_clotoidList.begin();
     stream << "# x y theta kappa\n";
     for (int_type nseg = 1; ic != m_clotoidList.end(); ++ic, ++nseg) {
       stream << "# segment n." << nseg << '\n';
-      save_segment(stream, *ic);
+      save_segment(stream, ic->curve());
     }
     stream << "# EOF\n";
   }
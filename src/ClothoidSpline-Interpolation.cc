@@ -77,10 +77,7 @@ namespace G2lib {
       if (theta.size() < 2) {
         throw std::runtime_error("Result has only two values??");
       }
-      result.init();
-      result.reserve(static_cast<int_type>(theta.size()) - 1);
-      for (int_type i = 0; i < static_cast<int_type>(theta.size()) - 1; i++)
-        result.push_back_G1(xs()[i], ys()[i], theta[i], xs()[i + 1], ys()[i + 1], theta[i + 1]);
+      result.build_G1(static_cast<int_type>(theta.size()), xs().data(), ys().data(), theta.data());
     }
 
 #ifndef G2LIB_LMSOLVE_CLOTHOID_SPLINE
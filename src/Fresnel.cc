@@ -27,7 +27,9 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 #include "Clothoids/Fresnel.hxx"
 #include "Clothoids/Constants.hxx"
+#include "Clothoids/BaseCurve.hxx"
 #include "Utils.hxx"
+#include "SIMD.hxx"
 #include "PolynomialRoots.hh"
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -56,11 +58,14 @@
 
 #include <cmath>
 #include <cfloat>
+#include <limits>
 #include <algorithm>
+#include <vector>
 
 namespace G2lib {
 
   using std::abs;
+  using std::isfinite;
   using std::max;
   using std::min;
 
@@ -301,8 +306,194 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //
+  // Piecewise polynomial interpolant of C(x) and S(x) on [0, FRESNEL_TABLE_MAX)
+  // with intervals of width `h` and `N` coefficients per interval. The
+  // polynomials interpolate the exact routine at the Chebyshev nodes of each
+  // interval (computed once, on first use) and are stored in the monomial
+  // basis of the local variable u in [-1,1], so that they can be evaluated
+  // with a second order Horner scheme (short dependency chain).
+  //
+#define FRESNEL_TABLE_MAX 6.0
+
+  template <int_type N>
+  class FresnelTable {
+    real_type              m_h;
+    int_type               m_nint;
+    std::vector<real_type> m_cC;
+    std::vector<real_type> m_cS;
+
+    static void to_monomial(real_type const cheb[N], real_type * mono) {
+      // T_k(u) in the monomial basis with the usual three terms recurrence
+      real_type Tkm1[N] = { 1 }, Tk[N] = { 0, 1 }, Tkp1[N];
+      for (int_type j = 0; j < N; ++j) mono[j] = 0;
+      mono[0] = cheb[0];
+      if (N > 1) mono[1] += cheb[1];
+      for (int_type k = 2; k < N; ++k) {
+        for (int_type j = 0; j < N; ++j) Tkp1[j] = (j > 0 ? 2 * Tk[j - 1] : 0) - Tkm1[j];
+        for (int_type j = 0; j < N; ++j) {
+          mono[j] += cheb[k] * Tkp1[j];
+          Tkm1[j] = Tk[j];
+          Tk[j]   = Tkp1[j];
+        }
+      }
+    }
+
+    // second order Horner scheme: even and odd coefficients are two
+    // independent chains in u^2
+    static real_type horner2(real_type const * c, real_type u) {
+      real_type u2 = u * u;
+      real_type pe = c[(N - 1) & ~1];
+      real_type po = c[N - 1 - (N & 1)];
+      for (int_type j = ((N - 1) & ~1) - 2; j >= 0; j -= 2) pe = pe * u2 + c[j];
+      for (int_type j = N - 1 - (N & 1) - 2; j >= 1; j -= 2) po = po * u2 + c[j];
+      return pe + u * po;
+    }
+
+   public:
+    explicit FresnelTable(real_type h) : m_h(h), m_nint(int_type(FRESNEL_TABLE_MAX / h)) {
+      m_cC.resize(m_nint * N);
+      m_cS.resize(m_nint * N);
+      real_type fC[N], fS[N], cC[N], cS[N];
+      for (int_type i = 0; i < m_nint; ++i) {
+        real_type xm = (i + 0.5) * m_h;
+        for (int_type j = 0; j < N; ++j)
+          FresnelCS(xm + 0.5 * m_h * cos(Utils::m_pi * (j + 0.5) / N), fC[j], fS[j]);
+        for (int_type k = 0; k < N; ++k) {
+          real_type sC = 0, sS = 0;
+          for (int_type j = 0; j < N; ++j) {
+            real_type w = cos(Utils::m_pi * k * (j + 0.5) / N);
+            sC += fC[j] * w;
+            sS += fS[j] * w;
+          }
+          real_type scale = (k == 0 ? 1.0 : 2.0) / N;
+          cC[k]           = scale * sC;
+          cS[k]           = scale * sS;
+        }
+        to_monomial(cC, m_cC.data() + i * N);
+        to_monomial(cS, m_cS.data() + i * N);
+      }
+    }
+
+    // x must be in [0, FRESNEL_TABLE_MAX)
+    void eval(real_type x, real_type & C, real_type & S) const {
+      int_type  i = min(int_type(x / m_h), m_nint - 1);
+      real_type u = 2 * (x - (i + 0.5) * m_h) / m_h;
+      C           = horner2(m_cC.data() + i * N, u);
+      S           = horner2(m_cS.data() + i * N, u);
+    }
+  };
+
+#define FRESNEL_FAST_COEFFS 10
+#define FRESNEL_DRAFT_COEFFS 8
+
+  static void fresnel_table_eval(FresnelAccuracy acc, real_type x, real_type & C, real_type & S) {
+    if (acc == FresnelAccuracy::Fast) {
+      static FresnelTable<FRESNEL_FAST_COEFFS> const fast(1.0 / 16);
+      fast.eval(x, C, S);
+    } else {
+      static FresnelTable<FRESNEL_DRAFT_COEFFS> const draft(1.0 / 8);
+      draft.eval(x, C, S);
+    }
+  }
+
+  //
+  // evalXYaLarge subtracts two Fresnel integrals and divides the difference
+  // by z^k: the error of the tabulated tiers is amplified roughly by
+  // (1+|ell|)^(nk-1)/z^nk. When the amplification would exceed the bound of
+  // the tier the inner integrals are computed exactly.
+  //
+  static inline FresnelAccuracy inner_accuracy(FresnelAccuracy acc, int_type nk, real_type z, real_type ell) {
+    if (acc == FresnelAccuracy::Exact)
+      return acc;
+    real_type amp = 1 / z;
+    for (int_type k = 1; k < nk; ++k) amp *= (1 + abs(ell)) / z;
+    real_type const max_amp = acc == FresnelAccuracy::Fast ? 1e2 : 1e1;
+    return amp > max_amp ? FresnelAccuracy::Exact : acc;
+  }
+
+  //
+  // the a -> 0 expansion of the tiers is shorter and gives more weight to
+  // the last moments of evalXYazero, computed with the Lommel series, which
+  // loses digits as |b| grows: past |b| = 40 the tiers use the expansion of
+  // the exact evaluation
+  //
+  static inline FresnelAccuracy small_a_accuracy(FresnelAccuracy acc, real_type b) {
+    return abs(b) > 40 ? FresnelAccuracy::Exact : acc;
+  }
+
+  // number of terms of the a -> 0 expansion used by GeneralizedFresnelCS
+  static inline int_type serie_size(FresnelAccuracy acc) {
+    switch (acc) {
+      case FresnelAccuracy::Fast: return 2;
+      case FresnelAccuracy::Draft: return 1;
+      default: return A_SERIE_SIZE;
+    }
+  }
+
+  // relative truncation threshold of the Lommel series
+  static inline real_type lommel_tolerance(FresnelAccuracy acc) {
+    switch (acc) {
+      case FresnelAccuracy::Fast: return 1e-13;
+      case FresnelAccuracy::Draft: return 1e-9;
+      default: return 1e-50;
+    }
+  }
+#endif
+
+  //!
+  //! Compute Fresnel integrals C(x) and S(x) with the selected accuracy.
+  //!
+  //! - `FresnelAccuracy::Exact` is the routine above;
+  //! - `FresnelAccuracy::Fast` and `FresnelAccuracy::Draft` use a piecewise
+  //!   Chebyshev table for \f$ |x| < 6 \f$ and a truncated asymptotic
+  //!   expansion (4 and 2 terms) above, the error bounds are the ones of
+  //!   `FresnelAccuracy`.
+  //!
+  void FresnelCS(real_type y, real_type & C, real_type & S, FresnelAccuracy acc) {
+    if (acc == FresnelAccuracy::Exact) {
+      FresnelCS(y, C, S);
+      return;
+    }
+    real_type const x = y > 0 ? y : -y;
+    if (x < FRESNEL_TABLE_MAX) {
+      fresnel_table_eval(acc, x, C, S);
+    } else {
+      real_type const s = Utils::m_pi * x * x;
+      real_type const t = -1 / (s * s);
+      real_type       f, g;
+      if (acc == FresnelAccuracy::Fast) {
+        f = 1 + t * (3 + t * (105 + t * 10395));
+        g = 1 + t * (15 + t * (945 + t * 135135));
+      } else {
+        f = 1 + 3 * t;
+        g = 1 + 15 * t;
+      }
+      real_type px   = Utils::m_pi * x;
+      f             /= px;
+      g             /= px * px * x;
+      real_type U    = Utils::m_pi_2 * (x * x);
+      real_type SinU = sin(U);
+      real_type CosU = cos(U);
+      C              = 0.5 + f * SinU - g * CosU;
+      S              = 0.5 - f * CosU - g * SinU;
+    }
+    if (y < 0) {
+      C = -C;
+      S = -S;
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // -------------------------------------------------------------------------
+
   void FresnelCS(int_type nk, real_type t, real_type * C, real_type * S) {
-    FresnelCS(t, C[0], S[0]);
+    FresnelCS(nk, t, C, S, FresnelAccuracy::Exact);
+  }
+
+  void FresnelCS(int_type nk, real_type t, real_type * C, real_type * S, FresnelAccuracy acc) {
+    FresnelCS(t, C[0], S[0], acc);
     if (nk > 1) {
       real_type tt = Utils::m_pi_2 * (t * t);
       real_type ss = sin(tt);
@@ -319,8 +510,168 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
+#if G2LIB_SIMD_WIDTH > 1
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //
+  // Coefficients of the power series of C(x)/x and S(x)/(pi/2 x^3) in the
+  // variable t = -(pi/2 x^2)^2. With x < 1 twelve terms are enough to reach
+  // the 1E-15 threshold of the scalar version, so the loop becomes a Horner
+  // evaluation of fixed degree.
+  //
+  static const real_type series_C[] = { 1.0,
+                                        0.1,
+                                        0.004629629629629629,
+                                        0.00010683760683760684,
+                                        1.4589169000933706e-06,
+                                        1.3122532963802806e-08,
+                                        8.35070279514724e-11,
+                                        3.9554295164585257e-13,
+                                        1.4483264643598138e-15,
+                                        4.221407288807088e-18,
+                                        1.0025164934907719e-20,
+                                        1.977064753877905e-23 };
+
+  static const real_type series_S[] = { 0.3333333333333333,
+                                        0.023809523809523808,
+                                        0.0007575757575757576,
+                                        1.3227513227513228e-05,
+                                        1.4503852223150468e-07,
+                                        1.0892221037148573e-09,
+                                        5.9477940136376354e-12,
+                                        2.466827010264457e-14,
+                                        8.032735012415773e-17,
+                                        2.107855191442136e-19,
+                                        4.5518467589282e-22,
+                                        8.230149299214221e-25 };
+
+  //
+  // Coefficients of the asymptotic expansions of f and g in the variable
+  // t = -1/(pi x^2)^2. For x >= 6 the twelfth term is below 1E-16.
+  //
+  static const real_type asympt_f[] = { 1.0,
+                                        3.0,
+                                        105.0,
+                                        10395.0,
+                                        2027025.0,
+                                        654729075.0,
+                                        316234143225.0,
+                                        213458046676875.0,
+                                        1.9189878396251062e+17,
+                                        2.2164309547669976e+20,
+                                        3.1983098677287775e+23,
+                                        5.638620296805835e+26 };
+
+  static const real_type asympt_g[] = { 1.0,
+                                        15.0,
+                                        945.0,
+                                        135135.0,
+                                        34459425.0,
+                                        13749310575.0,
+                                        7905853580625.0,
+                                        6190283353629375.0,
+                                        6.33265987076285e+18,
+                                        8.200794532637892e+21,
+                                        1.3113070457687988e+25,
+                                        2.5373791335626256e+28 };
+
+  //
+  // One register of FresnelCS(nk, ...). The three regimes of the scalar version
+  // are evaluated under lane masks, a regime is skipped when none of the lanes
+  // falls inside it.
+  //
+  static void FresnelCS_simd(int_type nk, Simd::vreal const & y, Simd::vreal * C, Simd::vreal * S) {
+    using Simd::vreal;
+    using Simd::vmask;
+
+    vreal const x  = Simd::abs(y);
+    vreal const x2 = x * x;
+    vmask const is_series = x < vreal(1.0);
+    vmask const is_asympt = x >= vreal(6.0);
+
+    C[0] = vreal(0.0);
+    S[0] = vreal(0.0);
+
+    if (Simd::any(is_series)) {
+      vreal s = vreal(Utils::m_pi_2) * x2;
+      vreal t = -(s * s);
+      C[0]    = x * Simd::horner(series_C, t);
+      S[0]    = vreal(Utils::m_pi_2) * Simd::horner(series_S, t) * (x2 * x);
+    }
+
+    if (nk > 1 || !Simd::all(is_series)) {
+      // U = pi/2 x^2, reduced on x^2 split in its high and low parts
+      vreal SinU, CosU;
+      Simd::sincos_pi_2(x2, Simd::fma(x, x, -x2), SinU, CosU);
+
+      if (!Simd::all(is_series)) {
+        vreal       f(0.0), g(0.0);
+        vmask const is_rational = !(is_series | is_asympt);
+        if (Simd::any(is_rational)) {
+          f = Simd::horner(fn, x) / Simd::horner(fd, x);
+          g = Simd::horner(gn, x) / Simd::horner(gd, x);
+        }
+        if (Simd::any(is_asympt)) {
+          vreal s  = vreal(Utils::m_pi) * x2;
+          vreal t  = vreal(-1.0) / (s * s);
+          vreal px = vreal(Utils::m_pi) * x;
+          f        = Simd::select(is_asympt, Simd::horner(asympt_f, t) / px, f);
+          g        = Simd::select(is_asympt, Simd::horner(asympt_g, t) / (px * px * x), g);
+        }
+        vmask const is_large = !is_series;
+        C[0] = Simd::select(is_large, vreal(0.5) + f * SinU - g * CosU, C[0]);
+        S[0] = Simd::select(is_large, vreal(0.5) - f * CosU - g * SinU, S[0]);
+      }
+
+      vmask const neg = y < vreal(0.0);
+      C[0] = Simd::select(neg, -C[0], C[0]);
+      S[0] = Simd::select(neg, -S[0], S[0]);
+
+      if (nk > 1) {
+        C[1] = SinU * vreal(Utils::m_1_pi);
+        S[1] = (vreal(1.0) - CosU) * vreal(Utils::m_1_pi);
+        if (nk > 2) {
+          C[2] = (y * SinU - S[0]) * vreal(Utils::m_1_pi);
+          S[2] = (C[0] - y * CosU) * vreal(Utils::m_1_pi);
+        }
+      }
+    } else {
+      vmask const neg = y < vreal(0.0);
+      C[0] = Simd::select(neg, -C[0], C[0]);
+      S[0] = Simd::select(neg, -S[0], S[0]);
+    }
+  }
+#endif
+#endif
+
+  //!
+  //! Compute Fresnel integrals C(x) and S(x) for an array of arguments.
+  //! When the library is compiled for AVX2 or AVX-512 the arguments are
+  //! processed in vector registers, the remaining tail (and the whole array
+  //! on other targets) is evaluated with the scalar version.
+  //!
+  //! \param[in]  n number of arguments
+  //! \param[in]  x arguments, `n` values
+  //! \param[out] C \f$ C(x_i) \f$, `n` values
+  //! \param[out] S \f$ S(x_i) \f$, `n` values
+  //!
+  void FresnelCS_batch(int_type n, real_type const * x, real_type * C, real_type * S) {
+    int_type i = 0;
+#if G2LIB_SIMD_WIDTH > 1
+    for (; i + Simd::width <= n; i += Simd::width) {
+      Simd::vreal vC, vS;
+      FresnelCS_simd(1, Simd::load(x + i), &vC, &vS);
+      Simd::store(C + i, vC);
+      Simd::store(S + i, vS);
+    }
+#endif
+    for (; i < n; ++i) FresnelCS(x[i], C[i], S[i]);
+  }
+
+  // -------------------------------------------------------------------------
+  // -------------------------------------------------------------------------
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-  static void evalXYaLarge(real_type a, real_type b, real_type & X, real_type & Y) {
+  static void evalXYaLarge(real_type a, real_type b, real_type & X, real_type & Y, FresnelAccuracy acc) {
     real_type s    = a > 0 ? +1 : -1;
     real_type absa = abs(a);
     real_type z    = Utils::m_1_sqrt_pi * sqrt(absa);
@@ -330,8 +681,9 @@ namespace G2lib {
     real_type sg   = sin(g) / z;
 
     real_type Cl, Sl, Cz, Sz;
-    FresnelCS(ell, Cl, Sl);
-    FresnelCS(ell + z, Cz, Sz);
+    acc = inner_accuracy(acc, 1, z, ell);
+    FresnelCS(ell, Cl, Sl, acc);
+    FresnelCS(ell + z, Cz, Sz, acc);
 
     real_type dC0 = Cz - Cl;
     real_type dS0 = Sz - Sl;
@@ -342,7 +694,7 @@ namespace G2lib {
 
   // -------------------------------------------------------------------------
   // nk max 3
-  static void evalXYaLarge(int_type nk, real_type a, real_type b, real_type * X, real_type * Y) {
+  static void evalXYaLarge(int_type nk, real_type a, real_type b, real_type * X, real_type * Y, FresnelAccuracy acc) {
     G2LIB_UTILS_ASSERT(nk < 4 && nk > 0, "In evalXYaLarge first argument nk must be in 1..3, nk %d\n", nk);
 
     real_type s    = a > 0 ? +1 : -1;
@@ -355,8 +707,9 @@ namespace G2lib {
 
     real_type Cl[3], Sl[3], Cz[3], Sz[3];
 
-    FresnelCS(nk, ell, Cl, Sl);
-    FresnelCS(nk, ell + z, Cz, Sz);
+    acc = inner_accuracy(acc, nk, z, ell);
+    FresnelCS(nk, ell, Cl, Sl, acc);
+    FresnelCS(nk, ell + z, Cz, Sz, acc);
 
     real_type dC0 = Cz[0] - Cl[0];
     real_type dS0 = Sz[0] - Sl[0];
@@ -387,13 +740,13 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static real_type LommelReduced(real_type mu, real_type nu, real_type b) {
+  static real_type LommelReduced(real_type mu, real_type nu, real_type b, real_type eps = 1e-50) {
     real_type tmp = 1 / ((mu + nu + 1) * (mu - nu + 1));
     real_type res = tmp;
     for (int_type n = 1; n <= 100; ++n) {
       tmp *= (-b / (2 * n + mu - nu + 1)) * (b / (2 * n + mu + nu + 1));
       res += tmp;
-      if (abs(tmp) < abs(res) * 1e-50)
+      if (abs(tmp) < abs(res) * eps)
         break;
     }
     return res;
@@ -402,7 +755,8 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static void evalXYazero(int_type nk, real_type b, real_type * X, real_type * Y) {
+  static void evalXYazero(int_type nk, real_type b, real_type * X, real_type * Y, FresnelAccuracy acc) {
+    real_type const eps = lommel_tolerance(acc);
     real_type sb = sin(b);
     real_type cb = cos(b);
     real_type b2 = b * b;
@@ -429,11 +783,11 @@ namespace G2lib {
       real_type D   = sb - b * cb;
       real_type B   = b * D;
       real_type C   = -b2 * sb;
-      real_type rLa = LommelReduced(m + 0.5, 1.5, b);
-      real_type rLd = LommelReduced(m + 0.5, 0.5, b);
+      real_type rLa = LommelReduced(m + 0.5, 1.5, b, eps);
+      real_type rLd = LommelReduced(m + 0.5, 0.5, b, eps);
       for (int_type k = m; k < nk; ++k) {
-        real_type rLb = LommelReduced(k + 1.5, 0.5, b);
-        real_type rLc = LommelReduced(k + 1.5, 1.5, b);
+        real_type rLb = LommelReduced(k + 1.5, 0.5, b, eps);
+        real_type rLc = LommelReduced(k + 1.5, 1.5, b, eps);
         X[k]          = (k * A * rLa + B * rLb + cb) / (1 + k);
         Y[k]          = (C * rLc + sb) / (2 + k) + D * rLd;
         rLa           = rLc;
@@ -445,13 +799,13 @@ namespace G2lib {
   // -------------------------------------------------------------------------
   // -------------------------------------------------------------------------
 
-  static void evalXYaSmall(real_type a, real_type b, int_type p, real_type & X, real_type & Y) {
+  static void evalXYaSmall(real_type a, real_type b, int_type p, real_type & X, real_type & Y, FresnelAccuracy acc) {
     G2LIB_UTILS_ASSERT(p < 11 && p > 0, "In evalXYaSmall p = %d must be in 1..10\n", p);
 
     real_type X0[43], Y0[43];
 
     int_type nkk = 4 * p + 3;  // max 43
-    evalXYazero(nkk, b, X0, Y0);
+    evalXYazero(nkk, b, X0, Y0, acc);
 
     X = X0[0] - (a / 2) * Y0[2];
     Y = Y0[0] + (a / 2) * X0[2];
@@ -469,7 +823,8 @@ namespace G2lib {
 
   // -------------------------------------------------------------------------
 
-  static void evalXYaSmall(int_type nk, real_type a, real_type b, int_type p, real_type * X, real_type * Y) {
+  static void evalXYaSmall(
+      int_type nk, real_type a, real_type b, int_type p, real_type * X, real_type * Y, FresnelAccuracy acc) {
     int_type  nkk = nk + 4 * p + 2;  // max 45
     real_type X0[45], Y0[45];
 
@@ -479,7 +834,7 @@ namespace G2lib {
         "nk + 4*p + 2 = %d must be less than 46\n",
         nk, p, nkk);
 
-    evalXYazero(nkk, b, X0, Y0);
+    evalXYazero(nkk, b, X0, Y0, acc);
 
     for (int_type j = 0; j < nk; ++j) {
       X[j] = X0[j] - (a / 2) * Y0[j + 2];
@@ -504,11 +859,17 @@ namespace G2lib {
   // -------------------------------------------------------------------------
 
   void GeneralizedFresnelCS(real_type a, real_type b, real_type c, real_type & intC, real_type & intS) {
+    GeneralizedFresnelCS(a, b, c, intC, intS, FresnelAccuracy::Exact);
+  }
+
+  void GeneralizedFresnelCS(
+      real_type a, real_type b, real_type c, real_type & intC, real_type & intS, FresnelAccuracy acc) {
     real_type xx, yy;
-    if (abs(a) < A_THRESOLD)
-      evalXYaSmall(a, b, A_SERIE_SIZE, xx, yy);
-    else
-      evalXYaLarge(a, b, xx, yy);
+    if (abs(a) < A_THRESOLD) {
+      acc = small_a_accuracy(acc, b);
+      evalXYaSmall(a, b, serie_size(acc), xx, yy, acc);
+    } else
+      evalXYaLarge(a, b, xx, yy, acc);
 
     real_type cosc = cos(c);
     real_type sinc = sin(c);
@@ -521,12 +882,24 @@ namespace G2lib {
   // -------------------------------------------------------------------------
 
   void GeneralizedFresnelCS(int_type nk, real_type a, real_type b, real_type c, real_type * intC, real_type * intS) {
+    GeneralizedFresnelCS(nk, a, b, c, intC, intS, FresnelAccuracy::Exact);
+  }
+
+  void GeneralizedFresnelCS(
+      int_type        nk,
+      real_type       a,
+      real_type       b,
+      real_type       c,
+      real_type *     intC,
+      real_type *     intS,
+      FresnelAccuracy acc) {
     G2LIB_UTILS_ASSERT(nk > 0 && nk < 4, "nk = %d must be in 1..3\n", nk);
 
-    if (abs(a) < A_THRESOLD)
-      evalXYaSmall(nk, a, b, A_SERIE_SIZE, intC, intS);
-    else
-      evalXYaLarge(nk, a, b, intC, intS);
+    if (abs(a) < A_THRESOLD) {
+      acc = small_a_accuracy(acc, b);
+      evalXYaSmall(nk, a, b, serie_size(acc), intC, intS, acc);
+    } else
+      evalXYaLarge(nk, a, b, intC, intS, acc);
 
     real_type cosc = cos(c);
     real_type sinc = sin(c);
@@ -539,6 +912,171 @@ namespace G2lib {
     }
   }
 
+  // -------------------------------------------------------------------------
+  // -------------------------------------------------------------------------
+
+#if G2LIB_SIMD_WIDTH > 1
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //
+  // evalXYaLarge on one register, all the lanes must have |a| >= A_THRESOLD
+  //
+  static void evalXYaLarge_simd(
+      int_type nk, Simd::vreal const & a, Simd::vreal const & b, Simd::vreal * X, Simd::vreal * Y) {
+    using Simd::vreal;
+
+    vreal s    = Simd::select(a > vreal(0.0), vreal(1.0), vreal(-1.0));
+    vreal absa = Simd::abs(a);
+    vreal sqa  = Simd::sqrt(absa);
+    vreal z    = vreal(Utils::m_1_sqrt_pi) * sqa;
+    vreal ell  = s * b * vreal(Utils::m_1_sqrt_pi) / sqa;
+    vreal g    = vreal(-0.5) * s * (b * b) / absa;
+    vreal cg, sg;
+    Simd::sincos(g, sg, cg);
+    cg = cg / z;
+    sg = sg / z;
+
+    vreal Cl[3], Sl[3], Cz[3], Sz[3];
+    FresnelCS_simd(nk, ell, Cl, Sl);
+    FresnelCS_simd(nk, ell + z, Cz, Sz);
+
+    vreal dC0 = Cz[0] - Cl[0];
+    vreal dS0 = Sz[0] - Sl[0];
+    X[0]      = cg * dC0 - s * sg * dS0;
+    Y[0]      = sg * dC0 + s * cg * dS0;
+    if (nk > 1) {
+      cg        = cg / z;
+      sg        = sg / z;
+      vreal dC1 = Cz[1] - Cl[1];
+      vreal dS1 = Sz[1] - Sl[1];
+      vreal DC  = dC1 - ell * dC0;
+      vreal DS  = dS1 - ell * dS0;
+      X[1]      = cg * DC - s * sg * DS;
+      Y[1]      = sg * DC + s * cg * DS;
+      if (nk > 2) {
+        vreal dC2 = Cz[2] - Cl[2];
+        vreal dS2 = Sz[2] - Sl[2];
+        DC        = dC2 + ell * (ell * dC0 - vreal(2.0) * dC1);
+        DS        = dS2 + ell * (ell * dS0 - vreal(2.0) * dS1);
+        cg        = cg / z;
+        sg        = sg / z;
+        X[2]      = cg * DC - s * sg * DS;
+        Y[2]      = sg * DC + s * cg * DS;
+      }
+    }
+  }
+
+  //
+  // evalXYazero for the moment 0 only (segments and arcs)
+  //
+  static void evalXYazero_simd(Simd::vreal const & b, Simd::vreal & X, Simd::vreal & Y) {
+    using Simd::vreal;
+    using Simd::vmask;
+
+    vreal sb, cb;
+    Simd::sincos(b, sb, cb);
+    vreal const one   = vreal(1.0);
+    vreal const b2    = b * b;
+    vreal const Xs    = one - (b2 / vreal(6.0)) * (one - (b2 / vreal(20.0)) * (one - (b2 / vreal(42.0))));
+    vreal const Ys    = (b / vreal(2.0)) * (one - (b2 / vreal(12.0)) * (one - (b2 / vreal(30.0))));
+    vmask const small = Simd::abs(b) < vreal(1e-3);
+    X                 = Simd::select(small, Xs, sb / b);
+    Y                 = Simd::select(small, Ys, (one - cb) / b);
+  }
+
+  //
+  // GeneralizedFresnelCS on the triples idx[0..width-1], results are
+  // scattered in the structure-of-arrays output. With `azero` all the
+  // lanes have a = 0 and nk = 1, otherwise |a| >= A_THRESOLD.
+  //
+  static void GeneralizedFresnelCS_simd(
+      int_type          n,
+      int_type          nk,
+      int_type const *  idx,
+      bool              azero,
+      real_type const * a,
+      real_type const * b,
+      real_type const * c,
+      real_type *       intC,
+      real_type *       intS) {
+    using Simd::vreal;
+
+    vreal X[3], Y[3], sinc, cosc;
+    if (azero)
+      evalXYazero_simd(Simd::gather(b, idx), X[0], Y[0]);
+    else
+      evalXYaLarge_simd(nk, Simd::gather(a, idx), Simd::gather(b, idx), X, Y);
+    Simd::sincos(Simd::gather(c, idx), sinc, cosc);
+
+    real_type aa[Simd::width], bb[Simd::width];
+    for (int_type k = 0; k < nk; ++k) {
+      Simd::store(aa, X[k] * cosc - Y[k] * sinc);
+      Simd::store(bb, X[k] * sinc + Y[k] * cosc);
+      for (int_type j = 0; j < Simd::width; ++j) {
+        intC[k * n + idx[j]] = aa[j];
+        intS[k * n + idx[j]] = bb[j];
+      }
+    }
+  }
+#endif
+#endif
+
+  //!
+  //! Batch version of `GeneralizedFresnelCS(nk, a, b, c, intC, intS)` over
+  //! `n` triples stored as structure of arrays. The moment `k` of the triple
+  //! `i` is stored in `intC[k*n+i]` and `intS[k*n+i]`.
+  //!
+  //! When the library is compiled for AVX2 or AVX-512 the triples are grouped
+  //! by regime: the ones with \f$ |a| \geq \f$ `A_THRESOLD` and, for
+  //! `nk = 1`, the ones with \f$ a = 0 \f$ (segments and arcs) are packed
+  //! in vector registers, the others (small \f$ a \f$ series) and the last
+  //! incomplete registers are evaluated with the scalar routine.
+  //!
+  void GeneralizedFresnelCS(
+      int_type          n,
+      int_type          nk,
+      real_type const * a,
+      real_type const * b,
+      real_type const * c,
+      real_type *       intC,
+      real_type *       intS) {
+    G2LIB_UTILS_ASSERT(nk > 0 && nk < 4, "nk = %d must be in 1..3\n", nk);
+
+    real_type C[3], S[3];
+    auto scalar = [&](int_type i) {
+      GeneralizedFresnelCS(nk, a[i], b[i], c[i], C, S);
+      for (int_type k = 0; k < nk; ++k) {
+        intC[k * n + i] = C[k];
+        intS[k * n + i] = S[k];
+      }
+    };
+
+#if G2LIB_SIMD_WIDTH > 1
+    int_type idx[Simd::width], idz[Simd::width];
+    int_type npack = 0, nzero = 0;
+    for (int_type i = 0; i < n; ++i) {
+      if (abs(a[i]) >= A_THRESOLD) {
+        idx[npack++] = i;
+        if (npack == Simd::width) {
+          GeneralizedFresnelCS_simd(n, nk, idx, false, a, b, c, intC, intS);
+          npack = 0;
+        }
+      } else if (a[i] == 0 && nk == 1) {
+        idz[nzero++] = i;
+        if (nzero == Simd::width) {
+          GeneralizedFresnelCS_simd(n, nk, idz, true, a, b, c, intC, intS);
+          nzero = 0;
+        }
+      } else {
+        scalar(i);
+      }
+    }
+    for (int_type j = 0; j < npack; ++j) scalar(idx[j]);
+    for (int_type j = 0; j < nzero; ++j) scalar(idz[j]);
+#else
+    for (int_type i = 0; i < n; ++i) scalar(i);
+#endif
+  }
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   // -------------------------------------------------------------------------
@@ -689,7 +1227,7 @@ namespace G2lib {
 
   real_type ClothoidData::X(real_type s) const {
     real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, accuracy);
     return x0 + s * C;
   }
 
@@ -697,7 +1235,7 @@ namespace G2lib {
 
   real_type ClothoidData::Y(real_type s) const {
     real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, accuracy);
     return y0 + s * S;
   }
 
@@ -781,7 +1319,7 @@ namespace G2lib {
 
   void ClothoidData::evaluate(real_type s, real_type & theta, real_type & kappa, real_type & x, real_type & y) const {
     real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, accuracy);
     x     = x0 + s * C;
     y     = y0 + s * S;
     theta = theta0 + s * (kappa0 + 0.5 * s * dk);
@@ -790,9 +1328,129 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  void ClothoidData::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    real_type FC, FS;
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, FC, FS, accuracy);
+    real_type theta   = theta0 + s * (kappa0 + 0.5 * s * dk);
+    real_type theta_D = kappa0 + s * dk;
+    real_type C       = cos(theta);
+    real_type S       = sin(theta);
+    real_type tmp0    = -theta_D * offs;
+
+    J.x     = x0 + s * FC - offs * S;
+    J.y     = y0 + s * FS + offs * C;
+    J.theta = theta;
+
+    real_type scale = 1 + offs * theta_D;  // same scaling of evaluate_ISO
+    J.kappa         = theta_D / scale;
+    J.kappa_D       = dk / (scale * scale);
+
+    J.x_D = C * (1 + tmp0);
+    J.y_D = S * (1 + tmp0);
+
+    real_type tmp1 = theta_D * (1 + tmp0);
+    real_type tmp2 = -offs * dk;
+    J.x_DD         = -tmp1 * S + C * tmp2;
+    J.y_DD         = tmp1 * C + S * tmp2;
+
+    tmp1    = -theta_D * theta_D * (1 + tmp0);
+    tmp2    = dk * (1 + 3 * tmp0);
+    J.x_DDD = tmp1 * C - tmp2 * S;
+    J.y_DDD = tmp1 * S + tmp2 * C;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  //!
+  //! Compute \f$ \int_0^1 \exp(\mathrm{i}(bt+at^2/2))\,dt \f$ by the power
+  //! series of the integrand, the coefficients satisfy
+  //! \f$ (k+1)c_{k+1} = \mathrm{i}(b c_k + a c_{k-1}) \f$.
+  //! Intended for \f$ |a|+|b| \leq 1 \f$ (small step).
+  //!
+  static void
+  step_increment(real_type a, real_type b, real_type & IC, real_type & IS) {
+    real_type c0r = 0, c0i = 0;  // c_{k-1}
+    real_type c1r = 1, c1i = 0;  // c_k
+    IC = 1;
+    IS = 0;
+    for (int_type k = 0; k < 30; ++k) {
+      // c_{k+1} = i * (b*c_k + a*c_{k-1}) / (k+1)
+      real_type tr  = b * c1r + a * c0r;
+      real_type ti  = b * c1i + a * c0i;
+      real_type inv = 1.0 / (k + 1);
+      c0r           = c1r;
+      c0i           = c1i;
+      c1r           = -ti * inv;
+      c1i           = tr * inv;
+      IC += c1r / (k + 2);
+      IS += c1i / (k + 2);
+      if (k > 1 && abs(c1r) + abs(c1i) + abs(c0r) + abs(c0i) < 1e-17) break;
+    }
+  }
+
+  void ClothoidData::sample_uniform(
+      real_type   s0,
+      real_type   ds,
+      int_type    n,
+      real_type * x,
+      real_type * y,
+      real_type * theta,
+      real_type * kappa) const {
+    // number of incremental steps before an exact re-anchoring
+    constexpr int_type ANCHOR_STEPS = 64;
+
+    real_type const a  = dk * ds * ds;
+    real_type const ca = cos(a);
+    real_type const sa = sin(a);
+
+    int_type j = 0;
+    while (j < n) {
+      // exact anchor
+      real_type s = s0 + j * ds;
+      real_type th, k, px, py;
+      evaluate(s, th, k, px, py);
+      real_type ct = cos(th);
+      real_type st = sin(th);
+      // rotation from theta_j to theta_{j+1}
+      real_type delta = k * ds + 0.5 * a;
+      real_type cd    = cos(delta);
+      real_type sd    = sin(delta);
+
+      int_type jend = std::min(n, j + ANCHOR_STEPS);
+      while (true) {
+        s     = s0 + j * ds;
+        x[j]  = px;
+        y[j]  = py;
+        if (theta != nullptr) theta[j] = theta0 + s * (kappa0 + 0.5 * s * dk);
+        if (kappa != nullptr) kappa[j] = kappa0 + s * dk;
+        if (++j >= jend) break;
+
+        // increment ds * exp(i theta_j) * int_0^1 exp(i(b t + a t^2/2)) dt
+        real_type b = (kappa0 + s * dk) * ds;
+        real_type IC, IS;
+        if (abs(a) + abs(b) <= 1)
+          step_increment(a, b, IC, IS);
+        else
+          GeneralizedFresnelCS(a, b, 0, IC, IS, accuracy);
+        px += ds * (ct * IC - st * IS);
+        py += ds * (st * IC + ct * IS);
+
+        // theta_{j+1} = theta_j + delta_j, delta_{j+1} = delta_j + a
+        real_type tmp = ct * cd - st * sd;
+        st            = st * cd + ct * sd;
+        ct            = tmp;
+        tmp           = cd * ca - sd * sa;
+        sd            = sd * ca + cd * sa;
+        cd            = tmp;
+      }
+    }
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   void ClothoidData::eval(real_type s, real_type & x, real_type & y) const {
     real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, accuracy);
     x = x0 + s * C;
     y = y0 + s * S;
   }
@@ -830,7 +1488,7 @@ namespace G2lib {
 
   void ClothoidData::eval_ISO(real_type s, real_type offs, real_type & x, real_type & y) const {
     real_type C, S;
-    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S);
+    GeneralizedFresnelCS(dk * s * s, kappa0 * s, theta0, C, S, accuracy);
     real_type theta = theta0 + s * (kappa0 + 0.5 * s * dk);
     real_type tx    = cos(theta);
     real_type ty    = sin(theta);
@@ -1054,33 +1712,34 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  int ClothoidData::build_G1(
-      real_type   _x0,
-      real_type   _y0,
-      real_type   _theta0,
+  static real_type const build_G1_CF[] = { 2.989696028701907,  0.716228953608281, -0.458969738821509,
+                                           -0.502821153340377, 0.261062141752652, -0.045854475238709 };
+
+  //
+  // Reduce the hermite G1 problem to the normalized one,
+  // return the distance `r`, the reduced initial angle `phi0`,
+  // the angle variation `delta` and the initial guess of `A`
+  //
+  static void build_G1_reduce(
+      real_type   x0,
+      real_type   y0,
+      real_type   theta0,
       real_type   x1,
       real_type   y1,
       real_type   theta1,
-      real_type   tol,
-      real_type & L,
-      bool        compute_deriv,
-      real_type   L_D[2],
-      real_type   k_D[2],
-      real_type   dk_D[2]) {
-    static real_type const CF[] = { 2.989696028701907,  0.716228953608281, -0.458969738821509,
-                                    -0.502821153340377, 0.261062141752652, -0.045854475238709 };
-
-    x0     = _x0;
-    y0     = _y0;
-    theta0 = _theta0;
+      real_type & r,
+      real_type & phi0,
+      real_type & delta,
+      real_type & A) {
+    real_type const * CF = build_G1_CF;
 
     // traslazione in (0,0)
     real_type dx   = x1 - x0;
     real_type dy   = y1 - y0;
-    real_type r    = hypot(dx, dy);
     real_type phi  = atan2(dy, dx);
-    real_type phi0 = theta0 - phi;
     real_type phi1 = theta1 - phi;
+    r              = hypot(dx, dy);
+    phi0           = theta0 - phi;
 
     phi0 -= Utils::m_2pi * round(phi0 / Utils::m_2pi);
     phi1 -= Utils::m_2pi * round(phi1 / Utils::m_2pi);
@@ -1094,7 +1753,7 @@ namespace G2lib {
     else if (phi1 < -Utils::m_pi)
       phi1 += Utils::m_2pi;
 
-    real_type delta = phi1 - phi0;
+    delta = phi1 - phi0;
 
     // punto iniziale
     real_type X  = phi0 * Utils::m_1_pi;
@@ -1102,10 +1761,57 @@ namespace G2lib {
     real_type xy = X * Y;
     Y *= Y;
     X *= X;
-    real_type A =
-        (phi0 + phi1) * (CF[0] + xy * (CF[1] + xy * CF[2]) + (CF[3] + xy * CF[4]) * (X + Y) + CF[5] * (X * X + Y * Y));
-    // newton
-    real_type g     = 0, dg, intC[3], intS[3];
+    A = (phi0 + phi1) * (CF[0] + xy * (CF[1] + xy * CF[2]) + (CF[3] + xy * CF[4]) * (X + Y) + CF[5] * (X * X + Y * Y));
+  }
+
+  //
+  // Derivatives of L, kappa0 and dk w.r.t. theta0 and theta1,
+  // `intC`, `intS` are the first three momentae at the solution
+  //
+  static void build_G1_deriv(
+      real_type       L,
+      real_type       kappa0,
+      real_type       dk,
+      real_type const intC[3],
+      real_type const intS[3],
+      real_type       L_D[2],
+      real_type       k_D[2],
+      real_type       dk_D[2]) {
+    real_type alpha = intC[0] * intC[1] + intS[0] * intS[1];
+    real_type beta  = intC[0] * intC[2] + intS[0] * intS[2];
+    real_type gamma = intC[0] * intC[0] + intS[0] * intS[0];
+    real_type tx    = intC[1] - intC[2];
+    real_type ty    = intS[1] - intS[2];
+    real_type txy   = L * (intC[1] * intS[2] - intC[2] * intS[1]);
+    real_type omega = L * (intS[0] * tx - intC[0] * ty) - txy;
+
+    real_type delta = intC[0] * tx + intS[0] * ty;
+
+    L_D[0] = omega / delta;
+    L_D[1] = txy / delta;
+
+    delta *= L;
+    k_D[0] = (beta - gamma - kappa0 * omega) / delta;
+    k_D[1] = -(beta + kappa0 * txy) / delta;
+
+    delta *= L / 2;
+    dk_D[0] = (gamma - alpha - dk * omega * L) / delta;
+    dk_D[1] = (alpha - dk * txy * L) / delta;
+  }
+
+  //
+  // Newton iterations on the reduced hermite G1 problem starting from `A`,
+  // return the number of iterations and the last residual in `g`
+  //
+  static int_type build_G1_newton(
+      real_type   delta,
+      real_type   phi0,
+      real_type   tol,
+      real_type & A,
+      real_type & g,
+      real_type   intC[3],
+      real_type   intS[3]) {
+    real_type dg;
     int_type  niter = 0;
     do {
       GeneralizedFresnelCS(3, 2 * A, delta - A, phi0, intC, intS);
@@ -1113,6 +1819,68 @@ namespace G2lib {
       dg = intC[2] - intC[1];
       A -= g / dg;
     } while (++niter <= 10 && abs(g) > tol);
+    return niter;
+  }
+
+  //
+  // A previous solution is used as starting point only if it is close
+  // to the cold guess, otherwise Newton may land on a non principal root
+  //
+  static bool build_G1_warm_ok(real_type A_warm, real_type A_cold) {
+    return isfinite(A_warm) && abs(A_warm - A_cold) < Utils::m_pi;
+  }
+
+  int ClothoidData::build_G1(
+      real_type   _x0,
+      real_type   _y0,
+      real_type   _theta0,
+      real_type   x1,
+      real_type   y1,
+      real_type   theta1,
+      real_type   tol,
+      real_type & L,
+      bool        compute_deriv,
+      real_type   L_D[2],
+      real_type   k_D[2],
+      real_type   dk_D[2]) {
+    real_type A = std::numeric_limits<real_type>::quiet_NaN();
+    return build_G1_warm(_x0, _y0, _theta0, x1, y1, theta1, tol, L, A, compute_deriv, L_D, k_D, dk_D);
+  }
+
+  int ClothoidData::build_G1_warm(
+      real_type   _x0,
+      real_type   _y0,
+      real_type   _theta0,
+      real_type   x1,
+      real_type   y1,
+      real_type   theta1,
+      real_type   tol,
+      real_type & L,
+      real_type & A,
+      bool        compute_deriv,
+      real_type   L_D[2],
+      real_type   k_D[2],
+      real_type   dk_D[2]) {
+    x0     = _x0;
+    y0     = _y0;
+    theta0 = _theta0;
+
+    real_type r, phi0, delta, A_cold;
+    build_G1_reduce(x0, y0, theta0, x1, y1, theta1, r, phi0, delta, A_cold);
+
+    // newton, from the previous solution if available then from the cold guess
+    real_type g = 0, intC[3], intS[3];
+    int_type  niter = 0;
+    if (build_G1_warm_ok(A, A_cold)) {
+      niter = build_G1_newton(delta, phi0, tol, A, g, intC, intS);
+      if (!(abs(g) <= tol)) {
+        A = A_cold;
+        niter += build_G1_newton(delta, phi0, tol, A, g, intC, intS);
+      }
+    } else {
+      A     = A_cold;
+      niter = build_G1_newton(delta, phi0, tol, A, g, intC, intS);
+    }
 
     G2LIB_UTILS_ASSERT(abs(g) <= tol, "Newton do not converge, g = %d niter = %d\n", g, niter);
     GeneralizedFresnelCS(2 * A, delta - A, phi0, intC[0], intS[0]);
@@ -1122,32 +1890,163 @@ namespace G2lib {
     this->kappa0 = (delta - A) / L;
     this->dk     = 2 * A / L / L;
 
-    if (compute_deriv) {
-      real_type alpha = intC[0] * intC[1] + intS[0] * intS[1];
-      real_type beta  = intC[0] * intC[2] + intS[0] * intS[2];
-      real_type gamma = intC[0] * intC[0] + intS[0] * intS[0];
-      real_type tx    = intC[1] - intC[2];
-      real_type ty    = intS[1] - intS[2];
-      real_type txy   = L * (intC[1] * intS[2] - intC[2] * intS[1]);
-      real_type omega = L * (intS[0] * tx - intC[0] * ty) - txy;
+    if (compute_deriv) build_G1_deriv(L, kappa0, dk, intC, intS, L_D, k_D, dk_D);
 
-      delta = intC[0] * tx + intS[0] * ty;
+    return niter;
+  }
 
-      L_D[0] = omega / delta;
-      L_D[1] = txy / delta;
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-      delta *= L;
-      k_D[0] = (beta - gamma - kappa0 * omega) / delta;
-      k_D[1] = -(beta + kappa0 * txy) / delta;
+  //
+  // Common driver of build_G1_batch and build_G1_batch_warm,
+  // `A_io` is `nullptr` for a cold start
+  //
+  static int_type build_G1_batch_internal(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * th0,
+      real_type const * x1,
+      real_type const * y1,
+      real_type const * th1,
+      real_type         tol,
+      real_type *       A_io,
+      real_type *       L,
+      real_type *       k,
+      real_type *       dk,
+      real_type *       L_D,
+      real_type *       k_D,
+      real_type *       dk_D) {
+    if (n <= 0) return 0;
+    size_t const nn = size_t(n);
+
+    // r, phi0, delta, A and the cold guess of each problem, then the
+    // arguments and the momentae of the Fresnel integrals of the active problems
+    std::vector<real_type> work(11 * nn);
+    real_type *            r      = work.data();
+    real_type *            phi0   = r + nn;
+    real_type *            delta  = phi0 + nn;
+    real_type *            A      = delta + nn;
+    real_type *            A_cold = A + nn;
+    real_type *            fa     = A_cold + nn;
+    real_type *            fb     = fa + nn;
+    real_type *            fc     = fb + nn;
+    real_type *            fC     = fc + nn;  // 3 momentae of the cosine integrals
+    std::vector<real_type> fS(3 * nn);
+    std::vector<int_type>  active(nn), failed;
+
+    for (int_type i = 0; i < n; ++i) {
+      build_G1_reduce(x0[i], y0[i], th0[i], x1[i], y1[i], th1[i], r[i], phi0[i], delta[i], A_cold[i]);
+      A[i]              = A_io != nullptr && build_G1_warm_ok(A_io[i], A_cold[i]) ? A_io[i] : A_cold[i];
+      active[size_t(i)] = i;
+    }
 
-      delta *= L / 2;
-      dk_D[0] = (gamma - alpha - dk * omega * L) / delta;
-      dk_D[1] = (alpha - dk * txy * L) / delta;
+    // newton, a problem leaves the active set as soon as |g| <= tol
+    int_type nactive = n;
+    auto     newton  = [&]() -> int_type {
+      int_type niter = 0;
+      while (nactive > 0 && niter <= 10) {
+        for (int_type j = 0; j < nactive; ++j) {
+          int_type i = active[size_t(j)];
+          fa[j]      = 2 * A[i];
+          fb[j]      = delta[i] - A[i];
+          fc[j]      = phi0[i];
+        }
+        GeneralizedFresnelCS(nactive, 3, fa, fb, fc, fC, fS.data());
+        int_type nleft = 0;
+        for (int_type j = 0; j < nactive; ++j) {
+          int_type  i  = active[size_t(j)];
+          real_type g  = fS[size_t(j)];
+          real_type dg = fC[2 * nactive + j] - fC[nactive + j];
+          A[i] -= g / dg;
+          if (!(abs(g) <= tol)) active[size_t(nleft++)] = i;
+        }
+        nactive = nleft;
+        ++niter;
+      }
+      return niter;
+    };
+
+    int_type niter = newton();
+    if (nactive > 0 && A_io != nullptr) {
+      // warm start failed, restart these problems from the cold guess
+      for (int_type j = 0; j < nactive; ++j) A[active[size_t(j)]] = A_cold[active[size_t(j)]];
+      niter += newton();
     }
 
+    G2LIB_UTILS_ASSERT(
+        nactive == 0, "build_G1_batch, Newton do not converge for %d problems, first failure at %d\n", nactive,
+        nactive > 0 ? active[0] : 0);
+
+    // solution
+    bool const compute_deriv = L_D != nullptr && k_D != nullptr && dk_D != nullptr;
+    int_type   nk            = compute_deriv ? 3 : 1;
+    for (int_type i = 0; i < n; ++i) {
+      fa[i] = 2 * A[i];
+      fb[i] = delta[i] - A[i];
+    }
+    GeneralizedFresnelCS(n, nk, fa, fb, phi0, fC, fS.data());
+
+    for (int_type i = 0; i < n; ++i) {
+      real_type LL = r[i] / fC[i];
+      G2LIB_UTILS_ASSERT(LL > 0, "build_G1_batch, negative length L[%d] = %g\n", i, LL);
+      L[i]  = LL;
+      k[i]  = (delta[i] - A[i]) / LL;
+      dk[i] = 2 * A[i] / LL / LL;
+      if (compute_deriv) {
+        real_type intC[3] = { fC[i], fC[n + i], fC[2 * n + i] };
+        real_type intS[3] = { fS[size_t(i)], fS[size_t(n + i)], fS[size_t(2 * n + i)] };
+        real_type LD[2], KD[2], DKD[2];
+        build_G1_deriv(LL, k[i], dk[i], intC, intS, LD, KD, DKD);
+        L_D[i]      = LD[0];
+        L_D[n + i]  = LD[1];
+        k_D[i]      = KD[0];
+        k_D[n + i]  = KD[1];
+        dk_D[i]     = DKD[0];
+        dk_D[n + i] = DKD[1];
+      }
+    }
+    if (A_io != nullptr) std::copy_n(A, n, A_io);
     return niter;
   }
 
+  int_type build_G1_batch(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * th0,
+      real_type const * x1,
+      real_type const * y1,
+      real_type const * th1,
+      real_type         tol,
+      real_type *       L,
+      real_type *       k,
+      real_type *       dk,
+      real_type *       L_D,
+      real_type *       k_D,
+      real_type *       dk_D) {
+    return build_G1_batch_internal(n, x0, y0, th0, x1, y1, th1, tol, nullptr, L, k, dk, L_D, k_D, dk_D);
+  }
+
+  int_type build_G1_batch_warm(
+      int_type          n,
+      real_type const * x0,
+      real_type const * y0,
+      real_type const * th0,
+      real_type const * x1,
+      real_type const * y1,
+      real_type const * th1,
+      real_type         tol,
+      real_type *       A,
+      real_type *       L,
+      real_type *       k,
+      real_type *       dk,
+      real_type *       L_D,
+      real_type *       k_D,
+      real_type *       dk_D) {
+    return build_G1_batch_internal(n, x0, y0, th0, x1, y1, th1, tol, A, L, k, dk, L_D, k_D, dk_D);
+  }
+
 #endif
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
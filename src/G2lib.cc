@@ -51,7 +51,8 @@ namespace G2lib {
   using std::sqrt;
   using std::tan;
 
-  bool intersect_with_AABBtree = true;
+  bool     intersect_with_AABBtree = true;
+  int_type intersect_num_threads   = 1;
 
   char const * CurveType_name[] = { "LINE", "POLYLINE", "CIRCLE", "BIARC", "BIARC_LIST", "CLOTHOID", "CLOTHOID_LIST" };
 
@@ -382,7 +383,7 @@ namespace G2lib {
       }
     }
     real_type len1 = Utils::m_2pi / (Utils::machepsi + abs(kappa1));
-    real_type len2 = Utils::m_2pi / (Utils::machepsi + abs(kappa1));
+    real_type len2 = Utils::m_2pi / (Utils::machepsi + abs(kappa2));
     for (int_type i = 0; i < nsol; ++i) {
       real_type ss1 = invCoscSinc(kappa1, xx1[i], yy1[i]);
       real_type ss2 = invCoscSinc(kappa2, xx2[i], yy2[i]);
@@ -759,7 +760,7 @@ namespace G2lib {
 
   void BaseCurve::eval_ISO_DD(real_type s, real_type offs, real_type & x_DD, real_type & y_DD) const {
     real_type nx_DD, ny_DD;
-    nor_ISO_D(s, nx_DD, ny_DD);
+    nor_ISO_DD(s, nx_DD, ny_DD);
     eval_DD(s, x_DD, y_DD);
     x_DD += offs * nx_DD;
     y_DD += offs * ny_DD;
@@ -767,12 +768,49 @@ namespace G2lib {
 
   void BaseCurve::eval_ISO_DDD(real_type s, real_type offs, real_type & x_DDD, real_type & y_DDD) const {
     real_type nx_DDD, ny_DDD;
-    nor_ISO_D(s, nx_DDD, ny_DDD);
+    nor_ISO_DDD(s, nx_DDD, ny_DDD);
     eval_DDD(s, x_DDD, y_DDD);
     x_DDD += offs * nx_DDD;
     y_DDD += offs * ny_DDD;
   }
 
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BaseCurve::evaluate_jet(real_type s, real_type offs, CurveJet & J) const {
+    evaluate_ISO(s, offs, J.theta, J.kappa, J.x, J.y);
+    eval_ISO_D(s, offs, J.x_D, J.y_D);
+    eval_ISO_DD(s, offs, J.x_DD, J.y_DD);
+    eval_ISO_DDD(s, offs, J.x_DDD, J.y_DDD);
+    real_type scale = 1 + offs * theta_D(s);
+    J.kappa_D       = theta_DD(s) / (scale * scale);
+  }
+
+  // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+  void BaseCurve::raycast_batch(
+      int_type          n,
+      real_type const * x,
+      real_type const * y,
+      real_type const * dx,
+      real_type const * dy,
+      real_type         max_range,
+      real_type *       s,
+      real_type *       t,
+      bool *            hit,
+      int_type          n_threads) const {
+    if (n <= 0) return;
+    hit[0] = this->raycast(x[0], y[0], dx[0], dy[0], max_range, s[0], t[0]);
+
+    // blocks of rays, at least 4 blocks per worker
+    int_type const block = 64;
+    int_type       nblk  = (n - 1 + block - 1) / block;
+    Utils::parallel_for(nblk, Utils::num_workers(nblk, n_threads, int_type(4)), [&](int_type b) {
+      int_type i_end = std::min(n, 1 + (b + 1) * block);
+      for (int_type i = 1 + b * block; i < i_end; ++i)
+        hit[i] = this->raycast(x[i], y[i], dx[i], dy[i], max_range, s[i], t[i]);
+    });
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 }  // namespace G2lib
@@ -28,6 +28,9 @@
 #include "Clothoids/ClothoidList.hxx"
 #include "Utils.hxx"
 
+#include <array>
+#include <utility>
+
 #ifdef __clang__
 #pragma clang diagnostic ignored "-Wglobal-constructors"
 #pragma clang diagnostic ignored "-Wexit-time-destructors"
@@ -35,15 +38,113 @@
 
 namespace G2lib {
 
-  using std::map;
-  using std::pair;
-
   using std::abs;
   using std::fpclassify;
   using std::lower_bound;
   using std::numeric_limits;
   using std::sqrt;
 
+  /*\
+   |   ____  _                 _       _
+   |  |  _ \(_)___ _ __   __ _| |_ ___| |__
+   |  | | | | / __| '_ \ / _` | __/ __| '_ \
+   |  | |_| | \__ \ |_) | (_| | || (__| | | |
+   |  |____/|_|___/ .__/ \__,_|\__\___|_| |_|
+   |              |_|
+  \*/
+
+  //
+  // Class of each curve type
+  //
+  template <CurveType T> struct CurveClass;
+  template <> struct CurveClass<G2LIB_LINE> { using type = LineSegment; };
+  template <> struct CurveClass<G2LIB_POLYLINE> { using type = PolyLine; };
+  template <> struct CurveClass<G2LIB_CIRCLE> { using type = CircleArc; };
+  template <> struct CurveClass<G2LIB_BIARC> { using type = Biarc; };
+  template <> struct CurveClass<G2LIB_BIARC_LIST> { using type = BiarcList; };
+  template <> struct CurveClass<G2LIB_CLOTHOID> { using type = ClothoidCurve; };
+  template <> struct CurveClass<G2LIB_CLOTHOID_LIST> { using type = ClothoidList; };
+
+  //
+  // Call `fun` with the curve `obj` of type `T` seen as a curve of type `P`:
+  // the object itself when `T == P` (no copy, its cached AABB tree is
+  // reused), a converted copy otherwise
+  //
+  template <CurveType P, CurveType T, typename FUN>
+  static inline auto with_promoted(BaseCurve const & obj, FUN && fun) {
+    using Curve = typename CurveClass<P>::type;
+    if constexpr (P == T) {
+      return fun(static_cast<Curve const &>(obj));
+    } else {
+      Curve const C(obj);
+      return fun(C);
+    }
+  }
+
+  //
+  // Kernels for the pair of types (T1,T2), the curves are promoted to
+  // the common type of `promote_table`
+  //
+  template <CurveType T1, CurveType T2> struct CollisionKernel {
+    static bool run(BaseCurve const & obj1, BaseCurve const & obj2) {
+      constexpr CurveType P = curve_promote(T1, T2);
+      return with_promoted<P, T1>(obj1, [&](auto const & C1) {
+        return with_promoted<P, T2>(obj2, [&](auto const & C2) { return C1.collision(C2); });
+      });
+    }
+  };
+
+  template <CurveType T1, CurveType T2> struct CollisionISOKernel {
+    static bool run(BaseCurve const & obj1, real_type offs1, BaseCurve const & obj2, real_type offs2) {
+      constexpr CurveType P = curve_promote(T1, T2);
+      return with_promoted<P, T1>(obj1, [&](auto const & C1) {
+        return with_promoted<P, T2>(obj2, [&](auto const & C2) { return C1.collision_ISO(offs1, C2, offs2); });
+      });
+    }
+  };
+
+  template <CurveType T1, CurveType T2> struct IntersectKernel {
+    static void run(BaseCurve const & obj1, BaseCurve const & obj2, IntersectList & ilist, bool swap_s_vals) {
+      constexpr CurveType P = curve_promote(T1, T2);
+      with_promoted<P, T1>(obj1, [&](auto const & C1) {
+        with_promoted<P, T2>(obj2, [&](auto const & C2) { C1.intersect(C2, ilist, swap_s_vals); });
+      });
+    }
+  };
+
+  template <CurveType T1, CurveType T2> struct IntersectISOKernel {
+    static void run(
+        BaseCurve const & obj1,
+        real_type         offs1,
+        BaseCurve const & obj2,
+        real_type         offs2,
+        IntersectList &   ilist,
+        bool              swap_s_vals) {
+      constexpr CurveType P = curve_promote(T1, T2);
+      with_promoted<P, T1>(obj1, [&](auto const & C1) {
+        with_promoted<P, T2>(obj2, [&](auto const & C2) { C1.intersect_ISO(offs1, C2, offs2, ilist, swap_s_vals); });
+      });
+    }
+  };
+
+  //
+  // Table of the kernels `KERNEL<T1,T2>::run` built at compile time,
+  // the entry of the pair (T1,T2) is `T1*CurveType_count+T2`
+  //
+  template <template <CurveType, CurveType> class KERNEL, std::size_t... I>
+  static constexpr auto dispatch_table(std::index_sequence<I...>) {
+    return std::array{ &KERNEL<CurveType(I / CurveType_count), CurveType(I % CurveType_count)>::run... };
+  }
+
+  template <template <CurveType, CurveType> class KERNEL>
+  static constexpr auto dispatch_table() {
+    return dispatch_table<KERNEL>(std::make_index_sequence<CurveType_count * CurveType_count>());
+  }
+
+  static inline std::size_t dispatch_index(BaseCurve const & obj1, BaseCurve const & obj2) {
+    return std::size_t(obj1.type() * CurveType_count + obj2.type());
+  }
+
   /*\
    |   _       _                          _
    |  (_)_ __ | |_ ___ _ __ ___  ___  ___| |_
@@ -55,131 +156,22 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool collision(BaseCurve const & obj1, BaseCurve const & obj2) {
-    bool ok = false;
-    switch (curve_promote(obj1.type(), obj2.type())) {
-      case G2LIB_LINE: {
-        LineSegment L1(obj1);
-        LineSegment L2(obj2);
-        ok = L1.collision(L2);
-      } break;
-      case G2LIB_CIRCLE: {
-        CircleArc C1(obj1);
-        CircleArc C2(obj2);
-        ok = C1.collision(C2);
-      } break;
-      case G2LIB_CLOTHOID: {
-        ClothoidCurve C1(obj1);
-        ClothoidCurve C2(obj2);
-        ok = C1.collision(C2);
-      } break;
-      case G2LIB_BIARC: {
-        Biarc B1(obj1);
-        Biarc B2(obj2);
-        ok = B1.collision(B2);
-      } break;
-      case G2LIB_BIARC_LIST: {
-        BiarcList BL1(obj1);
-        BiarcList BL2(obj2);
-        ok = BL1.collision(BL2);
-      } break;
-      case G2LIB_CLOTHOID_LIST: {
-        ClothoidList CL1(obj1);
-        ClothoidList CL2(obj2);
-        ok = CL1.collision(CL2);
-      } break;
-      case G2LIB_POLYLINE: {
-        PolyLine PL1(obj1);
-        PolyLine PL2(obj2);
-        ok = PL1.collision(PL2);
-      } break;
-    }
-    return ok;
+    static constexpr auto table = dispatch_table<CollisionKernel>();
+    return table[dispatch_index(obj1, obj2)](obj1, obj2);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   bool collision_ISO(BaseCurve const & obj1, real_type offs1, BaseCurve const & obj2, real_type offs2) {
-    bool ok = false;
-    switch (curve_promote(obj1.type(), obj2.type())) {
-      case G2LIB_LINE: {
-        LineSegment L1(obj1);
-        LineSegment L2(obj2);
-        ok = L1.collision_ISO(offs1, L2, offs2);
-      } break;
-      case G2LIB_CIRCLE: {
-        CircleArc C1(obj1);
-        CircleArc C2(obj2);
-        ok = C1.collision_ISO(offs1, C2, offs2);
-      } break;
-      case G2LIB_CLOTHOID: {
-        ClothoidCurve C1(obj1);
-        ClothoidCurve C2(obj2);
-        ok = C1.collision_ISO(offs1, C2, offs2);
-      } break;
-      case G2LIB_BIARC: {
-        Biarc B1(obj1);
-        Biarc B2(obj2);
-        ok = B1.collision_ISO(offs1, B2, offs2);
-      } break;
-      case G2LIB_BIARC_LIST: {
-        BiarcList BL1(obj1);
-        BiarcList BL2(obj2);
-        ok = BL1.collision_ISO(offs1, BL2, offs2);
-      } break;
-      case G2LIB_CLOTHOID_LIST: {
-        ClothoidList CL1(obj1);
-        ClothoidList CL2(obj2);
-        ok = CL1.collision_ISO(offs1, CL2, offs2);
-      } break;
-      case G2LIB_POLYLINE: {
-        PolyLine PL1(obj1);
-        PolyLine PL2(obj2);
-        ok = PL1.collision_ISO(offs1, PL2, offs2);
-      }
-    }
-    return ok;
+    static constexpr auto table = dispatch_table<CollisionISOKernel>();
+    return table[dispatch_index(obj1, obj2)](obj1, offs1, obj2, offs2);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void intersect(BaseCurve const & obj1, BaseCurve const & obj2, IntersectList & ilist, bool swap_s_vals) {
-    switch (curve_promote(obj1.type(), obj2.type())) {
-      case G2LIB_LINE: {
-        LineSegment L1(obj1);
-        LineSegment L2(obj2);
-        L1.intersect(L2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CIRCLE: {
-        CircleArc C1(obj1);
-        CircleArc C2(obj2);
-        C1.intersect(C2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CLOTHOID: {
-        ClothoidCurve C1(obj1);
-        ClothoidCurve C2(obj2);
-        C1.intersect(C2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_BIARC: {
-        Biarc B1(obj1);
-        Biarc B2(obj2);
-        B1.intersect(B2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_BIARC_LIST: {
-        BiarcList BL1(obj1);
-        BiarcList BL2(obj2);
-        BL1.intersect(BL2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CLOTHOID_LIST: {
-        ClothoidList CL1(obj1);
-        ClothoidList CL2(obj2);
-        CL1.intersect(CL2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_POLYLINE: {
-        PolyLine PL1(obj1);
-        PolyLine PL2(obj2);
-        PL1.intersect(PL2, ilist, swap_s_vals);
-      } break;
-    }
+    static constexpr auto table = dispatch_table<IntersectKernel>();
+    table[dispatch_index(obj1, obj2)](obj1, obj2, ilist, swap_s_vals);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -191,43 +183,34 @@ namespace G2lib {
       real_type         offs2,
       IntersectList &   ilist,
       bool              swap_s_vals) {
-    switch (curve_promote(obj1.type(), obj2.type())) {
-      case G2LIB_LINE: {
-        LineSegment L1(obj1);
-        LineSegment L2(obj2);
-        L1.intersect_ISO(offs1, L2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CIRCLE: {
-        CircleArc C1(obj1);
-        CircleArc C2(obj2);
-        C1.intersect_ISO(offs1, C2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CLOTHOID: {
-        ClothoidCurve C1(obj1);
-        ClothoidCurve C2(obj2);
-        C1.intersect_ISO(offs1, C2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_BIARC: {
-        Biarc B1(obj1);
-        Biarc B2(obj2);
-        B1.intersect_ISO(offs1, B2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_BIARC_LIST: {
-        BiarcList BL1(obj1);
-        BiarcList BL2(obj2);
-        BL1.intersect_ISO(offs1, BL2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_CLOTHOID_LIST: {
-        ClothoidList CL1(obj1);
-        ClothoidList CL2(obj2);
-        CL1.intersect_ISO(offs1, CL2, offs2, ilist, swap_s_vals);
-      } break;
-      case G2LIB_POLYLINE: {
-        PolyLine PL1(obj1);
-        PolyLine PL2(obj2);
-        PL1.intersect_ISO(offs1, PL2, offs2, ilist, swap_s_vals);
-      } break;
+    static constexpr auto table = dispatch_table<IntersectISOKernel>();
+    table[dispatch_index(obj1, obj2)](obj1, offs1, obj2, offs2, ilist, swap_s_vals);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  bool BaseCurve::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    // the ray as a segment clipped to the bounding box of the curve
+    real_type xmin, ymin, xmax, ymax;
+    this->bbox(xmin, ymin, xmax, ymax);
+    real_type L = Utils::ray_reach(x, y, xmin, ymin, xmax, ymax, max_range);
+    if (!(L > 0))
+      return false;
+
+    LineSegment ray;
+    ray.build(x, y, std::atan2(dy, dx), L);
+    IntersectList ilist;
+    G2lib::intersect(*this, ray, ilist, false);
+    bool hit = false;
+    for (auto const & st : ilist) {
+      if (!hit || st.second < t) {
+        hit = true;
+        s   = st.first;
+        t   = st.second;
+      }
     }
+    return hit;
   }
 }  // namespace G2lib
 
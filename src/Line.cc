@@ -268,7 +268,7 @@ namespace G2lib {
     real_type nx = (ymax - ymin) / 100;
     real_type ny = (xmin - xmax) / 100;
     if (xmax > xmin || ymax > ymin) {
-      Triangle2D t(xmin, ymin, xmax, ymax, xc + nx, yc + ny, 0, 0, icurve);
+      Triangle2D t(xmin, ymin, xmax, ymax, xc + nx, yc + ny, 0, m_L, icurve);
       tvec.push_back(t);
     } else {
       G2LIB_UTILS_ERROR(
@@ -289,7 +289,7 @@ namespace G2lib {
     real_type nx = (ymax - ymin) / 100;
     real_type ny = (xmin - xmax) / 100;
     if (xmax > xmin || ymax > ymin) {
-      Triangle2D t(xmin, ymin, xmax, ymax, xc + nx, yc + ny, 0, 0, icurve);
+      Triangle2D t(xmin, ymin, xmax, ymax, xc + nx, yc + ny, 0, m_L, icurve);
       tvec.push_back(t);
     } else {
       G2LIB_UTILS_ERROR(
@@ -426,6 +426,36 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  bool LineSegment::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    // solve P0 + s*T = (x,y) + t*D with the cross products of T and D
+    real_type wx  = m_x0 - x;
+    real_type wy  = m_y0 - y;
+    real_type det = m_c0 * dy - m_s0 * dx;
+    real_type eps = Utils::machepsi100 * max(m_L, hypot(wx, wy));  // max_range may be infinite
+    if (std::abs(det) > Utils::machepsi100) {
+      s = (dx * wy - dy * wx) / det;
+      t = (m_c0 * wy - m_s0 * wx) / det;
+      if (s < -eps || s > m_L + eps || t < -eps || t > max_range)
+        return false;
+      s = min(max(s, real_type(0)), m_L);
+      t = max(t, real_type(0));
+      return true;
+    }
+    // parallel, the ray hits only if it runs along the segment
+    if (std::abs(dx * wy - dy * wx) > eps)
+      return false;
+    real_type t0 = wx * dx + wy * dy;
+    real_type t1 = t0 + m_L * (m_c0 * dx + m_s0 * dy);
+    if (max(t0, t1) < 0 || min(t0, t1) > max_range)
+      return false;
+    t = max(min(t0, t1), real_type(0));
+    s = min(max((t * dx - wx) * m_c0 + (t * dy - wy) * m_s0, real_type(0)), m_L);
+    return true;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   bool LineSegment::collision(LineSegment const & S) const {
     // The main function that returns true if line segment 'p1q1'
     // and 'p2q2' intersect.
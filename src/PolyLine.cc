@@ -129,10 +129,19 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   int_type PolyLine::findAtS(real_type & s) const {
-    auto lastInterval = m_lastInterval.search(std::this_thread::get_id());
-    Utils::search_interval<int_type, real_type>(
-        static_cast<int_type>(m_s0.size()), &m_s0.front(), s, lastInterval, false, true);
-    return *lastInterval;
+    return findAtS(s, m_lastInterval.get());
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  int_type PolyLine::findAtS(real_type & s, int_type & hint) const {
+    int_type npts = static_cast<int_type>(m_s0.size());
+    if (hint < 0 || hint >= npts - 1) hint = 0;  // the list may have changed
+    // outside the hinted interval jump directly to the bin of s
+    real_type const * S = m_s0.data();
+    if ((s < S[hint] || s > S[hint + 1]) && m_s_index.valid_for(npts, S)) hint = m_s_index.guess(s, S);
+    Utils::search_interval<int_type, real_type>(npts, &m_s0.front(), s, hint, false, true);
+    return hint;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -141,6 +150,7 @@ namespace G2lib {
     m_s0.clear();
     m_polylineList.clear();
     this->resetLastInterval();
+    m_s_index.clear();
     m_aabb_done = false;
     this->resetLastInterval();
   }
@@ -153,6 +163,26 @@ namespace G2lib {
     std::copy(PL.m_polylineList.begin(), PL.m_polylineList.end(), back_inserter(m_polylineList));
     m_s0.reserve(PL.m_s0.size());
     std::copy(PL.m_s0.begin(), PL.m_s0.end(), back_inserter(m_s0));
+    m_xe      = PL.m_xe;
+    m_ye      = PL.m_ye;
+    m_s_index = PL.m_s_index;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::move_from(PolyLine & PL) noexcept {
+    if (this == &PL) return;
+    m_polylineList = std::move(PL.m_polylineList);
+    m_s0           = std::move(PL.m_s0);
+    m_xe           = PL.m_xe;
+    m_ye           = PL.m_ye;
+    m_s_index      = std::move(PL.m_s_index);
+    m_aabb_done    = PL.m_aabb_done;
+    m_aabb_tree    = std::move(PL.m_aabb_tree);
+    PL.m_polylineList.clear();
+    PL.m_s0.clear();
+    PL.m_s_index.clear();
+    PL.m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -304,6 +334,8 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -324,6 +356,8 @@ namespace G2lib {
       newy0       = ic->y_end();
       m_s0[k + 1] = m_s0[k] + ic->length();
     }
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -335,6 +369,7 @@ namespace G2lib {
       newx0 = ic->x_end();
       newy0 = ic->y_end();
     }
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -357,6 +392,8 @@ namespace G2lib {
     for (; ic != m_polylineList.end(); ++ic, ++k)
       m_s0[k + 1] = m_s0[k] + ic->length();
     this->resetLastInterval();
+    if (!m_s_index.empty()) this->build_s_index();
+    m_aabb_done = false;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -421,16 +458,43 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void PolyLine::build_AABBtree(AABBtree & aabbtree) const {
-    vector<shared_ptr<BBox const>> bboxes;
-    bboxes.reserve(m_polylineList.size());
+    // one allocation for all the boxes
+    BBoxPool                            pool(int_type(m_polylineList.size()));
     vector<LineSegment>::const_iterator it;
     int_type                            ipos = 0;
     for (it = m_polylineList.begin(); it != m_polylineList.end(); ++it, ++ipos) {
       real_type xmin, ymin, xmax, ymax;
       it->bbox(xmin, ymin, xmax, ymax);
-      bboxes.push_back(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_LINE, ipos));
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_LINE, ipos);
+    }
+    aabbtree.build(pool);
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::aabb_push_back() {
+    if (!m_aabb_done)
+      return;
+    // the handle of a segment in the tree is its position
+    real_type xmin, ymin, xmax, ymax;
+    m_polylineList.back().bbox(xmin, ymin, xmax, ymax);
+    int_type ipos = int_type(m_polylineList.size()) - 1;
+    m_aabb_tree.insert(make_shared<BBox const>(xmin, ymin, xmax, ymax, G2LIB_LINE, ipos));
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  void PolyLine::aabb_refit() {
+    if (!m_aabb_done)
+      return;
+    BBoxPool pool(int_type(m_polylineList.size()));
+    int_type ipos = 0;
+    for (LineSegment const & LS : m_polylineList) {
+      real_type xmin, ymin, xmax, ymax;
+      LS.bbox(xmin, ymin, xmax, ymax);
+      pool.add(xmin, ymin, xmax, ymax, G2LIB_LINE, ipos++);
     }
-    aabbtree.build(bboxes);
+    m_aabb_tree.refit(pool);
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -441,6 +505,7 @@ namespace G2lib {
     m_polylineList.clear();
     m_s0.clear();
     m_s0.push_back(0);
+    m_s_index.clear();
     m_aabb_done = false;
   }
 
@@ -452,9 +517,10 @@ namespace G2lib {
     m_polylineList.push_back(s);
     real_type slast = m_s0.back() + s.length();
     m_s0.push_back(slast);
-    m_xe        = x;
-    m_ye        = y;
-    m_aabb_done = false;
+    m_xe = x;
+    m_ye = y;
+    this->aabb_push_back();
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -465,9 +531,10 @@ namespace G2lib {
     S.change_origin(m_xe, m_ye);
     real_type slast = m_s0.back() + S.length();
     m_s0.push_back(slast);
-    m_xe        = S.x_end();
-    m_ye        = S.y_end();
-    m_aabb_done = false;
+    m_xe = S.x_end();
+    m_ye = S.y_end();
+    this->aabb_push_back();
+    m_s_index.extend(int_type(m_s0.size()), m_s0.data());
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -482,9 +549,8 @@ namespace G2lib {
       push_back(tx + C.X(s), ty + C.Y(s));
     }
     push_back(tx + C.x_end(), ty + C.y_end());
-    m_xe        = tx + C.x_end();
-    m_ye        = ty + C.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C.x_end();
+    m_ye = ty + C.y_end();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -510,9 +576,8 @@ namespace G2lib {
       push_back(tx + C1.X(s), ty + C1.Y(s));
     }
     push_back(tx + C1.x_end(), ty + C1.y_end());
-    m_xe        = tx + C1.x_end();
-    m_ye        = ty + C1.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C1.x_end();
+    m_ye = ty + C1.y_end();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -533,9 +598,8 @@ namespace G2lib {
     }
 
     push_back(tx + C.x_end(), ty + C.y_end());
-    m_xe        = tx + C.x_end();
-    m_ye        = ty + C.y_end();
-    m_aabb_done = false;
+    m_xe = tx + C.x_end();
+    m_ye = ty + C.y_end();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -555,6 +619,7 @@ namespace G2lib {
     init(x[0], y[0]);
     for (int_type k = 1; k < npts; ++k)
       push_back(x[k], y[k]);
+    this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -569,6 +634,7 @@ namespace G2lib {
   void PolyLine::build(CircleArc const & C, real_type tol) {
     init(C.x_begin(), C.y_begin());
     push_back(C, tol);
+    this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -576,6 +642,7 @@ namespace G2lib {
   void PolyLine::build(Biarc const & C, real_type tol) {
     init(C.x_begin(), C.y_begin());
     push_back(C, tol);
+    this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -583,6 +650,7 @@ namespace G2lib {
   void PolyLine::build(ClothoidCurve const & C, real_type tol) {
     init(C.x_begin(), C.y_begin());
     push_back(C, tol);
+    this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -590,6 +658,7 @@ namespace G2lib {
   void PolyLine::build(ClothoidList const & L, real_type tol) {
     init(L.x_begin(), L.y_begin());
     push_back(L, tol);
+    this->build_s_index();
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -672,12 +741,11 @@ namespace G2lib {
 #if 1
     build_AABBtree();
     pl.build_AABBtree();
-    AABBtree::VecPairPtrBBox intersectionList;
-    m_aabb_tree.intersect(pl.m_aabb_tree, intersectionList);
-    AABBtree::VecPairPtrBBox::const_iterator ip;
-    for (ip = intersectionList.begin(); ip != intersectionList.end(); ++ip) {
-      size_t ipos0 = size_t(ip->first->Ipos());
-      size_t ipos1 = size_t(ip->second->Ipos());
+    vector<pair<int_type, int_type>> intersectionList;
+    m_aabb_tree.intersect(pl.m_aabb_tree, intersectionList, false, intersect_num_threads);
+    for (auto const & [i0, i1] : intersectionList) {
+      size_t ipos0 = size_t(i0);
+      size_t ipos1 = size_t(i1);
       G2LIB_UTILS_ASSERT(ipos0 < m_polylineList.size(), "Bad ipos0 = %d\n", ipos0);
       G2LIB_UTILS_ASSERT(ipos1 < pl.m_polylineList.size(), "Bad ipos1 = %d\n", ipos1);
       real_type sss0, sss1;
@@ -728,7 +796,7 @@ namespace G2lib {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   void PolyLine::intersect_ISO(
-      real_type offs, PolyLine const & pl, real_type offs_pl, IntersectList & ilist, bool swap_s_vals) {
+      real_type offs, PolyLine const & pl, real_type offs_pl, IntersectList & ilist, bool swap_s_vals) const {
     G2LIB_UTILS_ASSERT0(
         Utils::isZero(offs) && Utils::isZero(offs_pl), "PolyLine::intersect( offs ... ) not available!\n");
     this->intersect(pl, ilist, swap_s_vals);
@@ -736,6 +804,26 @@ namespace G2lib {
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+  bool PolyLine::raycast_unit(
+      real_type x, real_type y, real_type dx, real_type dy, real_type max_range, real_type & s, real_type & t) const {
+    this->build_AABBtree();
+    bool hit    = false;
+    auto refine = [&](AABBtree::PtrBBox const & box, real_type, real_type) -> real_type {
+      size_t    iseg = size_t(box->Ipos());
+      real_type ss, tt;
+      if (m_polylineList[iseg].raycast_unit(x, y, dx, dy, hit ? t : max_range, ss, tt) && (!hit || tt < t)) {
+        hit = true;
+        s   = ss + m_s0[iseg];
+        t   = tt;
+      }
+      return hit ? t : max_range;
+    };
+    m_aabb_tree.raycast(x, y, dx, dy, max_range, refine);
+    return hit;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
   ostream_type & operator<<(ostream_type & stream, PolyLine const & P) {
     stream << Utils::format_string(
         "nseg    = %f\n"
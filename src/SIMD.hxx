@@ -0,0 +1,295 @@
+/** * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ * @file SIMD.hxx
+ * @author Matteo Ragni (info@ragni.me)
+ *
+ * @copyright Copyright (c) 2022 Matteo Ragni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Based on the work of:
+ * Enrico Bertolazzi http://ebertolazzi.github.io/Clothoids/
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+#pragma once
+
+//
+// Thin wrapper over the double precision vector registers of the target. The
+// width is selected at compile time from the instruction set enabled for the
+// translation unit (see the CLOTHOIDS_ENABLE_NATIVE_ARCH cmake option):
+//
+//  - AVX-512F           -> 8 lanes
+//  - AVX2 + FMA         -> 4 lanes
+//  - anything else      -> G2LIB_SIMD_WIDTH is 1, no vector type is defined and
+//                          the batch kernels fall back to the scalar routines.
+//
+// There is no run time dispatch: a default build targets the baseline
+// instruction set of the compiler (SSE2 on x86-64), so every batch kernel
+// runs the scalar fallback. Build with CLOTHOIDS_ENABLE_NATIVE_ARCH, or with
+// -mavx2 -mfma / -mavx512f in the compiler flags, to get the vector kernels.
+//
+// Only the handful of operations required by the batch kernels are exposed.
+// Masks are opaque, and are consumed by `select`, `any` and the mask operators.
+//
+
+#if defined(G2LIB_DISABLE_SIMD)
+#define G2LIB_SIMD_WIDTH 1
+#elif defined(__AVX512F__)
+#define G2LIB_SIMD_WIDTH 8
+#elif defined(__AVX2__) && defined(__FMA__)
+#define G2LIB_SIMD_WIDTH 4
+#else
+#define G2LIB_SIMD_WIDTH 1
+#endif
+
+#if G2LIB_SIMD_WIDTH > 1
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+
+#include "Clothoids/Types.hxx"
+#include "Clothoids/Constants.hxx"
+
+namespace G2lib {
+  namespace Simd {
+
+    static constexpr int_type width = G2LIB_SIMD_WIDTH;
+
+#if G2LIB_SIMD_WIDTH == 8
+
+    struct vmask {
+      __mmask8 m;
+    };
+
+    struct vreal {
+      __m512d v;
+      vreal() = default;
+      vreal(__m512d x) : v(x) {}
+      vreal(real_type x) : v(_mm512_set1_pd(x)) {}
+    };
+
+    inline vreal load(real_type const * p) { return _mm512_loadu_pd(p); }
+    inline void  store(real_type * p, vreal const & a) { _mm512_storeu_pd(p, a.v); }
+
+    //! Lane `i` is `p[idx[i]]`
+    inline vreal gather(real_type const * p, int_type const * idx) {
+      if constexpr (sizeof(int_type) == 4)
+        return _mm512_mask_i32gather_pd(
+            _mm512_setzero_pd(), 0xFF, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(idx)), p, 8);
+      else
+        return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, _mm512_loadu_si512(idx), p, 8);
+    }
+
+    inline vreal operator+(vreal const & a, vreal const & b) { return _mm512_add_pd(a.v, b.v); }
+    inline vreal operator-(vreal const & a, vreal const & b) { return _mm512_sub_pd(a.v, b.v); }
+    inline vreal operator*(vreal const & a, vreal const & b) { return _mm512_mul_pd(a.v, b.v); }
+    inline vreal operator/(vreal const & a, vreal const & b) { return _mm512_div_pd(a.v, b.v); }
+    inline vreal operator-(vreal const & a) { return _mm512_sub_pd(_mm512_setzero_pd(), a.v); }
+
+    //! `a * b + c` with a single rounding
+    inline vreal fma(vreal const & a, vreal const & b, vreal const & c) { return _mm512_fmadd_pd(a.v, b.v, c.v); }
+    inline vreal abs(vreal const & a) { return _mm512_abs_pd(a.v); }
+    inline vreal sqrt(vreal const & a) { return _mm512_mask_sqrt_pd(a.v, 0xFF, a.v); }
+    inline vreal round(vreal const & a) { return _mm512_mask_roundscale_pd(a.v, 0xFF, a.v, _MM_FROUND_TO_NEAREST_INT); }
+    inline vreal floor(vreal const & a) { return _mm512_mask_roundscale_pd(a.v, 0xFF, a.v, _MM_FROUND_TO_NEG_INF); }
+    inline vreal min(vreal const & a, vreal const & b) { return _mm512_min_pd(a.v, b.v); }
+    inline vreal max(vreal const & a, vreal const & b) { return _mm512_max_pd(a.v, b.v); }
+
+    inline vmask operator<(vreal const & a, vreal const & b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ) }; }
+    inline vmask operator<=(vreal const & a, vreal const & b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ) }; }
+    inline vmask operator>(vreal const & a, vreal const & b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ) }; }
+    inline vmask operator>=(vreal const & a, vreal const & b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ) }; }
+    inline vmask operator==(vreal const & a, vreal const & b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ) }; }
+
+    inline vmask operator&(vmask const & a, vmask const & b) { return { static_cast<__mmask8>(a.m & b.m) }; }
+    inline vmask operator|(vmask const & a, vmask const & b) { return { static_cast<__mmask8>(a.m | b.m) }; }
+    inline vmask operator!(vmask const & a) { return { static_cast<__mmask8>(~a.m) }; }
+    inline bool  any(vmask const & a) { return a.m != 0; }
+    inline bool  all(vmask const & a) { return a.m == 0xFF; }
+    //! bit `i` set if lane `i` is set
+    inline unsigned bits(vmask const & a) { return a.m; }
+
+    //! Lane-wise `m ? a : b`
+    inline vreal select(vmask const & m, vreal const & a, vreal const & b) { return _mm512_mask_blend_pd(m.m, b.v, a.v); }
+
+#elif G2LIB_SIMD_WIDTH == 4
+
+    struct vmask {
+      __m256d m;
+    };
+
+    struct vreal {
+      __m256d v;
+      vreal() = default;
+      vreal(__m256d x) : v(x) {}
+      vreal(real_type x) : v(_mm256_set1_pd(x)) {}
+    };
+
+    inline vreal load(real_type const * p) { return _mm256_loadu_pd(p); }
+    inline void  store(real_type * p, vreal const & a) { _mm256_storeu_pd(p, a.v); }
+
+    //! Lane `i` is `p[idx[i]]`
+    inline vreal gather(real_type const * p, int_type const * idx) {
+      __m256d const ones = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+      if constexpr (sizeof(int_type) == 4)
+        return _mm256_mask_i32gather_pd(
+            _mm256_setzero_pd(), p, _mm_loadu_si128(reinterpret_cast<__m128i const *>(idx)), ones, 8);
+      else
+        return _mm256_mask_i64gather_pd(
+            _mm256_setzero_pd(), p, _mm256_loadu_si256(reinterpret_cast<__m256i const *>(idx)), ones, 8);
+    }
+
+    inline vreal operator+(vreal const & a, vreal const & b) { return _mm256_add_pd(a.v, b.v); }
+    inline vreal operator-(vreal const & a, vreal const & b) { return _mm256_sub_pd(a.v, b.v); }
+    inline vreal operator*(vreal const & a, vreal const & b) { return _mm256_mul_pd(a.v, b.v); }
+    inline vreal operator/(vreal const & a, vreal const & b) { return _mm256_div_pd(a.v, b.v); }
+    inline vreal operator-(vreal const & a) { return _mm256_sub_pd(_mm256_setzero_pd(), a.v); }
+
+    //! `a * b + c` with a single rounding
+    inline vreal fma(vreal const & a, vreal const & b, vreal const & c) { return _mm256_fmadd_pd(a.v, b.v, c.v); }
+    inline vreal abs(vreal const & a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+    inline vreal sqrt(vreal const & a) { return _mm256_sqrt_pd(a.v); }
+    inline vreal round(vreal const & a) { return _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    inline vreal floor(vreal const & a) { return _mm256_floor_pd(a.v); }
+    inline vreal min(vreal const & a, vreal const & b) { return _mm256_min_pd(a.v, b.v); }
+    inline vreal max(vreal const & a, vreal const & b) { return _mm256_max_pd(a.v, b.v); }
+
+    inline vmask operator<(vreal const & a, vreal const & b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+    inline vmask operator<=(vreal const & a, vreal const & b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+    inline vmask operator>(vreal const & a, vreal const & b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+    inline vmask operator>=(vreal const & a, vreal const & b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ) }; }
+    inline vmask operator==(vreal const & a, vreal const & b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ) }; }
+
+    inline vmask operator&(vmask const & a, vmask const & b) { return { _mm256_and_pd(a.m, b.m) }; }
+    inline vmask operator|(vmask const & a, vmask const & b) { return { _mm256_or_pd(a.m, b.m) }; }
+    inline vmask operator!(vmask const & a) {
+      return { _mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))) };
+    }
+    inline bool any(vmask const & a) { return _mm256_movemask_pd(a.m) != 0; }
+    inline bool all(vmask const & a) { return _mm256_movemask_pd(a.m) == 0xF; }
+    //! bit `i` set if lane `i` is set
+    inline unsigned bits(vmask const & a) { return unsigned(_mm256_movemask_pd(a.m)); }
+
+    //! Lane-wise `m ? a : b`
+    inline vreal select(vmask const & m, vreal const & a, vreal const & b) { return _mm256_blendv_pd(b.v, a.v, m.m); }
+
+#endif
+
+#if G2LIB_SIMD_WIDTH > 1
+
+    //!
+    //! Evaluate the polynomial `c[0] + c[1] x + ... + c[N-1] x^(N-1)`
+    //! with the Horner scheme
+    //!
+    template<int_type N>
+    inline vreal horner(real_type const (&c)[N], vreal const & x) {
+      vreal r(c[N - 1]);
+      for (int_type k = N - 2; k >= 0; --k) r = fma(r, x, vreal(c[k]));
+      return r;
+    }
+
+    //!
+    //! Compute \f$ \sin(\pi n / 2 + a) \f$ and \f$ \cos(\pi n / 2 + a) \f$
+    //! for integer \f$ n \f$ and \f$ |a| \leq \pi/4 \f$.
+    //!
+    inline void sincos_quadrant(vreal const & n, vreal const & a, vreal & s, vreal & c) {
+      static real_type const sin_c[] = { 1.0,
+                                         -0.16666666666666666,
+                                         0.008333333333333333,
+                                         -0.0001984126984126984,
+                                         2.7557319223985893e-06,
+                                         -2.505210838544172e-08,
+                                         1.6059043836821613e-10,
+                                         -7.647163731819816e-13,
+                                         2.8114572543455206e-15 };
+      static real_type const cos_c[] = { 1.0,
+                                         -0.5,
+                                         0.041666666666666664,
+                                         -0.001388888888888889,
+                                         2.48015873015873e-05,
+                                         -2.755731922398589e-07,
+                                         2.08767569878681e-09,
+                                         -1.1470745597729725e-11,
+                                         4.779477332387385e-14 };
+      vreal a2 = a * a;
+      vreal sa = a * horner(sin_c, a2);
+      vreal ca = horner(cos_c, a2);
+
+      // quadrant k = n mod 4, evaluated in floating point
+      vreal k  = n - vreal(4.0) * floor(n * vreal(0.25));
+      vmask k1 = k == vreal(1.0);
+      vmask k2 = k == vreal(2.0);
+      vmask k3 = k == vreal(3.0);
+      s        = select(k1, ca, select(k2, -sa, select(k3, -ca, sa)));
+      c        = select(k1, -sa, select(k2, -ca, select(k3, sa, ca)));
+    }
+
+    //!
+    //! Compute \f$ \sin(\pi q / 2) \f$ and \f$ \cos(\pi q / 2) \f$ given
+    //! \f$ q = q_{hi} + q_{lo} \f$ (the low part is the rounding error of
+    //! \f$ q_{hi} \f$, as returned by `fma`). The reduction is performed on
+    //! \f$ q \f$ rather than on the angle, thus it is exact as long as
+    //! \f$ |q_{hi}| < 2^{52} \f$.
+    //!
+    inline void sincos_pi_2(vreal const & q_hi, vreal const & q_lo, vreal & s, vreal & c) {
+      vreal n = round(q_hi);
+      sincos_quadrant(n, ((q_hi - n) + q_lo) * vreal(Utils::m_pi_2), s, c);
+    }
+
+    //!
+    //! Compute \f$ \sin(x) \f$ and \f$ \cos(x) \f$. The argument is reduced
+    //! with a three terms Cody-Waite splitting of \f$ \pi/2 \f$, lanes with
+    //! \f$ |x| > 10^6 \f$ (where the splitting is no more accurate) are
+    //! evaluated with the standard library.
+    //!
+    inline void sincos(vreal const & x, vreal & s, vreal & c) {
+      real_type const pio2_1 = 1.57079632673412561417e+00;
+      real_type const pio2_2 = 6.07710050630396597660e-11;
+      real_type const pio2_3 = 2.02226624879595063154e-21;
+
+      vreal n = round(x * vreal(2 * Utils::m_1_pi));
+      vreal a = fma(n, vreal(-pio2_1), x);
+      a       = fma(n, vreal(-pio2_2), a);
+      a       = fma(n, vreal(-pio2_3), a);
+      sincos_quadrant(n, a, s, c);
+
+      vmask const huge = abs(x) > vreal(1e6);
+      if (any(huge)) {
+        real_type xx[width], ss[width], cc[width];
+        store(xx, x);
+        store(ss, s);
+        store(cc, c);
+        for (int_type i = 0; i < width; ++i) {
+          if (std::abs(xx[i]) > 1e6) {
+            ss[i] = std::sin(xx[i]);
+            cc[i] = std::cos(xx[i]);
+          }
+        }
+        s = load(ss);
+        c = load(cc);
+      }
+    }
+
+#endif
+
+  }  // namespace Simd
+}  // namespace G2lib
+
+///
+/// eof: SIMD.hxx
+///
@@ -32,6 +32,10 @@
 #include <algorithm>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <vector>
 #include <cmath>
 #include <limits>
 #include <string>
@@ -54,6 +58,17 @@ namespace G2lib {
       return !(FP_INFINITE == std::fpclassify(x) || FP_NAN == std::fpclassify(x));
     }
 
+    //!
+    //! Length of a ray from `(x,y)` reaching every point of the box
+    //! `[xmin,xmax]x[ymin,ymax]`, at most `max_range` (which may be infinite).
+    //!
+    static inline real_type ray_reach(
+        real_type x, real_type y, real_type xmin, real_type ymin, real_type xmax, real_type ymax, real_type max_range) {
+      real_type dx = std::max(std::abs(x - xmin), std::abs(x - xmax));
+      real_type dy = std::max(std::abs(y - ymin), std::abs(y - ymax));
+      return std::min(max_range, std::hypot(dx, dy) * (1 + 1e-10));
+    }
+
     // template<typename T_int, typename T_real>
     // void search_interval(
     //     T_int npts, T_real const * X, T_real & x, std::shared_ptr<T_int> lastInterval, bool closed, bool can_extend) {
@@ -62,16 +77,16 @@ namespace G2lib {
     // }
 
     template<typename T_int, typename T_real>
-    void search_interval(T_int npts, T_real const * X, T_real & x, std::shared_ptr<T_int> lastInterval, bool closed, bool can_extend) {
+    void search_interval(T_int npts, T_real const * X, T_real & x, T_int & lastInterval, bool closed, bool can_extend) {
       // For this implementation we must ensure a number of points greater than 1 (there
       // must be at least one interval). The number of intervals is npts - 2. The last
       // point is in n = npts - 1;
       const T_int n = npts - 1;
       G2LIB_UTILS_ASSERT(
-          npts > 1 && *lastInterval >= 0 && *lastInterval < n,
+          npts > 1 && lastInterval >= 0 && lastInterval < n,
           "In search_interval( npts=%d, X, x=%d, lastInterval=%d, closed=%d, can_extend=%d)\n"
           "npts musrt be >= 2 and lastInterval must be in [0,npts-2]\n",
-          npts, x, *lastInterval, closed, can_extend);
+          npts, x, lastInterval, closed, can_extend);
 
       // Handles the "closed" search, by limiting the value of x for the search inside the
       // limit of [X[0], X[n]]. This function will use fmod for detecting multiple "loops".
@@ -91,11 +106,11 @@ namespace G2lib {
             can_extend || (x >= xl && x <= xr),
             "In search_interval( npts=%d, X, x=%f, lastInterval=%d, closed=%d, can_extend=%d)\n"
             "out of range: [%f,%f]\n",
-            npts, x, *lastInterval, closed, can_extend, xl, xr);
+            npts, x, lastInterval, closed, can_extend, xl, xr);
       }
 
       // Find the interval of the support of the B-spline, using lastInterval as an hot start
-      T_real const * XL = X + *lastInterval;
+      T_real const * XL = X + lastInterval;
 
       // We must consider 3 possible scenario:
       // 1. the searched point lies on the right of the current interval
@@ -107,15 +122,15 @@ namespace G2lib {
         // 1.2: the point is in the very next interval
         // 1.3: we must search the interval of the point in the intervals next to the current one, up to last
         if (x >= X[n - 1]) {
-          *lastInterval = n - 1;
+          lastInterval = n - 1;
         } else if (x < XL[2]) {
-          ++(*lastInterval);
+          ++lastInterval;
         } else {
           T_real const * XE = X + n;
-          *lastInterval += T_int(std::lower_bound(XL, XE, x) - XL);
-          T_real const * XX = X + *lastInterval;
+          lastInterval += T_int(std::lower_bound(XL, XE, x) - XL);
+          T_real const * XX = X + lastInterval;
           if (x < XX[0] || isZero(XX[0] - XX[1]))
-            --(*lastInterval);
+            --lastInterval;
         }
       } else if (x < XL[0]) /* situation 2. */ {
         // We considers three situations in order to maximize performances:
@@ -123,22 +138,76 @@ namespace G2lib {
         // 1.2: the point is in the very next interval
         // 1.3: we must search the interval of the point in the intervals next to the current one, up to first
         if (x <= X[1]) {
-          *lastInterval = 0;
+          lastInterval = 0;
         } else if (XL[-1] <= x) {
-          --(*lastInterval);
+          --lastInterval;
         } else {
-          *lastInterval      = T_int(std::lower_bound(X + 1, XL, x) - X);
-          T_real const * XX = X + *lastInterval;
+          lastInterval      = T_int(std::lower_bound(X + 1, XL, x) - X);
+          T_real const * XX = X + lastInterval;
           if (x < XX[0] || isZero(XX[0] - XX[1]))
-            --*lastInterval;
+            --lastInterval;
         }
       } /* situation 3: Do nothing. */
       // Check the computed interval
       G2LIB_UTILS_ASSERT(
-          *lastInterval >= 0 && *lastInterval < n,
+          lastInterval >= 0 && lastInterval < n,
           "In search_interval( npts=%d, X, x=%f, lastInterval=%d, closed=%d, can_extend=%d)\n"
           "computed lastInterval of range: [%f,%f]\n",
-          npts, x, *lastInterval, closed, can_extend, xl, xr);
+          npts, x, lastInterval, closed, can_extend, xl, xr);
+    }
+
+    template<typename T_int, typename T_real>
+    void search_interval(
+        T_int npts, T_real const * X, T_real & x, std::shared_ptr<T_int> lastInterval, bool closed, bool can_extend) {
+      search_interval<T_int, T_real>(npts, X, x, *lastInterval, closed, can_extend);
+    }
+
+    //!
+    //! Number of workers for `n_threads` (`0` = hardware concurrency), at
+    //! most one for each block of `min_chunk` of the `n` tasks.
+    //!
+    template<typename T_int>
+    T_int num_workers(T_int n, T_int n_threads, T_int min_chunk) {
+      T_int nt = n_threads > 0 ? n_threads : T_int(std::thread::hardware_concurrency());
+      return std::clamp(std::min(nt, n / min_chunk), T_int(1), std::max(n, T_int(1)));
+    }
+
+    //!
+    //! Call `fun(k)` for `k` in `[0,n)` on `nt` workers, the calling thread
+    //! included. The workers take the next index from a shared counter so
+    //! tasks of uneven cost are balanced, `fun` must be safe to call
+    //! concurrently for different `k`. The first exception thrown by `fun`
+    //! stops the remaining tasks and is rethrown on the calling thread
+    //! after all the workers are joined.
+    //!
+    template<typename T_int, typename FUN>
+    void parallel_for(T_int n, T_int nt, FUN const & fun) {
+      if (nt <= 1) {
+        for (T_int k = 0; k < n; ++k) fun(k);
+        return;
+      }
+      std::atomic<T_int> next{0};
+      std::exception_ptr error;
+      std::mutex         error_mutex;
+      auto               work = [&] {
+        try {
+          for (T_int k = next++; k < n; k = next++) fun(k);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) error = std::current_exception();
+          next = n;  // the other workers stop at their next task
+        }
+      };
+      std::vector<std::thread> workers;
+      workers.reserve(size_t(nt - 1));
+      try {
+        for (T_int t = 1; t < nt; ++t) workers.emplace_back(work);
+      } catch (std::system_error const &) {
+        // no more threads available, the started workers share the tasks
+      }
+      work();
+      for (auto & w : workers) w.join();
+      if (error) std::rethrow_exception(error);
     }
 
   }  // namespace Utils
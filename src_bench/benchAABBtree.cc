@@ -0,0 +1,129 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using namespace std;
+
+// the only API used is the one of the former tree, the same file can be
+// compiled against the previous version of the library
+
+// allocations counted by replacing the global operator new
+static size_t n_alloc = 0, n_bytes = 0;
+
+void *
+operator new( size_t sz ) {
+  ++n_alloc;
+  n_bytes += sz;
+  void * p = malloc( sz == 0 ? 1 : sz );
+  if ( p == nullptr ) throw bad_alloc();
+  return p;
+}
+
+void operator delete( void * p ) noexcept { free( p ); }
+void operator delete( void * p, size_t ) noexcept { free( p ); }
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+// a spiral road of `n` segments, rotated by `a` around the origin
+static void
+road( G2lib::ClothoidList & C, int_type n, real_type a ) {
+  C.init();
+  C.push_back( 10*sin(a), -10*cos(a), a, 0.1, 0, 5 );
+  for ( int_type i = 1; i < n; ++i ) {
+    real_type s = 5*i;
+    C.push_back( 1/(10+0.01*s), -0.01/pow(10+0.01*s,2), 5 );
+  }
+}
+
+// the boxes of the bounding triangles of the road
+static void
+boxes( G2lib::ClothoidList const & C, AABBtree::VecPtrBBox & B ) {
+  vector<G2lib::Triangle2D> T;
+  C.bbTriangles( T, G2lib::Utils::m_pi/18, 1 );
+  B.clear();
+  B.reserve( T.size() );
+  for ( size_t i = 0; i < T.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    T[i].bbox( xmin, ymin, xmax, ymax );
+    B.push_back( make_shared<G2lib::BBox>( xmin, ymin, xmax, ymax, int_type(i), int_type(i) ) );
+  }
+}
+
+int
+main() {
+
+  G2lib::ClothoidList C1, C2;
+  road( C1, 3000, 0 );
+  road( C2, 3000, 0.5 );
+  AABBtree::VecPtrBBox B1, B2;
+  boxes( C1, B1 );
+  boxes( C2, B2 );
+  cout << "two spiral roads, " << B1.size() << " and " << B2.size() << " boxes, best of 5\n";
+
+  // build
+  size_t a0 = 0, b0 = 0;
+  real_type tb = best_ns( 5, [&]() {
+    AABBtree T;
+    size_t na = n_alloc, nb = n_bytes;
+    T.build( B1 );
+    a0 = n_alloc-na;
+    b0 = n_bytes-nb;
+  } );
+  cout << "build        " << tb/1e6 << " ms  " << a0 << " allocations  " << b0/1024.0/1024.0 << " MB\n";
+
+  AABBtree T1, T2;
+  T1.build( B1 );
+  T2.build( B2 );
+
+  // intersect
+  AABBtree::VecPairPtrBBox P;
+  real_type ti = best_ns( 5, [&]() {
+    P.clear();
+    size_t na = n_alloc;
+    T1.intersect( T2, P );
+    a0 = n_alloc-na;
+  } );
+  cout << "intersect    " << ti/1e6 << " ms  " << a0 << " allocations  " << P.size() << " pairs\n";
+
+  // min_distance
+  int_type const       nq = 20000;
+  AABBtree::VecPtrBBox cand;
+  size_t               ncand = 0;
+  real_type tm = best_ns( 5, [&]() {
+    ncand = 0;
+    size_t na = n_alloc;
+    for ( int_type q = 0; q < nq; ++q ) {
+      real_type r = 200*real_type((q*7919LL)%nq)/nq;
+      real_type t = 0.00314*q;
+      cand.clear();
+      T1.min_distance( r*cos(t), r*sin(t), cand );
+      ncand += cand.size();
+    }
+    a0 = n_alloc-na;
+  } );
+  cout << "min_distance " << tm/nq/1e3 << " us per query  " << real_type(a0)/nq
+       << " allocations per query  " << real_type(ncand)/nq << " candidates per query\n";
+
+  return 0;
+}
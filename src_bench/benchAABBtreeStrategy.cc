@@ -0,0 +1,138 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using G2lib::AABBtreeStrategy;
+using namespace std;
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+// a spiral road of `n` segments, rotated by `a` around the origin
+static void
+road( G2lib::ClothoidList & C, int_type n, real_type a ) {
+  C.init();
+  C.push_back( 10*sin(a), -10*cos(a), a, 0.1, 0, 5 );
+  for ( int_type i = 1; i < n; ++i ) {
+    real_type s = 5*i;
+    C.push_back( 1/(10+0.01*s), -0.01/pow(10+0.01*s,2), 5 );
+  }
+}
+
+// the boxes of the bounding triangles of the road
+static void
+road_boxes( G2lib::ClothoidList const & C, AABBtree::VecPtrBBox & B ) {
+  vector<G2lib::Triangle2D> T;
+  C.bbTriangles( T, G2lib::Utils::m_pi/18, 1 );
+  B.clear();
+  for ( size_t i = 0; i < T.size(); ++i ) {
+    real_type xmin, ymin, xmax, ymax;
+    T[i].bbox( xmin, ymin, xmax, ymax );
+    B.push_back( make_shared<G2lib::BBox>( xmin, ymin, xmax, ymax, int_type(i), int_type(i) ) );
+  }
+}
+
+// `n` boxes in 20 clusters, sides from 0.01 to 5
+static void
+cluster_boxes( int_type n, int_type seed, AABBtree::VecPtrBBox & B ) {
+  B.clear();
+  for ( int_type i = 0; i < n; ++i ) {
+    int_type  c = (i*seed)%20;
+    real_type r = 30*pow( real_type((i*7919LL+seed)%1009)/1009, 2 );
+    real_type t = 0.0137*i*seed;
+    real_type x = 200*cos(2.1*c)+r*cos(t), y = 200*sin(3.7*c)+r*sin(t);
+    real_type w = 0.01+5*pow( real_type((i*104729LL)%1013)/1013, 4 );
+    real_type h = 0.01+5*pow( real_type((i*1299709LL)%1019)/1019, 4 );
+    B.push_back( make_shared<G2lib::BBox>( x, y, x+w, y+h, i, i ) );
+  }
+}
+
+static void
+bench( char const * what, AABBtree::VecPtrBBox const & B1, AABBtree::VecPtrBBox const & B2 ) {
+  struct { char const * what; AABBtreeStrategy s; } const strategies[] = {
+    { "Midpoint", AABBtreeStrategy::Midpoint },
+    { "Median  ", AABBtreeStrategy::Median },
+    { "SAH     ", AABBtreeStrategy::SAH }
+  };
+  int_type const nq = 20000;
+  cout << '\n' << what << ", " << B1.size() << " and " << B2.size() << " boxes, best of 5\n"
+       << "strategy  build ms  nodes  intersect ms  pairs  min_distance us  candidates\n";
+  for ( auto const & S : strategies ) {
+    AABBtree T1, T2;
+    T1.set_strategy( S.s );
+    T2.set_strategy( S.s );
+    real_type tb = best_ns( 5, [&]() { T1.build( B1 ); } );
+    T2.build( B2 );
+    vector<pair<int_type, int_type>> P;
+    real_type ti = best_ns( 5, [&]() { P.clear(); T1.intersect( T2, P ); } );
+    AABBtree::VecPtrBBox cand;
+    size_t               ncand = 0;
+    real_type tm = best_ns( 5, [&]() {
+      ncand = 0;
+      for ( int_type q = 0; q < nq; ++q ) {
+        real_type r = 250*real_type((q*7919LL)%nq)/nq;
+        real_type t = 0.00314*q;
+        cand.clear();
+        T1.min_distance( r*cos(t), r*sin(t), cand );
+        ncand += cand.size();
+      }
+    } );
+    cout << S.what << "  " << tb/1e6 << "  " << T1.num_nodes() << "  " << ti/1e6 << "  " << P.size()
+         << "  " << tm/nq/1e3 << "  " << real_type(ncand)/nq << '\n';
+  }
+}
+
+int
+main() {
+
+  G2lib::ClothoidList C1, C2;
+  road( C1, 3000, 0 );
+  road( C2, 3000, 0.5 );
+  AABBtree::VecPtrBBox B1, B2;
+  road_boxes( C1, B1 );
+  road_boxes( C2, B2 );
+  bench( "two spiral roads", B1, B2 );
+
+  cluster_boxes( 30000, 7, B1 );
+  cluster_boxes( 30000, 13, B2 );
+  bench( "clustered boxes of mixed sizes", B1, B2 );
+
+  // the trees of the curves use the default strategy
+  cout << "\nClothoidList::intersect of the two roads, trees built each time, best of 5\n";
+  struct { char const * what; AABBtreeStrategy s; } const strategies[] = {
+    { "Midpoint", AABBtreeStrategy::Midpoint },
+    { "Median  ", AABBtreeStrategy::Median },
+    { "SAH     ", AABBtreeStrategy::SAH }
+  };
+  for ( auto const & S : strategies ) {
+    G2lib::AABBtree_default_strategy = S.s;
+    G2lib::IntersectList il;
+    real_type t = best_ns( 5, [&]() {
+      G2lib::ClothoidList A( C1 ), B( C2 );
+      il.clear();
+      A.intersect( B, il, false );
+    } );
+    cout << S.what << "  " << t/1e6 << " ms  " << il.size() << " points\n";
+  }
+  G2lib::AABBtree_default_strategy = AABBtreeStrategy::Midpoint;
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+// findAtS on the abscissae `S` with and without the arc-length index,
+// the segments found must be the same
+template <typename LIST>
+static void
+bench( LIST & C, char const * what, vector<real_type> const & R, vector<real_type> const & Q ) {
+  size_t const n = R.size();
+  struct { char const * what; vector<real_type> const & s; } const queries[] = {
+    { "random    ", R }, { "sequential", Q }
+  };
+  for ( auto const & q : queries ) {
+    int_type sum_old = 0, sum_new = 0;
+    C.clear_s_index();
+    real_type to = best_ns( 5, [&]() {
+      sum_old = 0;
+      for ( size_t i = 0; i < n; ++i ) { real_type s = q.s[i]; sum_old += C.findAtS( s ); }
+    } );
+    C.build_s_index();
+    real_type tn = best_ns( 5, [&]() {
+      sum_new = 0;
+      for ( size_t i = 0; i < n; ++i ) { real_type s = q.s[i]; sum_new += C.findAtS( s ); }
+    } );
+    cout << what << ' ' << q.what << "  no index " << to/n << "  index " << tn/n
+         << "  speedup " << to/tn << ( sum_old == sum_new ? "" : "  MISMATCH" ) << '\n';
+  }
+}
+
+int
+main() {
+
+  // 50k segments of lengths varying from about 0.05 to 5
+  int_type const    np = 50001;
+  vector<real_type> x(np), y(np), th(np);
+  real_type         xx = 0;
+  for ( int_type i = 0; i < np; ++i ) {
+    x[i]  = xx;
+    y[i]  = sin( 0.01*xx );
+    th[i] = atan( 0.01*cos( 0.01*xx ) );
+    xx   += 0.05 + 4.95*real_type((i*7919LL)%1009)/1009;
+  }
+
+  G2lib::ClothoidList CL;
+  CL.build_G1( np, x.data(), y.data(), th.data() );
+  G2lib::BiarcList BL;
+  BL.build_G1( np, x.data(), y.data(), th.data() );
+  G2lib::PolyLine PL;
+  PL.build( x.data(), y.data(), np );
+
+  int_type const n = 1000000;
+  cout << "findAtS, " << n << " abscissae, ns per call (best of 5)\n";
+  auto queries = [n]( real_type L, vector<real_type> & R, vector<real_type> & Q ) {
+    R.resize( n );
+    Q.resize( n );
+    for ( int_type i = 0; i < n; ++i ) {
+      R[i] = L*real_type((i*7919LL)%n)/n;
+      Q[i] = (L*i)/n;
+    }
+  };
+  vector<real_type> R, Q;
+  queries( CL.length(), R, Q );
+  bench( CL, "ClothoidList", R, Q );
+  queries( BL.length(), R, Q );
+  bench( BL, "BiarcList   ", R, Q );
+  queries( PL.length(), R, Q );
+  bench( PL, "PolyLine    ", R, Q );
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using namespace std;
+
+// allocations counted by replacing the global operator new
+static size_t n_alloc = 0, n_bytes = 0;
+
+void *
+operator new( size_t sz ) {
+  ++n_alloc;
+  n_bytes += sz;
+  void * p = malloc( sz == 0 ? 1 : sz );
+  if ( p == nullptr ) throw bad_alloc();
+  return p;
+}
+
+void operator delete( void * p ) noexcept { free( p ); }
+void operator delete( void * p, size_t ) noexcept { free( p ); }
+
+// best time in ns of `reps` runs of `fun`, `na` and `nb` are the
+// allocations and bytes of the last run
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun, size_t & na, size_t & nb ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    size_t a0 = n_alloc, b0 = n_bytes;
+    auto   t0 = chrono::steady_clock::now();
+    fun();
+    auto   t1 = chrono::steady_clock::now();
+    na   = n_alloc-a0;
+    nb   = n_bytes-b0;
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+// a spiral road of `n` segments
+static void
+road( G2lib::ClothoidList & C, int_type n ) {
+  C.init();
+  C.push_back( 0, -10, 0, 0.1, 0, 5 );
+  for ( int_type i = 1; i < n; ++i ) {
+    real_type s = 5*i;
+    C.push_back( 1/(10+0.01*s), -0.01/pow(10+0.01*s,2), 5 );
+  }
+}
+
+int
+main() {
+
+  G2lib::ClothoidList C;
+  road( C, 3000 );
+  vector<G2lib::Triangle2D> T;
+  C.bbTriangles( T, G2lib::Utils::m_pi/18, 1 );
+  int_type const nb = int_type(T.size());
+
+  cout << "tree of " << nb << " triangle boxes, boxes created and tree built, best of 5\n";
+  size_t    na = 0, nby = 0;
+  int_type  nn = 0;
+  real_type ts = best_ns( 5, [&]() {
+    AABBtree::VecPtrBBox B;
+    B.reserve( size_t(nb) );
+    for ( int_type i = 0; i < nb; ++i ) {
+      real_type xmin, ymin, xmax, ymax;
+      T[size_t(i)].bbox( xmin, ymin, xmax, ymax );
+      B.push_back( make_shared<G2lib::BBox>( xmin, ymin, xmax, ymax, i, i ) );
+    }
+    AABBtree tree;
+    tree.build( B );
+    nn = tree.num_nodes();
+  }, na, nby );
+  cout << "make_shared per box " << ts/1e6 << " ms  " << na << " allocations  "
+       << nby/1024.0/1024.0 << " MB  " << nn << " nodes\n";
+  real_type tp = best_ns( 5, [&]() {
+    G2lib::BBoxPool pool( nb );
+    for ( int_type i = 0; i < nb; ++i ) {
+      real_type xmin, ymin, xmax, ymax;
+      T[size_t(i)].bbox( xmin, ymin, xmax, ymax );
+      pool.add( xmin, ymin, xmax, ymax, i, i );
+    }
+    AABBtree tree;
+    tree.build( pool );
+    nn = tree.num_nodes();
+  }, na, nby );
+  cout << "BBoxPool            " << tp/1e6 << " ms  " << na << " allocations  "
+       << nby/1024.0/1024.0 << " MB  " << nn << " nodes\n"
+       << "speedup " << ts/tp << '\n';
+
+  // the tree of the curve, a new offset each time to skip the cache
+  int_type  k  = 0;
+  real_type tc = best_ns( 5, [&]() { C.build_AABBtree_ISO( 0.001*(++k), G2lib::Utils::m_pi/18, 1 ); }, na, nby );
+  cout << "\nClothoidList::build_AABBtree_ISO, " << C.num_segments() << " segments: "
+       << tc/1e6 << " ms  " << na << " allocations  " << nby/1024.0/1024.0 << " MB\n";
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::FresnelAccuracy;
+using namespace std;
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+int
+main() {
+
+  struct { char const * what; FresnelAccuracy acc; } const tiers[] = {
+    { "Exact", FresnelAccuracy::Exact },
+    { "Fast ", FresnelAccuracy::Fast },
+    { "Draft", FresnelAccuracy::Draft }
+  };
+
+  // FresnelCS on the three regimes
+  {
+    int_type const n = 1000000;
+    vector<real_type> x(n), C0(n), S0(n), C(n), S(n);
+    for ( int_type i = 0; i < n; ++i ) x[i] = -50 + 100*real_type((i*7919LL)%n)/n;
+    cout << "FresnelCS, " << n << " abscissae in [-50,50), ns per call (best of 5)\n";
+    for ( auto const & T : tiers ) {
+      real_type t = best_ns( 5, [&]() {
+        for ( int_type i = 0; i < n; ++i ) G2lib::FresnelCS( x[i], C[i], S[i], T.acc );
+      } );
+      if ( T.acc == FresnelAccuracy::Exact ) { C0 = C; S0 = S; }
+      real_type err = 0;
+      for ( int_type i = 0; i < n; ++i ) err = max( { err, abs(C[i]-C0[i]), abs(S[i]-S0[i]) } );
+      cout << T.what << ' ' << t/n << "  max error " << err << '\n';
+    }
+  }
+
+  // GeneralizedFresnelCS with the parameters of clothoid segments
+  {
+    int_type const n = 200000;
+    vector<real_type> a(n), b(n), C0(n), S0(n), C(n), S(n);
+    for ( int_type i = 0; i < n; ++i ) {
+      a[i] = -20 + 40*real_type((i*7919LL)%n)/n;
+      b[i] = -6 + 12*real_type((i*104729LL)%n)/n;
+    }
+    cout << "\nGeneralizedFresnelCS, " << n << " (a,b) in [-20,20)x[-6,6), ns per call (best of 5)\n";
+    for ( auto const & T : tiers ) {
+      real_type t = best_ns( 5, [&]() {
+        for ( int_type i = 0; i < n; ++i ) G2lib::GeneralizedFresnelCS( a[i], b[i], 0.3, C[i], S[i], T.acc );
+      } );
+      if ( T.acc == FresnelAccuracy::Exact ) { C0 = C; S0 = S; }
+      real_type err = 0;
+      for ( int_type i = 0; i < n; ++i ) err = max( { err, abs(C[i]-C0[i]), abs(S[i]-S0[i]) } );
+      cout << T.what << ' ' << t/n << "  max error " << err << '\n';
+    }
+  }
+
+  // evaluation of a clothoid with the tier of the curve
+  {
+    int_type const  n = 200000;
+    G2lib::ClothoidCurve CC( 0, 0, 0.2, -0.5, 0.08, 40 );
+    vector<real_type> x0(n), y0(n), x(n), y(n);
+    cout << "\nClothoidCurve::eval, " << n << " abscissae on a 40 m clothoid, ns per call (best of 5)\n";
+    for ( auto const & T : tiers ) {
+      CC.fresnel_accuracy( T.acc );
+      real_type t = best_ns( 5, [&]() {
+        for ( int_type i = 0; i < n; ++i ) CC.eval( (i*40.0)/n, x[i], y[i] );
+      } );
+      if ( T.acc == FresnelAccuracy::Exact ) { x0 = x; y0 = y; }
+      real_type err = 0;
+      for ( int_type i = 0; i < n; ++i ) err = max( err, hypot(x[i]-x0[i], y[i]-y0[i]) );
+      cout << T.what << ' ' << t/n << "  max error " << err << '\n';
+    }
+  }
+
+  return 0;
+}
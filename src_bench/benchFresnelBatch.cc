@@ -0,0 +1,55 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+int
+main() {
+
+  int_type const n = 1000000;
+  vector<real_type> x(n), C1(n), S1(n), C2(n), S2(n);
+
+  // the three regimes of FresnelCS: series, rational and asymptotic
+  struct { char const * what; real_type a, b; } const ranges[] = {
+    { "series     [0,1)   ", 0, 1 },
+    { "rational   [1,6)   ", 1, 6 },
+    { "asymptotic [6,50)  ", 6, 50 },
+    { "mixed      [-50,50)", -50, 50 }
+  };
+
+  cout << "FresnelCS, " << n << " abscissae, ns per abscissa (best of 5)\n";
+  for ( auto const & R : ranges ) {
+    for ( int_type i = 0; i < n; ++i ) x[i] = R.a + (R.b-R.a)*((i*7919LL)%n)/n;
+    real_type ts = best_ns( 5, [&]() {
+      for ( int_type i = 0; i < n; ++i ) G2lib::FresnelCS( x[i], C1[i], S1[i] );
+    } );
+    real_type tb = best_ns( 5, [&]() { G2lib::FresnelCS_batch( n, x.data(), C2.data(), S2.data() ); } );
+    real_type err = 0;
+    for ( int_type i = 0; i < n; ++i ) err = max( { err, abs(C1[i]-C2[i]), abs(S1[i]-S2[i]) } );
+    cout << R.what << " scalar " << ts/n << "  batch " << tb/n
+         << "  speedup " << ts/tb << "  max diff " << err << '\n';
+  }
+
+  return 0;
+}
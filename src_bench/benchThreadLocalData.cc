@@ -0,0 +1,109 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// the former storage: a map from the thread id guarded by a mutex
+template <typename Data>
+class MapThreadLocalData {
+  mutable mutex                      m_data_mutex;
+  map<thread::id, shared_ptr<Data>>  m_data;
+public:
+  shared_ptr<Data>
+  search( thread::id const & id ) {
+    lock_guard<mutex> l( m_data_mutex );
+    auto el = m_data.find( id );
+    if ( el == m_data.end() ) {
+      auto data_ptr = make_shared<Data>( Data() );
+      m_data[id]    = data_ptr;
+      return data_ptr;
+    }
+    return el->second;
+  }
+  size_t size() const { lock_guard<mutex> l( m_data_mutex ); return m_data.size(); }
+};
+
+// best time in ns of `reps` runs of `fun`
+template <typename FUN>
+static real_type
+best_ns( int_type reps, FUN const & fun ) {
+  real_type best = 1e300;
+  for ( int_type r = 0; r < reps; ++r ) {
+    auto t0 = chrono::steady_clock::now();
+    fun();
+    auto t1 = chrono::steady_clock::now();
+    best = min( best, real_type(chrono::duration_cast<chrono::nanoseconds>(t1-t0).count()) );
+  }
+  return best;
+}
+
+// `nt` threads doing `n` lookups each with `lookup`
+template <typename FUN>
+static void
+run( int_type nt, int_type n, FUN const & lookup ) {
+  vector<thread> T;
+  for ( int_type t = 0; t < nt; ++t )
+    T.emplace_back( [&lookup,n]() { for ( int_type i = 0; i < n; ++i ) lookup( i ); } );
+  for ( auto & t : T ) t.join();
+}
+
+int
+main() {
+
+  int_type const n = 2000000;
+
+  cout << "lookup of the data of the calling thread, " << n
+       << " per thread, ns per lookup (best of 5)\n"
+       << "hardware threads: " << thread::hardware_concurrency() << '\n';
+  for ( int_type nt : { 1, 2, 4, 8 } ) {
+    MapThreadLocalData<int_type>           M;
+    G2lib::Utils::ThreadLocalData<int_type> L;
+    real_type tm = best_ns( 5, [&]() {
+      run( nt, n, [&M]( int_type i ) { *M.search( this_thread::get_id() ) += i; } );
+    } );
+    real_type tl = best_ns( 5, [&]() {
+      run( nt, n, [&L]( int_type i ) { L.get() += i; } );
+    } );
+    cout << nt << " threads: map+mutex " << tm/(nt*n) << "  slots " << tl/(nt*n)
+         << "  speedup " << tm/tl << '\n';
+  }
+
+  // short-lived threads, one lookup each: the map keys the data by the
+  // thread id, which the system reuses, so a new thread may find the
+  // data left by an exited one; the slots reset it on first use
+  {
+    int_type const                          nc = 2000;
+    MapThreadLocalData<int_type>            M;
+    G2lib::Utils::ThreadLocalData<int_type> L;
+    int_type                                stale_m = 0, stale_l = 0;
+    unsigned                                max_slot = 0;
+    real_type tm = best_ns( 1, [&]() {
+      for ( int_type k = 0; k < nc; ++k )
+        thread( [&]() { int_type & d = *M.search( this_thread::get_id() ); if ( d != 0 ) ++stale_m; d = k+1; } ).join();
+    } );
+    real_type tl = best_ns( 1, [&]() {
+      for ( int_type k = 0; k < nc; ++k )
+        thread( [&]() {
+          int_type & d = L.get();
+          if ( d != 0 ) ++stale_l;
+          d        = k+1;
+          max_slot = max( max_slot, G2lib::Utils::ThreadSlot::current().slot() );
+        } ).join();
+    } );
+    cout << "\n" << nc << " short-lived threads, ns per thread (spawn, lookup, join)\n"
+         << "map+mutex " << tm/nc << "  entries " << M.size() << "  threads finding stale data " << stale_m << '\n'
+         << "slots     " << tl/nc << "  highest slot " << max_slot << "  threads finding stale data " << stale_l << '\n';
+  }
+
+  return 0;
+}
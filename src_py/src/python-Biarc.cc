@@ -499,7 +499,7 @@ namespace G2lib {
         :rtype: int
       )S")
       
-      .def("findAtS", &BiarcList::findAtS, py::arg("s"),
+      .def("findAtS", py::overload_cast<real_type &>(&BiarcList::findAtS, py::const_), py::arg("s"),
       R"S(
         Get the index of the biarc at coordinate **s**
 
@@ -916,7 +916,7 @@ namespace G2lib {
         :rtype: float 
       )S")
 
-      .def("findAtS", &ClothoidList::findAtS, py::arg("s"),
+      .def("findAtS", py::overload_cast<real_type &>(&ClothoidList::findAtS, py::const_), py::arg("s"),
       R"S(
         Find the clothoid segment whose definition range contains `s`
 
@@ -925,6 +925,24 @@ namespace G2lib {
         :rtype: int
       )S")
 
+      .def("eval_batch", [](const ClothoidList & self, const std::vector<real_type> & s, int_type n_threads) {
+        const size_t n = s.size();
+        std::vector<real_type> th(n), k(n), x(n), y(n);
+        if (n > 0)
+          self.eval_batch(int_type(n), s.data(), x.data(), y.data(), th.data(), k.data(), n_threads);
+        return std::make_tuple(th, k, x, y);
+      }, py::arg("s"), py::arg("n_threads") = 0,
+      R"S(
+        Evaluate the list at the curvilinear coordinates `s`. Sorted
+        coordinates are evaluated walking the segments in order, large
+        inputs are split over `n_threads` workers (0 for all the cores).
+
+        :param List[float] s: list of curvilinear coordinate
+        :param int n_threads: number of workers
+        :return: a tuple of lists with angle, curvature, x-coordinate and y-coordinate at **s**
+        :rtype: Tuple[List[float], List[float], List[float], List[float]]
+      )S")
+
       .def("segment_length", &ClothoidList::segment_length, py::arg("nseg"),
       R"S(
         Returns the length of the segment at the requested index
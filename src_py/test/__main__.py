@@ -6,10 +6,12 @@
 #      Enrico Bertolazzi, Marco Frego
 
 import os
+import sys
 import unittest
 
 
 if __name__ == "__main__":
     test_path = os.path.normpath(os.path.join(__file__, ".."))
     suite = unittest.defaultTestLoader.discover(test_path)    
-    unittest.TextTestRunner(verbosity=2).run(suite)
+    result = unittest.TextTestRunner(verbosity=2).run(suite)
+    sys.exit(0 if result.wasSuccessful() else 1)
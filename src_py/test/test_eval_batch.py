@@ -0,0 +1,70 @@
+# PYTHON Wrapper for Clothoids
+#
+# License MIT - See LICENSE file
+#
+# 2022 Matteo Ragni
+
+import math
+import sys
+import os
+
+sys.path.insert(0, os.path.normpath(os.path.join(__file__, "../../distrib/G2lib")))
+
+import unittest
+import G2lib
+
+
+def build_list():
+    xs = [0.1 * i for i in range(60)]
+    ys = [math.sin(0.3 * i) for i in range(60)]
+    cl = G2lib.ClothoidList()
+    assert cl.build_G1(xs, ys)
+    return cl
+
+
+class TestEvalBatch(unittest.TestCase):
+
+    def compare(self, cl, s, n_threads):
+        th, kp, xs, ys = cl.eval_batch(s, n_threads)
+        th0, kp0, xs0, ys0 = cl.evaluate(s)
+        self.assertEqual(len(th), len(s))
+        [self.assertAlmostEqual(a, b, places=9) for a, b in zip(th, th0)]
+        [self.assertAlmostEqual(a, b, places=9) for a, b in zip(kp, kp0)]
+        [self.assertAlmostEqual(a, b, places=9) for a, b in zip(xs, xs0)]
+        [self.assertAlmostEqual(a, b, places=9) for a, b in zip(ys, ys0)]
+
+    def test_sorted(self):
+        cl = build_list()
+        n = 20000
+        s = [cl.length() * i / (n - 1) for i in range(n)]
+        for n_threads in (1, 4, 0):
+            self.compare(cl, s, n_threads)
+
+    def test_unsorted(self):
+        cl = build_list()
+        n = 20000
+        s = [cl.length() * ((i * 7919) % n) / n for i in range(n)]
+        for n_threads in (1, 4, 0):
+            self.compare(cl, s, n_threads)
+
+    def test_empty(self):
+        cl = build_list()
+        th, kp, xs, ys = cl.eval_batch([])
+        self.assertEqual(len(th), 0)
+
+    def test_error(self):
+        # a bad abscissa raises in the caller, also from a worker thread
+        cl = build_list()
+        n = 20000
+        s = [cl.length() * i / (n - 1) for i in range(n)]
+        s[12345] = float("nan")
+        for n_threads in (1, 4, 0):
+            with self.assertRaises(RuntimeError):
+                cl.eval_batch(s, n_threads)
+        # the list is still usable after the error
+        s[12345] = s[12344]
+        self.compare(cl, s, 4)
+
+
+if __name__ == '__main__':
+    unittest.main()
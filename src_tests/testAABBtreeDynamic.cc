@@ -0,0 +1,104 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <limits>
+#include <map>
+#include <set>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using G2lib::ClothoidList;
+using namespace std;
+
+// boxes of the query computed by brute force
+static set<int_type>
+brute_box(
+  map<int_type,AABBtree::PtrBBox> const & live,
+  real_type xmin, real_type ymin, real_type xmax, real_type ymax
+) {
+  set<int_type> res;
+  for ( auto const & hb : live ) {
+    AABBtree::PtrBBox const & b = hb.second;
+    if ( b->x_min() <= xmax && b->x_max() >= xmin &&
+         b->y_min() <= ymax && b->y_max() >= ymin ) res.insert( b->Id() );
+  }
+  return res;
+}
+
+static int_type
+check(
+  AABBtree const & T,
+  map<int_type,AABBtree::PtrBBox> const & live,
+  char const * what
+) {
+  int_type nerr = 0;
+  for ( int_type q = 0; q < 20; ++q ) {
+    real_type x0 = (q*37) % 19 - 2.0;
+    real_type y0 = (q*11) % 13 - 2.0;
+    real_type x1 = x0 + 1 + q % 5;
+    real_type y1 = y0 + 1 + q % 3;
+    set<int_type> ids;
+    auto fun = [&ids]( AABBtree::PtrBBox const & b ) -> bool { ids.insert( b->Id() ); return false; };
+    T.query_box( x0, y0, x1, y1, fun );
+    if ( ids != brute_box( live, x0, y0, x1, y1 ) ) ++nerr;
+  }
+  cout << what << ": " << live.size() << " boxes, "
+       << ( T.optimized() ? "wide" : "binary" ) << ", errors " << nerr << '\n';
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // tree built on a grid, then boxes inserted and removed
+  map<int_type,AABBtree::PtrBBox> live;
+  AABBtree::VecPtrBBox boxes;
+  for ( int_type i = 0; i < 200; ++i ) {
+    real_type x = i % 15;
+    real_type y = i / 15;
+    boxes.push_back( make_shared<G2lib::BBox>( x, y, x + 0.7, y + 0.4, i, 0 ) );
+    live[i] = boxes.back();
+  }
+  AABBtree T;
+  T.build( boxes );
+  if ( !T.optimized() ) ++nerr;
+  nerr += check( T, live, "build" );
+
+  for ( int_type i = 0; i < 60; ++i ) {
+    real_type x = 0.25 + (i*7) % 16;
+    real_type y = 0.5  + (i*3) % 14;
+    AABBtree::PtrBBox b = make_shared<G2lib::BBox>( x, y, x + 0.3, y + 0.9, 1000 + i, 0 );
+    live[T.insert( b )] = b;
+  }
+  for ( int_type h = 0; h < 200; h += 3 ) { T.remove( h ); live.erase( h ); }
+  if ( T.optimized() ) ++nerr; // the wide nodes are dropped
+  nerr += check( T, live, "insert/remove" );
+  if ( T.num_bboxes() != int_type(live.size()) ) ++nerr;
+
+  T.optimize();
+  if ( !T.optimized() ) ++nerr;
+  nerr += check( T, live, "optimize" );
+
+  // a list extended after its tree is built collapses it again on the next query
+  ClothoidList CL;
+  real_type const th[] = { 0, 0.3, -0.2, 0.1 };
+  real_type const xx[] = { 0, 1, 2, 3 };
+  real_type const yy[] = { 0, 0.2, 0.1, 0.4 };
+  CL.build_G1( 4, xx, yy, th );
+  real_type xmin, ymin, xmax, ymax;
+  CL.bbox( xmin, ymin, xmax, ymax );
+  CL.push_back_G1( 4, 0.2, 0 );
+  CL.push_back_G1( 5, 0.5, 0.2 );
+  vector<int_type>  segs;
+  vector<real_type> s0, s1;
+  CL.segments_in_box( -10, -10, 10, 10, segs, s0, s1 );
+  cout << "ClothoidList::segments_in_box " << segs.size() << " of " << CL.num_segments() << '\n';
+  if ( int_type(segs.size()) != CL.num_segments() ) ++nerr;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <utility>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using G2lib::AABBtreeStrategy;
+using namespace std;
+
+// n boxes of different sizes scattered in [0,10]^2, ipos = position
+static AABBtree::VecPtrBBox
+boxes( int_type n, int_type seed ) {
+  AABBtree::VecPtrBBox B;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type x = 10*real_type(((i+seed)*7919)%1009)/1009;
+    real_type y = 10*real_type(((i+seed)*104729)%1013)/1013;
+    real_type w = 0.05+0.4*real_type((i*31)%17)/17;
+    real_type h = 0.05+0.4*real_type((i*29)%13)/13;
+    B.push_back( make_shared<G2lib::BBox>( x, y, x+w, y+h, i, i ) );
+  }
+  return B;
+}
+
+static bool
+overlap( G2lib::BBox const & a, G2lib::BBox const & b ) {
+  return a.x_min() <= b.x_max() && b.x_min() <= a.x_max() &&
+         a.y_min() <= b.y_max() && b.y_min() <= a.y_max();
+}
+
+static real_type
+dist( G2lib::BBox const & b, real_type x, real_type y ) {
+  real_type dx = max( { b.x_min()-x, 0.0, x-b.x_max() } );
+  real_type dy = max( { b.y_min()-y, 0.0, y-b.y_max() } );
+  return hypot( dx, dy );
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  AABBtree::VecPtrBBox B1 = boxes( 700, 0 );
+  AABBtree::VecPtrBBox B2 = boxes( 300, 500 );
+
+  set<pair<int_type,int_type>> expected;
+  for ( auto const & a : B1 )
+    for ( auto const & b : B2 )
+      if ( overlap( *a, *b ) ) expected.insert( { a->Ipos(), b->Ipos() } );
+
+  for ( AABBtreeStrategy st : { AABBtreeStrategy::Midpoint, AABBtreeStrategy::Median, AABBtreeStrategy::SAH } ) {
+    AABBtree T1, T2;
+    T1.set_strategy( st );
+    T2.set_strategy( st );
+    T1.build( B1 );
+    T2.build( B2 );
+    int_type ne = 0;
+
+    // every box is stored once, the root bounds all of them
+    if ( T1.num_bboxes() != int_type(B1.size()) ) ++ne;
+    real_type xmin, ymin, xmax, ymax;
+    T1.bbox( xmin, ymin, xmax, ymax );
+    for ( auto const & b : B1 )
+      if ( b->x_min() < xmin || b->y_min() < ymin || b->x_max() > xmax || b->y_max() > ymax ) { ++ne; break; }
+
+    // overlapping pairs, the list does not depend on the threads
+    for ( int_type nt : { 1, 4 } ) {
+      vector<pair<int_type,int_type>> ipos;
+      T1.intersect( T2, ipos, false, nt );
+      set<pair<int_type,int_type>> found( ipos.begin(), ipos.end() );
+      if ( found != expected || ipos.size() != expected.size() ) ++ne;
+
+      AABBtree::VecPairPtrBBox plist;
+      T1.intersect( T2, plist, false, nt );
+      if ( plist.size() != expected.size() ) ++ne;
+    }
+
+    // collision with a callback that accepts a given pair
+    pair<int_type,int_type> target = *expected.rbegin();
+    auto fun = [&target]( AABBtree::PtrBBox const & a, AABBtree::PtrBBox const & b ) -> bool {
+      return a->Ipos() == target.first && b->Ipos() == target.second;
+    };
+    if ( !T1.collision( T2, fun ) ) ++ne;
+    auto never = []( AABBtree::PtrBBox const &, AABBtree::PtrBBox const & ) -> bool { return false; };
+    if ( T1.collision( T2, never ) ) ++ne;
+
+    // the box nearest to a point is among the min_distance candidates
+    for ( int_type q = 0; q < 50; ++q ) {
+      real_type x = -2+14*real_type((q*37)%50)/50;
+      real_type y = -2+14*real_type((q*11)%50)/50;
+      real_type dmin = numeric_limits<real_type>::infinity();
+      for ( auto const & b : B1 ) dmin = min( dmin, dist( *b, x, y ) );
+      AABBtree::VecPtrBBox cand;
+      T1.min_distance( x, y, cand );
+      real_type dc = numeric_limits<real_type>::infinity();
+      for ( auto const & b : cand ) dc = min( dc, dist( *b, x, y ) );
+      if ( dc != dmin ) ++ne;
+    }
+
+    // a moved tree answers as the original
+    int_type nnodes = T1.num_nodes();
+    AABBtree C( std::move(T1) );
+    vector<pair<int_type,int_type>> ipos;
+    C.intersect( T2, ipos );
+    if ( set<pair<int_type,int_type>>( ipos.begin(), ipos.end() ) != expected ) ++ne;
+
+    cout << "strategy " << int(st) << ": " << nnodes << " nodes, "
+         << expected.size() << " overlapping pairs, errors " << ne << '\n';
+    nerr += ne;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
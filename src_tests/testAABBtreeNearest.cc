@@ -0,0 +1,57 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <limits>
+#include <set>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using namespace std;
+
+// grid of n unit boxes, the trees of 3 boxes have empty lanes for any arity
+static void
+build_grid( AABBtree & T, int_type n ) {
+  AABBtree::VecPtrBBox boxes;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type x = i % 7;
+    real_type y = i / 7;
+    boxes.push_back( make_shared<G2lib::BBox>( x, y, x + 0.5, y + 0.5, i, 0 ) );
+  }
+  T.build( boxes );
+}
+
+int
+main() {
+
+  real_type const inf  = numeric_limits<real_type>::infinity();
+  int_type        nerr = 0;
+
+  for ( int_type n : { 3, 37, 500 } ) {
+    AABBtree T;
+    build_grid( T, n );
+
+    // k larger than the number of boxes returns each box once
+    AABBtree::VecPtrBBox candidateList;
+    vector<real_type>    distances;
+    T.k_nearest( 1, 1, n + 10, candidateList, distances );
+    set<int_type> ids;
+    for ( auto const & b : candidateList ) ids.insert( b->Id() );
+    cout << "n = " << n << " k_nearest(k=n+10) found " << candidateList.size()
+         << " distinct " << ids.size() << '\n';
+    if ( int_type(candidateList.size()) != n || int_type(ids.size()) != n ) ++nerr;
+    for ( size_t i = 1; i < distances.size(); ++i )
+      if ( distances[i-1] > distances[i] ) { ++nerr; break; }
+
+    // a callback that never bounds the search visits each box once
+    int_type cnt = 0;
+    auto fun = [&cnt,inf]( AABBtree::PtrBBox const &, real_type ) -> real_type { ++cnt; return inf; };
+    T.nearest( 1, 1, fun );
+    cout << "n = " << n << " nearest(unbounded) visited " << cnt << '\n';
+    if ( cnt != n ) ++nerr;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
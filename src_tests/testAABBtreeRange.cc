@@ -0,0 +1,64 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <limits>
+#include <set>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using namespace std;
+
+// grid of n unit boxes, the trees of 3 boxes have empty lanes for any arity
+static void
+build_grid( AABBtree & T, int_type n ) {
+  AABBtree::VecPtrBBox boxes;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type x = i % 7;
+    real_type y = i / 7;
+    boxes.push_back( make_shared<G2lib::BBox>( x, y, x + 0.5, y + 0.5, i, 0 ) );
+  }
+  T.build( boxes );
+}
+
+int
+main() {
+
+  real_type const inf  = numeric_limits<real_type>::infinity();
+  int_type        nerr = 0;
+
+  for ( int_type n : { 3, 37, 500 } ) {
+    AABBtree T;
+    build_grid( T, n );
+
+    set<int_type> ids;
+    int_type      cnt = 0;
+    auto fun = [&ids,&cnt]( AABBtree::PtrBBox const & b ) -> bool {
+      ids.insert( b->Id() );
+      ++cnt;
+      return false;
+    };
+
+    // unbounded queries visit each box once
+    T.query_radius( 1, 1, inf, fun );
+    cout << "n = " << n << " query_radius(r=inf) visited " << cnt << " distinct " << ids.size() << '\n';
+    if ( cnt != n || int_type(ids.size()) != n ) ++nerr;
+
+    ids.clear(); cnt = 0;
+    T.query_box( -inf, -inf, inf, inf, fun );
+    cout << "n = " << n << " query_box(plane) visited " << cnt << " distinct " << ids.size() << '\n';
+    if ( cnt != n || int_type(ids.size()) != n ) ++nerr;
+
+    // half plane x >= 3: the boxes of the columns 3..6
+    int_type expected = 0;
+    for ( int_type i = 0; i < n; ++i ) if ( i % 7 >= 3 ) ++expected;
+    ids.clear(); cnt = 0;
+    T.query_box( 3, -inf, inf, inf, fun );
+    cout << "n = " << n << " query_box(x>=3) visited " << cnt << " expected " << expected << '\n';
+    if ( cnt != expected || int_type(ids.size()) != expected ) ++nerr;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
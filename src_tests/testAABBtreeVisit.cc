@@ -0,0 +1,136 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using namespace std;
+
+// n boxes of different sizes scattered in [0,10]^2, ipos = position
+static AABBtree::VecPtrBBox
+boxes( int_type n, int_type seed ) {
+  AABBtree::VecPtrBBox B;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type x = 10*real_type(((i+seed)*7919)%1009)/1009;
+    real_type y = 10*real_type(((i+seed)*104729)%1013)/1013;
+    real_type w = 0.05+0.4*real_type((i*31)%17)/17;
+    real_type h = 0.05+0.4*real_type((i*29)%13)/13;
+    B.push_back( make_shared<G2lib::BBox>( x, y, x+w, y+h, i, i ) );
+  }
+  return B;
+}
+
+// every point of A is close to a point of B and vice versa
+static bool
+same_points( G2lib::ClothoidList const & C, G2lib::IntersectList const & A, G2lib::IntersectList const & B ) {
+  auto covered = [&C]( G2lib::IntersectList const & P, G2lib::IntersectList const & Q ) -> bool {
+    for ( auto const & p : P ) {
+      bool found = false;
+      for ( auto const & q : Q )
+        if ( hypot( C.X(p.first)-C.X(q.first), C.Y(p.first)-C.Y(q.first) ) < 1e-8 ) { found = true; break; }
+      if ( !found ) return false;
+    }
+    return true;
+  };
+  return !A.empty() && covered( A, B ) && covered( B, A );
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  AABBtree::VecPtrBBox B1 = boxes( 2000, 0 );
+  AABBtree::VecPtrBBox B2 = boxes( 1500, 700 );
+  AABBtree             T1, T2;
+  T1.build( B1 );
+  T2.build( B2 );
+
+  // visit_overlaps streams the same pairs of intersect, each once
+  {
+    vector<pair<int_type,int_type>> ipos;
+    T1.intersect( T2, ipos );
+    set<pair<int_type,int_type>> expected( ipos.begin(), ipos.end() );
+
+    vector<pair<int_type,int_type>> visited;
+    auto all = [&visited]( AABBtree::PtrBBox const & a, AABBtree::PtrBBox const & b ) -> bool {
+      visited.push_back( { a->Ipos(), b->Ipos() } );
+      return false;
+    };
+    bool stopped = T1.visit_overlaps( T2, all );
+    set<pair<int_type,int_type>> found( visited.begin(), visited.end() );
+    cout << "visit_overlaps " << visited.size() << " pairs, intersect " << expected.size() << '\n';
+    if ( stopped || found != expected || visited.size() != expected.size() ) ++nerr;
+
+    // early stop after k pairs
+    for ( size_t k : { size_t(1), size_t(17), expected.size() } ) {
+      size_t count = 0;
+      auto   stop  = [&count,k]( AABBtree::PtrBBox const &, AABBtree::PtrBBox const & ) -> bool {
+        return ++count == k;
+      };
+      if ( !T1.visit_overlaps( T2, stop ) || count != k ) ++nerr;
+    }
+  }
+
+  // visit_min_distance streams the min_distance candidates
+  for ( int_type q = 0; q < 40; ++q ) {
+    real_type x = -2+14*real_type((q*37)%40)/40;
+    real_type y = -2+14*real_type((q*11)%40)/40;
+    AABBtree::VecPtrBBox cand;
+    T1.min_distance( x, y, cand );
+    set<int_type> expected;
+    for ( auto const & b : cand ) expected.insert( b->Ipos() );
+
+    set<int_type> found;
+    size_t        count = 0;
+    auto all = [&found,&count]( AABBtree::PtrBBox const & b ) -> bool {
+      found.insert( b->Ipos() );
+      ++count;
+      return false;
+    };
+    if ( T1.visit_min_distance( x, y, all ) || found != expected || count != cand.size() ) ++nerr;
+
+    count = 0;
+    auto first = [&count]( AABBtree::PtrBBox const & ) -> bool { ++count; return true; };
+    if ( !T1.visit_min_distance( x, y, first ) || count != 1 ) ++nerr;
+  }
+  cout << "visit_min_distance errors " << nerr << '\n';
+
+  // the curve intersections refined inside visit_overlaps match the
+  // intersections found without the tree
+  {
+    int_type const    np = 61;
+    vector<real_type> x1(np), y1(np), t1(np), x2(np), y2(np), t2(np);
+    for ( int_type i = 0; i < np; ++i ) {
+      x1[i] = 0.2*i;
+      y1[i] = sin(0.3*i);
+      t1[i] = atan( 1.5*cos(0.3*i) );
+      x2[i] = 0.2*i+0.05;
+      y2[i] = 0.8*cos(0.25*i);
+      t2[i] = atan( -sin(0.25*i) );
+    }
+    G2lib::ClothoidList C1, C2;
+    C1.build_G1( np, x1.data(), y1.data(), t1.data() );
+    C2.build_G1( np, x2.data(), y2.data(), t2.data() );
+
+    G2lib::IntersectList with_tree, without_tree;
+    G2lib::yesAABBtree();
+    C1.intersect( C2, with_tree, false );
+    G2lib::noAABBtree();
+    C1.intersect( C2, without_tree, false );
+    G2lib::yesAABBtree();
+    cout << "ClothoidList intersections with tree " << with_tree.size()
+         << ", without tree " << without_tree.size() << '\n';
+    if ( !same_points( C1, with_tree, without_tree ) ) ++nerr;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
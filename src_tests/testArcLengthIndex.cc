@@ -0,0 +1,94 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ArcLengthIndex;
+using G2lib::ClothoidList;
+using namespace std;
+
+// segment i with s0[i] <= s < s0[i+1], the last one for s = s0.back()
+static int_type
+brute( vector<real_type> const & s0, real_type s ) {
+  int_type nseg = int_type(s0.size()) - 1;
+  int_type i    = int_type(upper_bound( s0.begin(), s0.end(), s ) - s0.begin()) - 1;
+  return max( int_type(0), min( i, nseg - 1 ) );
+}
+
+static int_type
+check( ArcLengthIndex const & I, vector<real_type> const & s0, char const * what ) {
+  int_type nerr = 0;
+  int_type npts = int_type(s0.size());
+  if ( !I.valid_for( npts, s0.data() ) ) ++nerr;
+  real_type L = s0.back() - s0.front();
+  for ( int_type k = 0; k <= 1000; ++k ) {
+    real_type s = s0.front() + (k*L)/1000;
+    if ( I.guess( s, s0.data() ) != brute( s0, s ) ) ++nerr;
+  }
+  // the breakpoints themselves
+  for ( int_type i = 0; i < npts; ++i )
+    if ( I.guess( s0[i], s0.data() ) != brute( s0, s0[i] ) ) ++nerr;
+  cout << what << ": " << npts-1 << " segments, errors " << nerr << '\n';
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // breakpoints with lengths varying from 0.01 to 3
+  vector<real_type> s0(1,0);
+  for ( int_type i = 0; i < 50; ++i ) s0.push_back( s0.back() + 0.01 + ((i*37)%100)*0.03 );
+
+  ArcLengthIndex I;
+  I.build( int_type(s0.size()), s0.data() );
+  nerr += check( I, s0, "build" );
+
+  // append one segment at a time, long then very short ones
+  for ( int_type i = 0; i < 400; ++i ) {
+    s0.push_back( s0.back() + ( i < 100 ? 1.5 : 0.001 ) );
+    I.extend( int_type(s0.size()), s0.data() );
+  }
+  nerr += check( I, s0, "extend" );
+
+  // the old breakpoints changed: extend rebuilds
+  for ( real_type & s : s0 ) s *= 2;
+  s0.push_back( s0.back() + 1 );
+  I.extend( int_type(s0.size()), s0.data() );
+  nerr += check( I, s0, "extend after scale" );
+
+  // an index not built is not extended
+  ArcLengthIndex E;
+  E.extend( int_type(s0.size()), s0.data() );
+  if ( !E.empty() ) ++nerr;
+
+  // findAtS of a list grown with push_back against the search without index
+  ClothoidList CL, REF;
+  CL.push_back( 0, 0, 0, 0.1, 0.01, 1 );
+  CL.build_s_index();
+  for ( int_type i = 0; i < 300; ++i ) {
+    real_type k  = 0.2*((i*13)%7-3);
+    real_type L  = 0.05 + ((i*29)%11)*0.2;
+    CL.push_back( k, -k/L, L );
+  }
+  REF = CL;
+  REF.clear_s_index();
+  int_type nbad = 0;
+  real_type L = CL.length();
+  for ( int_type k = 0; k <= 5000; ++k ) {
+    real_type s1 = ((k*7919)%5001)*L/5000;
+    real_type s2 = s1;
+    int_type  h1 = -1, h2 = -1;
+    if ( CL.findAtS( s1, h1 ) != REF.findAtS( s2, h2 ) ) ++nbad;
+  }
+  cout << "ClothoidList::findAtS after push_back, errors " << nbad << '\n';
+  nerr += nbad;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ClothoidCurve;
+using namespace std;
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // Hermite problems from a unit chord, angles over most of the
+  // solvable range, the first ones are the symmetric and straight cases
+  int_type const    n = 257;
+  vector<real_type> x0(n), y0(n), th0(n), x1(n), y1(n), th1(n);
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type u = real_type((i*7919)%n)/n;
+    real_type v = real_type((i*104729)%n)/n;
+    real_type r = 0.5+2*real_type((i*31)%n)/n;
+    real_type phi = 6*(u-0.5);
+    x0[i]  = i%5;
+    y0[i]  = -(i%3);
+    x1[i]  = x0[i] + r*cos(phi);
+    y1[i]  = y0[i] + r*sin(phi);
+    th0[i] = phi + 2.8*(u-0.5);
+    th1[i] = phi + 2.8*(v-0.5);
+  }
+  th0[0] = th1[0] = atan2( y1[0]-y0[0], x1[0]-x0[0] );         // straight
+  th0[1] = atan2( y1[1]-y0[1], x1[1]-x0[1] ) + 0.5; th1[1] = th0[1] - 1; // arc
+
+  vector<real_type> L(n), k(n), dk(n), L_D(2*n), k_D(2*n), dk_D(2*n);
+  int_type iter = G2lib::build_G1_batch(
+    n, x0.data(), y0.data(), th0.data(), x1.data(), y1.data(), th1.data(), 1e-12,
+    L.data(), k.data(), dk.data()
+  );
+  G2lib::build_G1_batch(
+    n, x0.data(), y0.data(), th0.data(), x1.data(), y1.data(), th1.data(), 1e-12,
+    L.data(), k.data(), dk.data(), L_D.data(), k_D.data(), dk_D.data()
+  );
+
+  real_type err = 0, err_D = 0;
+  for ( int_type i = 0; i < n; ++i ) {
+    ClothoidCurve C;
+    real_type     CL_D[2], Ck_D[2], Cdk_D[2];
+    C.build_G1_D( x0[i], y0[i], th0[i], x1[i], y1[i], th1[i], CL_D, Ck_D, Cdk_D );
+    err = max( { err, abs(L[i]-C.length())/C.length(), abs(k[i]-C.kappa_begin())*C.length(),
+                 abs(dk[i]-C.dkappa())*C.length()*C.length() } );
+    for ( int_type j = 0; j < 2; ++j )
+      err_D = max( { err_D, abs(L_D[j*n+i]-CL_D[j])/(1+abs(CL_D[j])),
+                     abs(k_D[j*n+i]-Ck_D[j])/(1+abs(Ck_D[j])),
+                     abs(dk_D[j*n+i]-Cdk_D[j])/(1+abs(Cdk_D[j])) } );
+  }
+  cout << "build_G1_batch " << n << " problems, iterations " << iter
+       << ", max error " << err << ", derivatives " << err_D << '\n';
+  if ( !(iter >= 0 && err < 1e-10 && err_D < 1e-8) ) ++nerr;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ClothoidCurve;
+using namespace std;
+
+static real_type
+diff( ClothoidCurve const & A, ClothoidCurve const & B ) {
+  real_type L = B.length();
+  return max( { abs(A.length()-L)/L, abs(A.kappa_begin()-B.kappa_begin())*L,
+                abs(A.dkappa()-B.dkappa())*L*L } );
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // ClothoidCurve: re-solve perturbations of a solved problem
+  {
+    ClothoidCurve base;
+    base.build_G1( 0, 0, 0.4, 3, 1, -0.7 );
+    real_type err = 0;
+    int_type  it_cold = 0, it_warm = 0;
+    for ( int_type i = 0; i < 100; ++i ) {
+      bool          near = i < 90;  // the last ones are far, no gain expected
+      real_type     e    = ( near ? 1e-5 : 0.5 )*sin(1.3*i);
+      ClothoidCurve cold, warm(base);
+      int_type      ic = cold.build_G1( 0, 0, 0.4+e, 3, 1+e, -0.7-e );
+      int_type      iw = warm.build_G1_warm( 0, 0, 0.4+e, 3, 1+e, -0.7-e );
+      if ( ic < 0 || iw < 0 ) ++nerr;
+      if ( near ) { it_cold += ic; it_warm += iw; }
+      err = max( err, diff( warm, cold ) );
+      real_type L_D[2], k_D[2], dk_D[2], wL_D[2], wk_D[2], wdk_D[2];
+      ClothoidCurve warm_D(base);
+      cold.build_G1_D( 0, 0, 0.4+e, 3, 1+e, -0.7-e, L_D, k_D, dk_D );
+      warm_D.build_G1_D_warm( 0, 0, 0.4+e, 3, 1+e, -0.7-e, wL_D, wk_D, wdk_D );
+      err = max( err, diff( warm_D, cold ) );
+      for ( int_type j = 0; j < 2; ++j )
+        err = max( { err, abs(wL_D[j]-L_D[j]), abs(wk_D[j]-k_D[j]), abs(wdk_D[j]-dk_D[j]) } );
+    }
+    cout << "build_G1_warm max error " << err << ", iterations cold " << it_cold << " warm " << it_warm << '\n';
+    if ( !(err < 1e-10) || it_warm >= it_cold ) ++nerr;
+  }
+
+  // build_G1_batch_warm: the previous solution, a bad start and a zero start
+  {
+    int_type const    n = 64;
+    vector<real_type> x0(n,0), y0(n,0), th0(n), x1(n), y1(n), th1(n);
+    for ( int_type i = 0; i < n; ++i ) {
+      x1[i]  = 2+cos(0.1*i);
+      y1[i]  = sin(0.3*i);
+      th0[i] = 1.2*sin(0.7*i);
+      th1[i] = 1.1*cos(0.4*i);
+    }
+    vector<real_type> L(n), k(n), dk(n), A(n), Lc(n), kc(n), dkc(n);
+    G2lib::build_G1_batch( n, x0.data(), y0.data(), th0.data(), x1.data(), y1.data(), th1.data(),
+                           1e-12, L.data(), k.data(), dk.data() );
+    for ( int_type i = 0; i < n; ++i ) { A[i] = 0.5*dk[i]*L[i]*L[i]; th1[i] += 1e-3*sin(1.7*i); }
+
+    G2lib::build_G1_batch( n, x0.data(), y0.data(), th0.data(), x1.data(), y1.data(), th1.data(),
+                           1e-12, Lc.data(), kc.data(), dkc.data() );
+    for ( int_type start = 0; start < 3; ++start ) {
+      vector<real_type> AA(A);
+      if ( start == 1 ) for ( real_type & a : AA ) a = 1e3;  // far from any solution
+      if ( start == 2 ) fill( AA.begin(), AA.end(), 0.0 );
+      int_type iter = G2lib::build_G1_batch_warm( n, x0.data(), y0.data(), th0.data(), x1.data(), y1.data(), th1.data(),
+                                                  1e-12, AA.data(), L.data(), k.data(), dk.data() );
+      real_type err = 0;
+      for ( int_type i = 0; i < n; ++i )
+        err = max( { err, abs(L[i]-Lc[i])/Lc[i], abs(k[i]-kc[i])*Lc[i], abs(dk[i]-dkc[i])*Lc[i]*Lc[i],
+                     abs(AA[i]-0.5*dkc[i]*Lc[i]*Lc[i]) } );
+      cout << "build_G1_batch_warm start " << start << " iterations " << iter << " max error " << err << '\n';
+      if ( !(iter >= 0 && err < 1e-10) ) ++nerr;
+    }
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ClothoidCurve;
+using G2lib::ClothoidSegment;
+using namespace std;
+
+// the record against the curve at the abscissae of the segment
+static real_type
+compare( ClothoidSegment const & S, ClothoidCurve const & C ) {
+  real_type err = abs( S.length()-C.length() );
+  real_type L   = C.length();
+  err = max( { err, abs(S.x_end()-C.x_end()), abs(S.y_end()-C.y_end()),
+               abs(S.theta_end()-C.theta_end()), abs(S.kappa_end()-C.kappa_end()),
+               abs(S.tx_End()-C.tx_End()), abs(S.ty_End()-C.ty_End()) } );
+  for ( int_type k = 0; k <= 20; ++k ) {
+    real_type s = (k*L)/20;
+    real_type x1, y1, t1, k1, x2, y2, t2, k2;
+    S.evaluate( s, t1, k1, x1, y1 );
+    C.evaluate( s, t2, k2, x2, y2 );
+    err = max( { err, abs(x1-x2), abs(y1-y2), abs(t1-t2), abs(k1-k2), abs(S.X(s)-C.X(s)), abs(S.Y(s)-C.Y(s)) } );
+    for ( real_type offs : { -0.3, 0.2 } ) {
+      S.evaluate_ISO( s, offs, t1, k1, x1, y1 );
+      C.evaluate_ISO( s, offs, t2, k2, x2, y2 );
+      err = max( { err, abs(x1-x2), abs(y1-y2), abs(t1-t2), abs(k1-k2) } );
+      S.evaluate_SAE( s, offs, t1, k1, x1, y1 );
+      C.evaluate_SAE( s, offs, t2, k2, x2, y2 );
+      err = max( { err, abs(x1-x2), abs(y1-y2), abs(t1-t2), abs(k1-k2) } );
+      S.eval_ISO_DD( s, offs, x1, y1 );
+      C.eval_ISO_DD( s, offs, x2, y2 );
+      err = max( { err, abs(x1-x2), abs(y1-y2) } );
+    }
+    S.eval_D( s, x1, y1 );
+    C.eval_D( s, x2, y2 );
+    err = max( { err, abs(x1-x2), abs(y1-y2) } );
+    S.eval_DDD( s, x1, y1 );
+    C.eval_DDD( s, x2, y2 );
+    err = max( { err, abs(x1-x2), abs(y1-y2) } );
+  }
+  return err;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // a list with clothoid, arc and straight segments
+  G2lib::ClothoidList CL;
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7, 8, 9 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3, 0.3, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2, 0, 0 };
+  CL.build_G1( 9, xx, yy, th );
+  CL.push_back( 1.5, 0, 2 );  // arc
+  CL.push_back( 0, 0, 1 );    // straight
+
+  // segment(idx), get(idx) and segment_length agree
+  real_type err = 0;
+  for ( int_type i = 0; i < CL.num_segments(); ++i ) {
+    ClothoidSegment const & S = CL.segment( i );
+    ClothoidCurve const     C = CL.get( i );
+    err = max( err, compare( S, C ) );
+    err = max( err, abs(CL.segment_length(i)-C.length()) );
+    // the offset length is not available, as for ClothoidCurve
+    bool thrown = false;
+    try { CL.segment_length_ISO( i, 0.2 ); } catch ( std::exception const & ) { thrown = true; }
+    if ( !thrown ) ++nerr;
+    // the record of the curve is the stored one
+    ClothoidSegment R( C );
+    if ( R.CD.x0 != S.CD.x0 || R.CD.y0 != S.CD.y0 || R.CD.theta0 != S.CD.theta0 ||
+         R.CD.kappa0 != S.CD.kappa0 || R.CD.dk != S.CD.dk || R.L != S.L ) ++nerr;
+    // getAtS returns the segment containing s
+    real_type s = CL.segment_s0( i ) + 0.5*S.length();
+    ClothoidCurve A = CL.getAtS( s );
+    if ( A.x_begin() != C.x_begin() || A.length() != C.length() ) ++nerr;
+  }
+  cout << "segment/get max error " << err << '\n';
+  if ( !(err < 1e-12) ) ++nerr;
+
+  // the transforms of the record follow the ones of the curve
+  err = 0;
+  for ( int_type i = 0; i < CL.num_segments(); ++i ) {
+    for ( int_type op = 0; op < 6; ++op ) {
+      ClothoidSegment S = CL.segment( i );
+      ClothoidCurve   C = CL.get( i );
+      switch ( op ) {
+      case 0: S.translate( 0.3, -2 ); C.translate( 0.3, -2 ); break;
+      case 1: S.rotate( 0.7, 1, 2 );  C.rotate( 0.7, 1, 2 );  break;
+      case 2: S.scale( 1.7 );         C.scale( 1.7 );         break;
+      case 3: S.reverse();            C.reverse();            break;
+      case 4: S.change_origin( 5, 6 ); C.change_origin( 5, 6 ); break;
+      case 5: S.trim( 0.1*S.length(), 0.8*S.length() ); C.trim( 0.1*C.length(), 0.8*C.length() ); break;
+      }
+      err = max( err, compare( S, C ) );
+      err = max( err, compare( S, S.curve() ) );
+    }
+  }
+  cout << "segment transforms max error " << err << '\n';
+  if ( !(err < 1e-12) ) ++nerr;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::CurveCursor;
+using namespace std;
+
+// abscissae increasing, decreasing and scattered over [-0.1*L,1.1*L]
+static vector<real_type>
+abscissae( real_type L ) {
+  vector<real_type> s;
+  for ( int_type k = 0; k <= 300; ++k ) s.push_back( (k*L)/300 );
+  for ( int_type k = 300; k >= 0; --k ) s.push_back( (k*L)/300 );
+  for ( int_type k = 0; k <= 300; ++k ) s.push_back( (((k*7919)%301)/300.0*1.2-0.1)*L );
+  return s;
+}
+
+// difference relative to the size of the value; the cursor is inlined in
+// this file, the list is compiled in the library, possibly with another
+// contraction of the floating point operations (FMA)
+static real_type
+rel( real_type a, real_type b ) {
+  return abs(a-b)/max( real_type(1), abs(b) );
+}
+
+// the cursor against the evaluation of the list itself
+template <typename LIST>
+static real_type
+compare( CurveCursor<LIST> & C, LIST const & L, vector<real_type> const & s ) {
+  real_type err = 0;
+  for ( real_type ss : s ) {
+    real_type t1, k1, x1, y1, t2, k2, x2, y2;
+    C.evaluate_ISO( ss, 0.2, t1, k1, x1, y1 );
+    L.evaluate_ISO( ss, 0.2, t2, k2, x2, y2 );
+    err = max( { err, rel(t1,t2), rel(k1,k2), rel(x1,x2), rel(y1,y2) } );
+    C.eval_D( ss, x1, y1 );
+    L.eval_D( ss, x2, y2 );
+    err = max( { err, rel(x1,x2), rel(y1,y2) } );
+    C.eval_ISO_DD( ss, -0.1, x1, y1 );
+    L.eval_ISO_DD( ss, -0.1, x2, y2 );
+    err = max( { err, rel(x1,x2), rel(y1,y2), rel(C.theta_D(ss),L.theta_D(ss)), rel(C.X(ss),L.X(ss)) } );
+  }
+  return err;
+}
+
+template <typename LIST, typename GROW>
+static int_type
+check( LIST & L, GROW const & grow, char const * what ) {
+  int_type          nerr = 0;
+  vector<real_type> s    = abscissae( L.length() );
+  CurveCursor<LIST> C( L );
+  real_type         err  = compare( C, L, s );
+
+  // independent cursors on concurrent threads
+  vector<real_type> terr(4,0);
+  vector<thread>    th;
+  for ( int_type t = 0; t < 4; ++t )
+    th.emplace_back( [&L,&s,&terr,t]() {
+      CurveCursor<LIST> TC( L );
+      vector<real_type> ss( s.begin()+t*100, s.end() );
+      terr[t] = compare( TC, L, ss );
+    } );
+  for ( auto & t : th ) t.join();
+  err = max( err, *max_element( terr.begin(), terr.end() ) );
+
+  // the cursor stays valid when the list grows
+  grow( L );
+  s = abscissae( L.length() );
+  err = max( err, compare( C, L, s ) );
+
+  cout << what << " cursor max relative error " << err << '\n';
+  if ( !(err < 1e-12) ) ++nerr;
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2 };
+
+  G2lib::ClothoidList CL;
+  CL.build_G1( 7, xx, yy, th );
+  G2lib::PolyLine PL;
+  PL.build( xx, yy, 7 );
+  G2lib::BiarcList BL;
+  BL.build_G1( 7, xx, yy, th );
+
+  nerr += check( CL, []( G2lib::ClothoidList & L ) { L.push_back_G1( L.x_end()+1, L.y_end()+0.5, 0 ); }, "ClothoidList" );
+  nerr += check( BL, []( G2lib::BiarcList & L ) { L.push_back_G1( L.x_end()+1, L.y_end()+0.5, 0 ); }, "BiarcList" );
+  nerr += check( PL, []( G2lib::PolyLine & L ) { L.push_back( L.x_end()+1, L.y_end()+0.5 ); }, "PolyLine" );
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::BaseCurve;
+using G2lib::IntersectList;
+using namespace std;
+
+// the pair converted by hand to the class `P`, as the old dispatch did
+template <typename P>
+static void
+convert( BaseCurve const & A, real_type oA, BaseCurve const & B, real_type oB, IntersectList & il, bool & coll ) {
+  P const C1( A ), C2( B );
+  if ( oA == 0 && oB == 0 ) {
+    C1.intersect( C2, il, false );
+    coll = C1.collision( C2 );
+  } else {
+    C1.intersect_ISO( oA, C2, oB, il, false );
+    coll = C1.collision_ISO( oA, C2, oB );
+  }
+}
+
+static void
+promoted( BaseCurve const & A, real_type oA, BaseCurve const & B, real_type oB, IntersectList & il, bool & coll ) {
+  switch ( G2lib::curve_promote( A.type(), B.type() ) ) {
+  case G2lib::G2LIB_LINE:          convert<G2lib::LineSegment>( A, oA, B, oB, il, coll );   break;
+  case G2lib::G2LIB_POLYLINE:      convert<G2lib::PolyLine>( A, oA, B, oB, il, coll );      break;
+  case G2lib::G2LIB_CIRCLE:        convert<G2lib::CircleArc>( A, oA, B, oB, il, coll );     break;
+  case G2lib::G2LIB_BIARC:         convert<G2lib::Biarc>( A, oA, B, oB, il, coll );         break;
+  case G2lib::G2LIB_BIARC_LIST:    convert<G2lib::BiarcList>( A, oA, B, oB, il, coll );     break;
+  case G2lib::G2LIB_CLOTHOID:      convert<G2lib::ClothoidCurve>( A, oA, B, oB, il, coll ); break;
+  case G2lib::G2LIB_CLOTHOID_LIST: convert<G2lib::ClothoidList>( A, oA, B, oB, il, coll );  break;
+  }
+}
+
+// every intersection point of P is close to one of Q
+static bool
+covered( BaseCurve const & A, IntersectList const & P, BaseCurve const & RA, IntersectList const & Q ) {
+  for ( auto const & p : P ) {
+    bool found = false;
+    for ( auto const & q : Q )
+      if ( hypot( A.X(p.first)-RA.X(q.first), A.Y(p.first)-RA.Y(q.first) ) < 1e-8 ) { found = true; break; }
+    if ( !found ) return false;
+  }
+  return true;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+  size_t   npts = 0;
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2 };
+  real_type const zx[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  real_type const zy[] = { 0.3, 1.2, -0.2, 1.1, 0, 1.3, -0.1, 0.8 };
+
+  // one curve of each type in the order of CurveType, all crossing
+  // the region [0,7]x[-0.5,1.5]
+  vector<unique_ptr<BaseCurve>> C;
+  C.emplace_back( new G2lib::LineSegment( -1, 0.2, 0.08, 9 ) );
+  { G2lib::PolyLine * p = new G2lib::PolyLine(); p->build( zx, zy, 8 ); C.emplace_back( p ); }
+  C.emplace_back( new G2lib::CircleArc( -0.5, -0.3, 0.9, -0.2, 9 ) );
+  C.emplace_back( new G2lib::Biarc( 0, 1.4, -0.4, 7, -0.2, 0.6 ) );
+  { G2lib::BiarcList * p = new G2lib::BiarcList(); p->build_G1( 7, xx, yy, th ); C.emplace_back( p ); }
+  C.emplace_back( new G2lib::ClothoidCurve( 0, 1, -0.3, 0.05, 0.01, 8 ) );
+  { G2lib::ClothoidList * p = new G2lib::ClothoidList(); p->build_G1( 7, xx, yy, th ); C.emplace_back( p ); }
+
+  // the second curve of the pairs: the same rotated and moved
+  vector<unique_ptr<BaseCurve>> D;
+  D.emplace_back( new G2lib::LineSegment( *static_cast<G2lib::LineSegment const *>( C[0].get() ) ) );
+  D.emplace_back( new G2lib::PolyLine( *static_cast<G2lib::PolyLine const *>( C[1].get() ) ) );
+  D.emplace_back( new G2lib::CircleArc( *static_cast<G2lib::CircleArc const *>( C[2].get() ) ) );
+  D.emplace_back( new G2lib::Biarc( *static_cast<G2lib::Biarc const *>( C[3].get() ) ) );
+  D.emplace_back( new G2lib::BiarcList( *static_cast<G2lib::BiarcList const *>( C[4].get() ) ) );
+  D.emplace_back( new G2lib::ClothoidCurve( *static_cast<G2lib::ClothoidCurve const *>( C[5].get() ) ) );
+  D.emplace_back( new G2lib::ClothoidList( *static_cast<G2lib::ClothoidList const *>( C[6].get() ) ) );
+  for ( auto & d : D ) { d->rotate( 0.35, 3.5, 0.5 ); d->translate( 0.1, 0.15 ); }
+
+  for ( int_type i = 0; i < G2lib::CurveType_count; ++i ) {
+    for ( int_type j = 0; j < G2lib::CurveType_count; ++j ) {
+      BaseCurve const & A = *C[size_t(i)];
+      BaseCurve const & B = *D[size_t(j)];
+      int_type ne = 0;
+      size_t   ni = 0;
+      try {
+        for ( real_type offs : { 0.0, 0.05 } ) {
+          IntersectList il, ref;
+          bool          coll = false, coll_ref = false, thrown = false, thrown_ref = false;
+          try {
+            if ( offs == 0 ) {
+              G2lib::intersect( A, B, il, false );
+              coll = G2lib::collision( A, B );
+            } else {
+              G2lib::intersect_ISO( A, offs, B, -offs, il, false );
+              coll = G2lib::collision_ISO( A, offs, B, -offs );
+            }
+          } catch ( std::exception const & ) { thrown = true; }
+          // bit-identical to the explicit conversion to the promoted class,
+          // an offset on PolyLine throws in both
+          try { promoted( A, offs, B, -offs, ref, coll_ref ); } catch ( std::exception const & ) { thrown_ref = true; }
+          if ( thrown != thrown_ref || coll != coll_ref || il != ref ) ++ne;
+          if ( offs == 0 ) {
+            if ( thrown ) ++ne;  // every pair is supported without offset
+            ni = il.size();
+            npts += ni;
+            // the same points of the pair converted to ClothoidList
+            G2lib::ClothoidList const LA( A ), LB( B );
+            IntersectList             cl;
+            LA.intersect( LB, cl, false );
+            if ( il.empty() || !covered( A, il, LA, cl ) || !covered( LA, cl, A, il ) ) ++ne;
+            if ( coll != LA.collision( LB ) ) ++ne;
+          }
+        }
+      } catch ( std::exception const & e ) {
+        cout << "exception: " << e.what() << '\n';
+        ++ne;
+      }
+      if ( ne > 0 )
+        cout << G2lib::CurveType_name[i] << " x " << G2lib::CurveType_name[j] << " (" << ni << " points) FAILED\n";
+      nerr += ne;
+    }
+  }
+  cout << "7x7 pairs, " << npts << " intersections, errors " << nerr << '\n';
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
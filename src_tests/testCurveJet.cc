@@ -0,0 +1,64 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::BaseCurve;
+using G2lib::CurveJet;
+using namespace std;
+
+// evaluate_jet of the curve against the separate evaluations collected
+// by the default BaseCurve::evaluate_jet
+static int_type
+check( BaseCurve const & C, char const * what ) {
+  real_type err = 0;
+  real_type L   = C.length();
+  for ( real_type offs : { 0.0, 0.3, -0.2 } ) {
+    for ( int_type k = 0; k <= 200; ++k ) {
+      real_type s = (k*L)/200;
+      CurveJet J, R;
+      C.evaluate_jet( s, offs, J );
+      C.BaseCurve::evaluate_jet( s, offs, R );
+      real_type const a[] = { J.x, J.y, J.theta, J.kappa, J.kappa_D, J.x_D, J.y_D, J.x_DD, J.y_DD, J.x_DDD, J.y_DDD };
+      real_type const b[] = { R.x, R.y, R.theta, R.kappa, R.kappa_D, R.x_D, R.y_D, R.x_DD, R.y_DD, R.x_DDD, R.y_DDD };
+      for ( int_type i = 0; i < 11; ++i ) err = max( err, abs(a[i]-b[i])/(1+abs(b[i])) );
+    }
+  }
+  cout << what << " evaluate_jet max error " << err << '\n';
+  return err < 1e-10 ? 0 : 1;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  G2lib::LineSegment   LS( 0, 0, 0.3, 2 );
+  G2lib::CircleArc     CA( 0, 0, 0.3, 0.5, 3 );
+  G2lib::ClothoidCurve CC( 0, 0, 0.3, 0.5, -0.2, 4 );
+  G2lib::Biarc         BA( 0, 0, 0.3, 3, 1, -0.5 );
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1 };
+  G2lib::ClothoidList CL;
+  CL.build_G1( 5, xx, yy, th );
+  G2lib::BiarcList BL;
+  BL.build_G1( 5, xx, yy, th );
+  G2lib::PolyLine PL( CC, 1e-3 );
+
+  nerr += check( LS, "LineSegment" );
+  nerr += check( CA, "CircleArc" );
+  nerr += check( CC, "ClothoidCurve" );
+  nerr += check( BA, "Biarc" );
+  nerr += check( CL, "ClothoidList" );
+  nerr += check( BL, "BiarcList" );
+  nerr += check( PL, "PolyLine" );
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
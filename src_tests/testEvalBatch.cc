@@ -0,0 +1,99 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ClothoidList;
+using namespace std;
+
+// eval_batch against evaluate at each abscissa, the largest ratio of the
+// difference to the tolerance of the point. The batch may use the vector
+// Fresnel kernel and the pointwise path the scalar one, compiled with
+// another contraction of the floating point operations (FMA). The position
+// is the start of the segment plus s*X(a,b), with s the abscissa on the
+// segment, so the tolerance is the accuracy of the moment 0 documented for
+// GeneralizedFresnelCS (1e-12, reached just above |a| = 0.01) scaled by |s|;
+// the angle and the curvature are checked at 1e-12 relative.
+static real_type
+compare( ClothoidList const & CL, vector<real_type> const & s, int_type n_threads ) {
+  int_type          n = int_type(s.size());
+  vector<real_type> x(n), y(n), th(n), k(n), x2(n), y2(n);
+  CL.eval_batch( n, s.data(), x.data(), y.data(), th.data(), k.data(), n_threads );
+  CL.eval_batch( n, s.data(), x2.data(), y2.data(), nullptr, nullptr, n_threads );
+  real_type err = 0;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type tt, kk, xx, yy;
+    CL.evaluate( s[i], tt, kk, xx, yy );
+    real_type ss  = s[i];
+    int_type  idx = CL.findAtS( ss );
+    real_type tol = 1e-12*( max( { real_type(1), abs(xx), abs(yy) } ) + abs( ss - CL.segment_s0( idx ) ) );
+    err = max( { err, hypot(x[i]-xx, y[i]-yy)/tol, hypot(x2[i]-xx, y2[i]-yy)/tol,
+                 abs(th[i]-tt)/(1e-12*max( real_type(1), abs(tt) )), abs(k[i]-kk)/(1e-12*max( real_type(1), abs(kk) )) } );
+  }
+  return err;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // a spiral of 2000 segments
+  int_type const    np = 2001;
+  vector<real_type> xp(np), yp(np), tp(np);
+  for ( int_type i = 0; i < np; ++i ) {
+    real_type a = 0.01*i, r = 1+0.01*i;
+    xp[i] = r*cos(a);
+    yp[i] = r*sin(a);
+    tp[i] = a + G2lib::Utils::m_pi_2;
+  }
+  ClothoidList CL;
+  CL.build_G1( np, xp.data(), yp.data(), tp.data() );
+  real_type L = CL.length();
+
+  int_type const    n = 100000;
+  vector<real_type> sorted(n), unsorted(n), outside(n);
+  for ( int_type i = 0; i < n; ++i ) {
+    sorted[i]   = (i*L)/(n-1);
+    unsorted[i] = ((i*7919LL)%n)*L/(n-1);
+    outside[i]  = (((i*104729LL)%n)/(n-1.0)*1.4-0.2)*L;
+  }
+  // repeated abscissae and the breakpoints
+  for ( int_type i = 0; i < 50; ++i ) sorted[1000+i] = sorted[1000];
+  for ( int_type i = 0; i < np; i += 37 ) unsorted[i] = CL.segment_s0( i );
+
+  struct { char const * what; vector<real_type> const * s; } const cases[] = {
+    { "sorted", &sorted }, { "unsorted", &unsorted }, { "outside", &outside }
+  };
+  for ( auto const & c : cases ) {
+    for ( int_type nt : { 1, 4, 0 } ) {
+      real_type err = compare( CL, *c.s, nt );
+      cout << "eval_batch " << c.what << " n_threads = " << nt << " max error/tolerance " << err << '\n';
+      if ( !(err < 1) ) ++nerr;
+    }
+  }
+
+  // closed list: the abscissae wrap around
+  CL.make_closed();
+  for ( auto const & c : cases ) {
+    real_type err = compare( CL, *c.s, 4 );
+    cout << "eval_batch closed " << c.what << " max error/tolerance " << err << '\n';
+    if ( !(err < 1) ) ++nerr;
+  }
+
+  // small batches and a single segment list
+  vector<real_type> few( sorted.begin(), sorted.begin()+3 );
+  if ( !(compare( CL, few, 4 ) < 1) ) ++nerr;
+  ClothoidList one;
+  one.push_back( 0, 0, 0.3, 0.1, 0.2, 2 );
+  vector<real_type> s1 = { -1, 0, 0.5, 1.9, 2, 3 };
+  if ( !(compare( one, s1, 1 ) < 1) ) ++nerr;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
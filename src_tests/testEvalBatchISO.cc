@@ -0,0 +1,102 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::ClothoidList;
+using namespace std;
+
+// eval_batch_ISO and eval_batch against evaluate_ISO at each abscissa,
+// the largest ratio of the difference to the tolerance of the point, a
+// stale copy of the segment parameters shows as a ratio far above 1.
+// The tolerance is the one of testEvalBatch: the accuracy of the moment 0
+// documented for GeneralizedFresnelCS (1e-12) scaled by the abscissa on
+// the segment, plus the offset times the 1e-12 relative accuracy of the
+// angle; the angle and the curvature are checked at 1e-12 relative.
+static real_type
+compare( ClothoidList const & CL ) {
+  real_type         L = CL.length();
+  int_type const    n = 3001;
+  vector<real_type> s(n), x(n), y(n), th(n), k(n);
+  for ( int_type i = 0; i < n; ++i ) s[i] = ((i*7919LL)%n)*L/(n-1);
+  real_type err = 0;
+  for ( real_type offs : { 0.0, -0.2, 0.3 } ) {
+    for ( int_type nt : { 1, 4 } ) {
+      if ( offs == 0 ) CL.eval_batch( n, s.data(), x.data(), y.data(), th.data(), k.data(), nt );
+      else             CL.eval_batch_ISO( n, s.data(), offs, x.data(), y.data(), th.data(), k.data(), nt );
+      for ( int_type i = 0; i < n; ++i ) {
+        real_type tt, kk, xx, yy;
+        CL.evaluate_ISO( s[i], offs, tt, kk, xx, yy );
+        real_type ss  = s[i];
+        int_type  idx = CL.findAtS( ss );
+        real_type tol = 1e-12*( max( { real_type(1), abs(xx), abs(yy) } ) + abs( ss - CL.segment_s0( idx ) ) +
+                                abs(offs)*max( real_type(1), abs(tt) ) );
+        err = max( { err, hypot(x[i]-xx, y[i]-yy)/tol, abs(th[i]-tt)/(1e-12*max( real_type(1), abs(tt) )),
+                     abs(k[i]-kk)/(1e-12*max( real_type(1), abs(kk) )) } );
+      }
+    }
+  }
+  return err;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2 };
+
+  ClothoidList base;
+  base.build_G1( 7, xx, yy, th );
+
+  G2lib::BiarcList BL;
+  BL.build_G1( 7, xx, yy, th );
+  G2lib::PolyLine PL;
+  PL.build( xx, yy, 7 );
+
+  // each case changes the list, the batch must follow
+  using OP = function<void( ClothoidList & )>;
+  pair<char const *, OP> const cases[] = {
+    { "build_G1",       []( ClothoidList & ) {} },
+    { "push_back",      []( ClothoidList & C ) { C.push_back( 0.1, -0.05, 2 ); C.push_back( 0, 0, 1 ); } },
+    { "push_back_G1",   []( ClothoidList & C ) { C.push_back_G1( C.x_end()+1, C.y_end()+0.5, 0.3 ); } },
+    { "push_back line", []( ClothoidList & C ) { C.push_back( G2lib::LineSegment( C.x_end(), C.y_end(), C.theta_end(), 2 ) ); } },
+    { "push_back arcs", [&BL]( ClothoidList & C ) { C.push_back( BL ); } },
+    { "push_back poly", [&PL]( ClothoidList & C ) { C.push_back( PL ); } },
+    { "translate",      []( ClothoidList & C ) { C.translate( 3, -1 ); } },
+    { "rotate",         []( ClothoidList & C ) { C.rotate( 0.8, 1, 2 ); } },
+    { "scale",          []( ClothoidList & C ) { C.scale( 1.6 ); } },
+    { "reverse",        []( ClothoidList & C ) { C.reverse(); } },
+    { "change_origin",  []( ClothoidList & C ) { C.change_origin( -5, 4 ); } },
+    { "trim",           []( ClothoidList & C ) { C.trim( 0.13*C.length(), 0.71*C.length() ); } },
+    { "trim copy",      []( ClothoidList & C ) { ClothoidList T; C.trim( 0.2*C.length(), 0.9*C.length(), T ); C = T; } },
+    { "copy",           []( ClothoidList & C ) { ClothoidList T( C ); T.translate( 1, 1 ); C = T; } },
+    { "move",           []( ClothoidList & C ) { ClothoidList T( C ); T.rotate( 0.3, 0, 0 ); C = std::move( T ); } },
+    { "move construct", []( ClothoidList & C ) { ClothoidList T( C ); T.scale( 0.5 ); ClothoidList M( std::move( T ) ); C = M; } },
+    { "from BiarcList", [&BL]( ClothoidList & C ) { C = ClothoidList( BL ); } },
+    { "init",           []( ClothoidList & C ) { C.init(); C.push_back( 0, 0, 0.3, 0.1, 0.2, 2 ); } },
+  };
+
+  // each change alone and all of them in sequence
+  ClothoidList all( base );
+  for ( auto const & c : cases ) {
+    ClothoidList C( base );
+    c.second( C );
+    c.second( all );
+    real_type e1 = compare( C ), e2 = compare( all );
+    cout << c.first << " max error/tolerance " << e1 << ", in sequence " << e2 << '\n';
+    if ( !(e1 < 1) || !(e2 < 1) ) ++nerr;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::FresnelAccuracy;
+using namespace std;
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // the bounds documented in FresnelAccuracy for FresnelCS and
+  // GeneralizedFresnelCS
+  struct { char const * what; FresnelAccuracy acc; real_type tol, gtol; } const tiers[] = {
+    { "Fast ", FresnelAccuracy::Fast,  1e-11, 1e-9 },
+    { "Draft", FresnelAccuracy::Draft, 1e-7,  1e-6 }
+  };
+
+  for ( auto const & T : tiers ) {
+
+    // FresnelCS and its derivatives over the table and the asymptotic range
+    real_type      err = 0;
+    int_type const n   = 200000;
+    for ( int_type i = 0; i < n; ++i ) {
+      real_type x = -60 + 120*real_type((i*7919LL)%n)/n;
+      real_type C0, S0, C, S;
+      G2lib::FresnelCS( x, C0, S0 );
+      G2lib::FresnelCS( x, C, S, T.acc );
+      err = max( { err, abs(C-C0), abs(S-S0) } );
+      real_type C3[3], S3[3], C4[3], S4[3];
+      G2lib::FresnelCS( 3, x, C3, S3 );
+      G2lib::FresnelCS( 3, x, C4, S4, T.acc );
+      for ( int_type k = 0; k < 3; ++k ) err = max( { err, abs(C4[k]-C3[k]), abs(S4[k]-S3[k]) } );
+    }
+    cout << T.what << " FresnelCS max error " << err << '\n';
+    if ( !(err < T.tol) ) ++nerr;
+
+    // GeneralizedFresnelCS in the regimes of a: zero, the series, just
+    // above the threshold of the series and large; |b| <= 100
+    real_type const ranges[][2] = { { 0, 0 }, { 1e-6, 0.01 }, { 0.01, 1 }, { 1, 100 }, { 100, 1e4 } };
+    for ( auto const & R : ranges ) {
+      real_type      gerr = 0;
+      int_type const m    = 50000;
+      for ( int_type i = 0; i < m; ++i ) {
+        real_type u = real_type((i*7919LL)%m)/m;
+        real_type v = real_type((i*104729LL)%m)/m;
+        real_type a = R[0] > 0 ? R[0]*pow( R[1]/R[0], u ) : 0;
+        if ( i%2 == 1 ) a = -a;
+        real_type b = 200*(v-0.5);
+        real_type c = 6*(u-0.5);
+        real_type C0[3], S0[3], C[3], S[3];
+        G2lib::GeneralizedFresnelCS( 3, a, b, c, C0, S0 );
+        G2lib::GeneralizedFresnelCS( 3, a, b, c, C, S, T.acc );
+        for ( int_type k = 0; k < 3; ++k ) gerr = max( { gerr, abs(C[k]-C0[k]), abs(S[k]-S0[k]) } );
+        real_type C1, S1;
+        G2lib::GeneralizedFresnelCS( a, b, c, C0[0], S0[0] );
+        G2lib::GeneralizedFresnelCS( a, b, c, C1, S1, T.acc );
+        gerr = max( { gerr, abs(C1-C0[0]), abs(S1-S0[0]) } );
+      }
+      cout << T.what << " GeneralizedFresnelCS |a| in [" << R[0] << "," << R[1] << ") max error " << gerr << '\n';
+      if ( !(gerr < T.gtol) ) ++nerr;
+    }
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
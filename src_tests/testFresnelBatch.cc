@@ -0,0 +1,74 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // triples in all the regimes, both signs, b and c spread over a few turns
+  struct { char const * what; real_type amin, amax; real_type tol[3]; } const regimes[] = {
+    // a = 0: the kernel of segments and arcs for nk = 1, the scalar series otherwise
+    { "a = 0             ", 0, 0, { 1e-13, 0, 0 } },
+    // both paths call the scalar series, the results are the same
+    { "0 < |a| < 0.01    ", 0, 0.01, { 0, 0, 0 } },
+    // just above the threshold of the series the large |a| formula loses
+    // digits by cancellation in both paths, the documented accuracy
+    { "0.01 <= |a| < 1   ", 0.01, 1, { 1e-12, 1e-11, 1e-8 } },
+    { "1 <= |a| < 40     ", 1, 40, { 1e-13, 1e-13, 1e-13 } }
+  };
+  int_type const n = 4000;
+  for ( auto const & R : regimes ) {
+    vector<real_type> a(n), b(n), c(n);
+    for ( int_type i = 0; i < n; ++i ) {
+      real_type u = real_type((i*7919)%n)/n;
+      real_type v = real_type((i*104729)%n)/n;
+      // a log-uniform in the range, denser near the threshold
+      real_type m = R.amin > 0 ? R.amin*pow( R.amax/R.amin, u ) : R.amax*u;
+      a[i] = ( i%2 == 0 ? m : -m );
+      b[i] = 12*(v-0.5);
+      c[i] = 6*(u-0.5);
+    }
+    for ( int_type nk = 1; nk <= 3; ++nk ) {
+      vector<real_type> intC(n*nk), intS(n*nk);
+      G2lib::GeneralizedFresnelCS( n, nk, a.data(), b.data(), c.data(), intC.data(), intS.data() );
+      real_type err[3] = { 0, 0, 0 };
+      for ( int_type i = 0; i < n; ++i ) {
+        real_type C[3], S[3];
+        G2lib::GeneralizedFresnelCS( nk, a[i], b[i], c[i], C, S );
+        for ( int_type k = 0; k < nk; ++k )
+          err[k] = max( { err[k], abs( intC[k*n+i] - C[k] ), abs( intS[k*n+i] - S[k] ) } );
+      }
+      cout << R.what << " nk = " << nk << " max error";
+      for ( int_type k = 0; k < nk; ++k ) {
+        // moments past the first for a = 0 go through the scalar series
+        real_type tol = R.amax == 0 && nk > 1 ? 0 : R.tol[k];
+        cout << ' ' << err[k];
+        if ( !(err[k] <= tol) ) ++nerr;
+      }
+      cout << '\n';
+    }
+  }
+
+  // a batch shorter than a vector register and an empty batch
+  {
+    real_type const a = 3.5, b = -1.2, c = 0.4;
+    real_type       C[3], S[3], C1, S1;
+    G2lib::GeneralizedFresnelCS( 1, 1, &a, &b, &c, C, S );
+    G2lib::GeneralizedFresnelCS( a, b, c, C1, S1 );
+    if ( !(C[0] == C1 && S[0] == S1) ) ++nerr;
+    G2lib::GeneralizedFresnelCS( 0, 1, &a, &b, &c, C, S );
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
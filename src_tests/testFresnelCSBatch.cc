@@ -0,0 +1,66 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+//
+// FresnelCS_batch against the scalar FresnelCS. Without the vector kernel
+// the batch goes through the scalar routine and must be identical, with
+// CLOTHOIDS_ENABLE_NATIVE_ARCH it differs by rounding (and FMA contraction)
+// only: |C|, |S| < 1 so the tolerance is absolute.
+//
+static real_type
+batch_error( vector<real_type> const & x ) {
+  int_type const    n = int_type( x.size() );
+  vector<real_type> C( n ), S( n );
+  G2lib::FresnelCS_batch( n, x.data(), C.data(), S.data() );
+  real_type err = 0;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type c, s;
+    G2lib::FresnelCS( x[i], c, s );
+    err = max( { err, abs( C[i] - c ), abs( S[i] - s ) } );
+  }
+  return err;
+}
+
+int
+main() {
+
+  real_type const tol  = 1e-14;
+  int_type        nerr = 0;
+
+  // the regimes of the kernel: series, rational approximation, asymptotic
+  real_type const ranges[][2] = { { 0, 1 }, { 1, 6 }, { 6, 50 }, { -50, 50 } };
+  for ( auto const & R : ranges ) {
+    vector<real_type> x( 4001 ); // not a multiple of the vector width
+    for ( size_t i = 0; i < x.size(); ++i ) {
+      x[i] = R[0] + ( R[1] - R[0] ) * real_type( ( i * 7919 ) % x.size() ) / x.size();
+      if ( R[0] >= 0 && i % 2 == 1 ) x[i] = -x[i];
+    }
+    real_type err = batch_error( x );
+    cout << "|x| in [" << R[0] << "," << R[1] << ") max error " << err << '\n';
+    if ( !( err < tol ) ) ++nerr;
+  }
+
+  // the boundaries of the regimes, a register with lanes in all of them and
+  // every length up to two registers (the scalar tail)
+  vector<real_type> const edges{ 0.0, 1.0, -1.0, nextafter( 1.0, 0.0 ), 6.0, -6.0, nextafter( 6.0, 0.0 ), 1e-300 };
+  real_type               err = batch_error( edges );
+  for ( int_type n = 0; n <= 17; ++n ) {
+    vector<real_type> x( n );
+    for ( int_type i = 0; i < n; ++i ) x[i] = 0.37 * ( i % 3 == 0 ? 0.5 : i % 3 == 1 ? 3 : 20 ) * ( i % 2 ? -1 : 1 );
+    err = max( err, batch_error( x ) );
+  }
+  cout << "edges and short arrays max error " << err << '\n';
+  if ( !( err < tol ) ) ++nerr;
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
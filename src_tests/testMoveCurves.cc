@@ -0,0 +1,181 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::BaseCurve;
+using namespace std;
+
+static_assert( is_nothrow_move_constructible<G2lib::ClothoidCurve>::value, "ClothoidCurve move" );
+static_assert( is_nothrow_move_constructible<G2lib::ClothoidList>::value, "ClothoidList move" );
+static_assert( is_nothrow_move_constructible<G2lib::BiarcList>::value, "BiarcList move" );
+static_assert( is_nothrow_move_constructible<G2lib::PolyLine>::value, "PolyLine move" );
+static_assert( is_nothrow_move_constructible<G2lib::AABBtree>::value, "AABBtree move" );
+
+// the stored parameters of the curves, a move must carry them bit for bit
+static void
+params( BaseCurve const & C, vector<real_type> & P ) {
+  P.insert( P.end(), { C.x_begin(), C.y_begin(), C.theta_begin(), C.kappa_begin(), C.length() } );
+}
+
+static void
+params( G2lib::ClothoidCurve const & C, vector<real_type> & P ) {
+  params( static_cast<BaseCurve const &>( C ), P );
+  P.push_back( C.dkappa() );
+}
+
+static void
+params( G2lib::ClothoidList const & C, vector<real_type> & P ) {
+  for ( int_type i = 0; i < C.num_segments(); ++i ) {
+    params( C.get( i ), P );
+    P.push_back( C.segment_s0( i ) );
+  }
+}
+
+static void
+params( G2lib::BiarcList const & C, vector<real_type> & P ) {
+  for ( int_type i = 0; i < C.num_segments(); ++i ) {
+    params( C.get( i ).C0(), P );
+    params( C.get( i ).C1(), P );
+    P.push_back( C.segment_s0( i ) );
+  }
+}
+
+static void
+params( G2lib::PolyLine const & C, vector<real_type> & P ) {
+  for ( int_type i = 0; i < C.num_segments(); ++i ) {
+    params( C.get( i ), P );
+    P.push_back( C.segment_s0( i ) );
+  }
+}
+
+// the parameters of `A` and `B` are the same, the queries using the trees
+// of the curves agree; the trees may be built on one curve and not on the
+// other, so the queries are compared with a relative tolerance
+template <typename CURVE>
+static real_type
+compare( CURVE const & A, CURVE const & B, BaseCurve const & O ) {
+  vector<real_type> PA, PB;
+  params( A, PA );
+  params( B, PB );
+  if ( PA.empty() || PA != PB ) return 1;
+  real_type err = 0;
+  auto rel = [&err]( real_type a, real_type b ) { err = max( err, abs(a-b)/max( real_type(1), abs(b) ) ); };
+  for ( int_type q = 0; q < 20; ++q ) {
+    real_type qx = -1+0.5*q, qy = 2*sin(1.3*q);
+    real_type xa, ya, sa, ta, da, xb, yb, sb, tb, db;
+    A.closest_point_ISO( qx, qy, xa, ya, sa, ta, da );
+    B.closest_point_ISO( qx, qy, xb, yb, sb, tb, db );
+    rel( xa, xb );
+    rel( ya, yb );
+    rel( da, db );
+  }
+  G2lib::IntersectList ia, ib;
+  G2lib::intersect( A, O, ia, false );
+  G2lib::intersect( B, O, ib, false );
+  if ( ia.size() != ib.size() || ia.empty() ) return 1;
+  for ( size_t i = 0; i < ia.size(); ++i ) {
+    rel( ia[i].first, ib[i].first );
+    rel( ia[i].second, ib[i].second );
+  }
+  if ( G2lib::collision( A, O ) != G2lib::collision( B, O ) ) return 1;
+  return err;
+}
+
+// move construction and assignment of `A`: the target answers as a copy,
+// the trees and the index built before the move are carried, the source
+// is left empty and can be built again with `build`
+template <typename CURVE, typename BUILD>
+static int_type
+check( BUILD const & build, BaseCurve const & O, char const * what, bool empty_source = true ) {
+  int_type  nerr = 0;
+  real_type err  = 0;
+  CURVE     A;
+  build( A );
+  G2lib::collision( A, O );  // build the AABB tree
+  CURVE const R( A );
+
+  CURVE M( std::move( A ) );
+  err = max( err, compare( M, R, O ) );
+  if ( empty_source && A.length() != 0 ) ++nerr;
+
+  // the source is reusable
+  build( A );
+  err = max( err, compare( A, R, O ) );
+
+  CURVE N;
+  build( N );
+  N.translate( 1, 1 );
+  G2lib::collision( N, O );
+  N = std::move( A );
+  err = max( err, compare( N, R, O ) );
+  if ( empty_source && A.length() != 0 ) ++nerr;
+
+  // a vector of curves relocates by moving
+  vector<CURVE> V;
+  for ( int_type i = 0; i < 9; ++i ) {
+    V.emplace_back( R );
+    G2lib::collision( V.back(), O );
+  }
+  for ( CURVE const & C : V ) err = max( err, compare( C, R, O ) );
+
+  cout << what << " move max error " << err << '\n';
+  if ( !(err < 1e-12) ) ++nerr;
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2 };
+
+  // a curve crossing all the others
+  G2lib::LineSegment O( -1, 0.6, 0.02, 10 );
+
+  nerr += check<G2lib::ClothoidCurve>(
+    []( G2lib::ClothoidCurve & C ) { C.build( 0, 0, 0.2, 0.1, 0.05, 7 ); }, O, "ClothoidCurve", false );
+  nerr += check<G2lib::ClothoidList>(
+    [&]( G2lib::ClothoidList & C ) { C.build_G1( 7, xx, yy, th ); C.build_s_index(); }, O, "ClothoidList" );
+  nerr += check<G2lib::BiarcList>(
+    [&]( G2lib::BiarcList & C ) { C.build_G1( 7, xx, yy, th ); C.build_s_index(); }, O, "BiarcList" );
+  nerr += check<G2lib::PolyLine>(
+    [&]( G2lib::PolyLine & C ) { C.build( xx, yy, 7 ); C.build_s_index(); }, O, "PolyLine" );
+
+  // a moved AABBtree answers as the original, the source is empty
+  {
+    G2lib::ClothoidList CL;
+    CL.build_G1( 7, xx, yy, th );
+    G2lib::AABBtree::VecPtrBBox B;
+    for ( int_type i = 0; i < 500; ++i ) {
+      real_type x = 10*real_type((i*7919)%1009)/1009;
+      real_type y = 10*real_type((i*104729)%1013)/1013;
+      B.push_back( make_shared<G2lib::BBox>( x, y, x+0.3, y+0.2, i, i ) );
+    }
+    G2lib::AABBtree T;
+    T.build( B );
+    G2lib::AABBtree::VecPtrBBox c1, c2;
+    T.min_distance( 3, 4, c1 );
+    G2lib::AABBtree M( std::move( T ) );
+    M.min_distance( 3, 4, c2 );
+    if ( c1 != c2 || !T.empty() ) ++nerr;
+    G2lib::AABBtree N;
+    N = std::move( M );
+    c2.clear();
+    N.min_distance( 3, 4, c2 );
+    if ( c1 != c2 || !M.empty() ) ++nerr;
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
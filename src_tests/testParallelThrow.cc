@@ -0,0 +1,94 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// a segment failing on the ray starting at x = 1000
+class FailingSegment : public G2lib::LineSegment {
+public:
+  bool
+  raycast_unit(
+    real_type x, real_type y, real_type dx, real_type dy,
+    real_type max_range, real_type & s, real_type & t
+  ) const override {
+    if ( x == 1000 ) throw runtime_error( "ray 1000" );
+    return G2lib::LineSegment::raycast_unit( x, y, dx, dy, max_range, s, t );
+  }
+};
+
+int
+main() {
+
+  // spiral of 200 segments
+  int_type const    np = 201;
+  vector<real_type> xp(np), yp(np), tp(np);
+  for ( int_type i = 0; i < np; ++i ) {
+    real_type a = i * 0.05;
+    xp[i] = ( 1 + a ) * cos( a );
+    yp[i] = ( 1 + a ) * sin( a );
+    tp[i] = a + G2lib::Utils::m_pi_2;
+  }
+  G2lib::ClothoidList L;
+  L.build_G1( np, xp.data(), yp.data(), tp.data() );
+
+  int_type const n = 20000;
+  vector<real_type> s(n), x(n), y(n);
+  for ( int_type i = 0; i < n; ++i ) s[i] = L.length() * i / n;
+
+  int_type nerr = 0;
+  for ( int_type nt : { 1, 4, 16 } ) {
+    // the error of a worker reaches the caller, the process is not aborted
+    s[15000] = numeric_limits<real_type>::quiet_NaN();
+    bool caught = false;
+    try {
+      L.eval_batch( n, s.data(), x.data(), y.data(), nullptr, nullptr, nt );
+    } catch ( runtime_error const & ) {
+      caught = true;
+    }
+    cout << "n_threads = " << nt << " exception " << ( caught ? "caught" : "MISSING" ) << '\n';
+    if ( !caught ) ++nerr;
+
+    // a batch without errors still works after a failed one
+    s[15000] = L.length() * 15000 / n;
+    L.eval_batch( n, s.data(), x.data(), y.data(), nullptr, nullptr, nt );
+    for ( int_type i = 0; i < n; ++i ) {
+      real_type xx, yy;
+      L.eval( s[i], xx, yy );
+      if ( abs( x[i] - xx ) > 1e-12 || abs( y[i] - yy ) > 1e-12 ) { ++nerr; break; }
+    }
+  }
+
+  // the same for the blocks of raycast_batch
+  FailingSegment F;
+  F.build_2P( 0, -1, 0, 1 );
+
+  int_type const nr = 4096;
+  vector<real_type> rx(nr), ry(nr, 0), rdx(nr, -1), rdy(nr, 0), rs(nr), rt(nr);
+  bool hit[nr];
+  for ( int_type i = 0; i < nr; ++i ) rx[i] = i;
+
+  for ( int_type nt : { 1, 4, 16 } ) {
+    bool caught = false;
+    try {
+      F.raycast_batch( nr, rx.data(), ry.data(), rdx.data(), rdy.data(), 10000, rs.data(), rt.data(), hit, nt );
+    } catch ( runtime_error const & e ) {
+      caught = string(e.what()) == "ray 1000";
+    }
+    cout << "raycast n_threads = " << nt << " exception " << ( caught ? "caught" : "MISSING" ) << '\n';
+    if ( !caught ) ++nerr;
+  }
+
+  rx[1000] = 1000.5;
+  F.raycast_batch( nr, rx.data(), ry.data(), rdx.data(), rdy.data(), 10000, rs.data(), rt.data(), hit, 4 );
+  for ( int_type i = 0; i < nr; ++i ) if ( !hit[i] || rt[i] != rx[i] ) { ++nerr; break; }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
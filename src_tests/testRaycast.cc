@@ -0,0 +1,182 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using G2lib::AABBtree;
+using G2lib::BaseCurve;
+using namespace std;
+
+static real_type const infty = numeric_limits<real_type>::infinity();
+
+// parameter of entry of the ray in the box, infinity if missed
+static real_type
+slab( G2lib::BBox const & b, real_type x, real_type y, real_type dx, real_type dy, real_type max_range ) {
+  real_type tin = 0, tout = max_range;
+  real_type const o[2]  = { x, y };
+  real_type const d[2]  = { dx, dy };
+  real_type const lo[2] = { b.x_min(), b.y_min() };
+  real_type const hi[2] = { b.x_max(), b.y_max() };
+  for ( int_type k = 0; k < 2; ++k ) {
+    if ( d[k] == 0 ) {
+      if ( o[k] < lo[k] || o[k] > hi[k] ) return infty;
+      continue;
+    }
+    real_type t0 = (lo[k]-o[k])/d[k], t1 = (hi[k]-o[k])/d[k];
+    if ( t0 > t1 ) swap( t0, t1 );
+    tin  = max( tin, t0 );
+    tout = min( tout, t1 );
+  }
+  return tin <= tout ? tin : infty;
+}
+
+struct Rays {
+  vector<real_type> x, y, dx, dy;
+};
+
+// n rays from the enlarged bbox of the curve, in every direction
+static Rays
+rays( BaseCurve const & C, int_type n ) {
+  real_type xmin, ymin, xmax, ymax;
+  C.bbox( xmin, ymin, xmax, ymax );
+  real_type W = max( xmax-xmin, 1.0 ), H = max( ymax-ymin, 1.0 );
+  Rays R;
+  for ( int_type i = 0; i < n; ++i ) {
+    real_type a = 2*G2lib::Utils::m_pi*((i*7919)%n)/n;
+    R.x.push_back( xmin-0.5*W+2*W*((i*104729)%997)/997.0 );
+    R.y.push_back( ymin-0.5*H+2*H*((i*1009)%991)/991.0 );
+    R.dx.push_back( cos(a) );
+    R.dy.push_back( sin(a) );
+  }
+  return R;
+}
+
+// the override of raycast_unit against the generic intersection of BaseCurve.
+// The generic refinement finds one root for each pair of triangles, it can
+// miss the first of two crossings of a chord inside the same triangle, so
+// the override may only find a nearer hit, which must be on the curve
+static int_type
+check( BaseCurve const & C ) {
+  int_type  nerr = 0, nhit = 0, nnear = 0;
+  real_type err  = 0;
+  Rays      R    = rays( C, 2000 );
+  real_type xmin, ymin, xmax, ymax;
+  C.bbox( xmin, ymin, xmax, ymax );
+  real_type range = 0.7*hypot( xmax-xmin, ymax-ymin );
+  for ( size_t i = 0; i < R.x.size(); ++i ) {
+    real_type mr = i%2 == 0 ? infty : range;
+    real_type s1, t1, s2, t2;
+    bool h1 = C.raycast_unit( R.x[i], R.y[i], R.dx[i], R.dy[i], mr, s1, t1 );
+    bool h2 = C.BaseCurve::raycast_unit( R.x[i], R.y[i], R.dx[i], R.dy[i], mr, s2, t2 );
+    if ( h2 && !h1 ) { ++nerr; continue; }
+    if ( !h1 ) continue;
+    ++nhit;
+    // the hit is on the curve and on the ray
+    real_type px = R.x[i]+t1*R.dx[i], py = R.y[i]+t1*R.dy[i];
+    err = max( err, hypot( C.X(s1)-px, C.Y(s1)-py ) );
+    if ( !(t1 >= 0 && t1 <= mr) ) ++nerr;
+    if ( h2 && t1 < t2-1e-9 ) ++nnear;
+    else if ( h2 ) err = max( err, abs(t1-t2) );
+    else ++nnear;
+  }
+  cout << G2lib::CurveType_name[C.type()] << " raycast " << nhit << " hits, "
+       << nnear << " nearer than the generic one, max error " << err << '\n';
+  if ( !(err < 1e-9) || nhit == 0 || nnear > nhit/50 ) ++nerr;
+
+  // the batch gives the same answer of the single rays
+  int_type           n = int_type(R.x.size());
+  vector<real_type>  s(n), t(n);
+  unique_ptr<bool[]> hit( new bool[size_t(n)] );
+  for ( int_type nt : { 1, 4 } ) {
+    C.raycast_batch( n, R.x.data(), R.y.data(), R.dx.data(), R.dy.data(), range, s.data(), t.data(), hit.get(), nt );
+    for ( int_type i = 0; i < n; ++i ) {
+      real_type ss, tt;
+      bool      h = C.raycast( R.x[i], R.y[i], R.dx[i], R.dy[i], range, ss, tt );
+      if ( h != hit[i] || ( h && ( ss != s[i] || tt != t[i] ) ) ) { ++nerr; break; }
+    }
+  }
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  // the first bbox entered by a ray against all the boxes
+  {
+    AABBtree::VecPtrBBox B;
+    for ( int_type i = 0; i < 1000; ++i ) {
+      real_type x = 10*real_type((i*7919)%1009)/1009;
+      real_type y = 10*real_type((i*104729)%1013)/1013;
+      real_type w = 0.05+0.2*real_type((i*31)%17)/17;
+      real_type h = 0.05+0.2*real_type((i*29)%13)/13;
+      B.push_back( make_shared<G2lib::BBox>( x, y, x+w, y+h, i, i ) );
+    }
+    AABBtree T;
+    T.build( B );
+    int_type ne = 0;
+    for ( int_type q = 0; q < 500; ++q ) {
+      real_type a  = 2*G2lib::Utils::m_pi*((q*37)%500)/500;
+      real_type x  = -2+14*real_type((q*11)%500)/500;
+      real_type y  = -2+14*real_type((q*13)%499)/499;
+      real_type dx = cos(a), dy = sin(a);
+      if ( q%50 == 0 ) { dx = 1; dy = 0; }  // axis aligned rays
+      real_type mr = q%2 == 0 ? infty : 4;
+      real_type tmin = infty;
+      for ( auto const & b : B ) tmin = min( tmin, slab( *b, x, y, dx, dy, mr ) );
+      AABBtree::PtrBBox box;
+      real_type         t;
+      bool              h = T.raycast( x, y, dx, dy, mr, box, t );
+      if ( h != (tmin < infty) ) { ++ne; continue; }
+      if ( h && ( abs(t-tmin) > 1e-12 || abs( slab( *box, x, y, dx, dy, mr )-t ) > 1e-12 ) ) ++ne;
+    }
+    cout << "AABBtree raycast errors " << ne << '\n';
+    nerr += ne;
+  }
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6, 7 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0, 0.3 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1, 0.2 };
+
+  G2lib::LineSegment   LS( 0, 0, 0.3, 2 );
+  G2lib::CircleArc     CA( 0, 0, 0.3, 0.8, 6 );
+  G2lib::Biarc         BA( 0, 0, 0.3, 2, 1, -1.2 );
+  G2lib::ClothoidCurve CC( 0, 0, 0.3, 0.2, 0.4, 7 );
+  G2lib::ClothoidList  CL;
+  CL.build_G1( 7, xx, yy, th );
+  G2lib::BiarcList     BL;
+  BL.build_G1( 7, xx, yy, th );
+  G2lib::PolyLine      PL;
+  PL.build( xx, yy, 7 );
+
+  for ( BaseCurve const * C : { (BaseCurve const *)&LS, (BaseCurve const *)&CA, (BaseCurve const *)&BA,
+                                (BaseCurve const *)&CC, (BaseCurve const *)&CL, (BaseCurve const *)&BL,
+                                (BaseCurve const *)&PL } )
+    nerr += check( *C );
+
+  // empty lists have no hit, the empty tree has the empty box
+  {
+    G2lib::ClothoidList EC;
+    G2lib::BiarcList    EB;
+    G2lib::PolyLine     EP;
+    real_type           s, t;
+    for ( BaseCurve const * C : { (BaseCurve const *)&EC, (BaseCurve const *)&EB, (BaseCurve const *)&EP } )
+      if ( C->raycast( 0, 0, 1, 0, 10, s, t ) ) ++nerr;
+    G2lib::AABBtree T;
+    real_type       xmin, ymin, xmax, ymax;
+    T.bbox( xmin, ymin, xmax, ymax );
+    if ( !(xmin > xmax) || !(ymin > ymax) ) ++nerr;
+    cout << "empty lists and tree done\n";
+  }
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
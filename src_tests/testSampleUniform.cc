@@ -0,0 +1,64 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// sample_uniform against the evaluation at s = j*ds
+template <typename CURVE>
+static int_type
+check( CURVE const & C, real_type ds, char const * what ) {
+  int_type          n = C.sample_uniform_size( ds );
+  vector<real_type> x(n), y(n), th(n), k(n);
+  int_type          m = C.sample_uniform( ds, x.data(), y.data(), th.data(), k.data() );
+  real_type         err = 0;
+  for ( int_type j = 0; j < m; ++j ) {
+    real_type tt, kk, xx, yy;
+    C.evaluate( j*ds, tt, kk, xx, yy );
+    err = max( { err, hypot( x[j]-xx, y[j]-yy ), abs( th[j]-tt ), abs( k[j]-kk ) } );
+  }
+  // the optional outputs may be omitted
+  vector<real_type> x2(n), y2(n);
+  C.sample_uniform( ds, x2.data(), y2.data() );
+  for ( int_type j = 0; j < m; ++j ) err = max( err, hypot( x2[j]-x[j], y2[j]-y[j] ) );
+
+  // the last sample is at most ds from the end of the curve
+  bool ok = m == n && err < 1e-10 && (m-1)*ds <= C.length()*(1+1e-12) && C.length()-(m-1)*ds < ds;
+  cout << what << " ds = " << ds << " samples " << m << " max error " << err << '\n';
+  return ok ? 0 : 1;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  G2lib::ClothoidCurve CC( 0, 0, 0.3, 0.5, -0.2, 4 );
+  G2lib::ClothoidCurve ST( 1, 2, -1, 0, 0, 3 );      // straight line
+  G2lib::ClothoidCurve SP( 0, 0, 0, -2, 5, 10 );     // tight spiral
+  for ( real_type ds : { 0.001, 0.013, 0.5, 1.0, 10.0 } ) {
+    nerr += check( CC, ds, "ClothoidCurve" );
+    nerr += check( ST, ds, "straight" );
+    nerr += check( SP, ds, "spiral" );
+  }
+
+  // L a multiple of ds up to rounding keeps the last sample
+  G2lib::ClothoidCurve C3( 0, 0, 0, 0.1, 0, 0.3 );
+  if ( C3.sample_uniform_size( 0.1 ) != 4 ) ++nerr;
+
+  real_type const xx[] = { 0, 1, 2.5, 3, 4.2, 6 };
+  real_type const yy[] = { 0, 0.5, 0.2, 1, 1.5, 0 };
+  real_type const th[] = { 0, 0.4, -0.3, 0.9, 0.1, -1 };
+  G2lib::ClothoidList CL;
+  CL.build_G1( 6, xx, yy, th );
+  for ( real_type ds : { 0.001, 0.07, 0.5, 3.0 } ) nerr += check( CL, ds, "ClothoidList" );
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}
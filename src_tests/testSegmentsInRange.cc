@@ -0,0 +1,99 @@
+//#define _USE_MATH_DEFINES
+#include "Clothoids.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using G2lib::real_type;
+using G2lib::int_type;
+using namespace std;
+
+// every sample of the curve inside the region must be covered by the
+// range of its segment, the segments are increasing and the ranges
+// contained in the curve
+template <typename LIST, typename INSIDE>
+static int_type
+covered(
+  LIST const &              C,
+  vector<int_type>  const & seg,
+  vector<real_type> const & sb,
+  vector<real_type> const & se,
+  INSIDE const &            inside
+) {
+  int_type  nerr = 0;
+  real_type L    = C.length();
+  if ( seg.size() != sb.size() || seg.size() != se.size() ) return 1;
+  for ( size_t k = 0; k < seg.size(); ++k ) {
+    if ( k > 0 && seg[k-1] >= seg[k] ) ++nerr;
+    if ( sb[k] > se[k] || sb[k] < -1e-12 || se[k] > L*(1+1e-12) ) ++nerr;
+  }
+  int_type hint = 0;
+  for ( int_type j = 0; j <= 20000; ++j ) {
+    real_type s = (j*L)/20000, x, y;
+    C.eval( s, x, y );
+    if ( !inside( x, y ) ) continue;
+    real_type ss = s;
+    int_type  is = C.findAtS( ss, hint );
+    auto it = lower_bound( seg.begin(), seg.end(), is );
+    if ( it == seg.end() || *it != is ) { ++nerr; continue; }
+    size_t k = size_t(it-seg.begin());
+    if ( s < sb[k]-1e-12 || s > se[k]+1e-12 ) ++nerr;
+  }
+  return nerr;
+}
+
+template <typename LIST>
+static int_type
+check( LIST const & C, char const * what ) {
+  int_type          nerr = 0;
+  vector<int_type>  seg;
+  vector<real_type> sb, se;
+  real_type         xmin, ymin, xmax, ymax;
+  C.bbox( xmin, ymin, xmax, ymax );
+  real_type W = xmax-xmin, H = ymax-ymin;
+  for ( int_type q = 0; q < 30; ++q ) {
+    real_type x0 = xmin + W*((q*37)%30)/30.0 - 0.1*W;
+    real_type y0 = ymin + H*((q*11)%30)/30.0 - 0.1*H;
+    real_type w  = W*(0.02+0.3*((q*7)%5)/5.0);
+    real_type h  = H*(0.02+0.3*((q*3)%7)/7.0);
+    C.segments_in_box( x0, y0, x0+w, y0+h, seg, sb, se );
+    nerr += covered( C, seg, sb, se, [&]( real_type x, real_type y ) {
+      return x >= x0 && x <= x0+w && y >= y0 && y <= y0+h;
+    } );
+    real_type r = 0.5*(w+h);
+    C.segments_in_radius( x0, y0, r, seg, sb, se );
+    nerr += covered( C, seg, sb, se, [&]( real_type x, real_type y ) { return hypot( x-x0, y-y0 ) <= r; } );
+  }
+  // a box far from the curve selects nothing
+  C.segments_in_box( xmax+1, ymax+1, xmax+2, ymax+2, seg, sb, se );
+  if ( !seg.empty() || !sb.empty() ) ++nerr;
+  cout << what << " segments_in_box/radius errors " << nerr << '\n';
+  return nerr;
+}
+
+int
+main() {
+
+  int_type nerr = 0;
+
+  int_type const    np = 201;
+  vector<real_type> xp(np), yp(np), tp(np);
+  for ( int_type i = 0; i < np; ++i ) {
+    real_type a = 0.05*i, r = 1+0.02*i;
+    xp[i] = r*cos(a);
+    yp[i] = r*sin(a);
+    tp[i] = a + G2lib::Utils::m_pi_2;
+  }
+  G2lib::ClothoidList CL;
+  CL.build_G1( np, xp.data(), yp.data(), tp.data() );
+  G2lib::BiarcList BL;
+  BL.build_G1( np, xp.data(), yp.data(), tp.data() );
+
+  nerr += check( CL, "ClothoidList" );
+  nerr += check( BL, "BiarcList" );
+
+  cout << ( nerr == 0 ? "OK" : "FAILED" ) << "\n\nALL DONE FOLKS!!!\n";
+
+  return nerr == 0 ? 0 : 1;
+}